@@ -5,6 +5,14 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE := main
 
+# Android tags arm64 heap pointers in the top byte, which compact script
+# values drop
+ifeq ($(TARGET_ARCH_ABI),arm64-v8a)
+ifneq ($(filter -DUSING_COMPACT_VALUES,$(APP_CPPFLAGS)),)
+$(error USING_COMPACT_VALUES is not supported on 64-bit ARM Android)
+endif
+endif
+
 rwc = $(foreach d, $(wildcard $1*), $(call rwc,$d/,$2) $(filter $(subst *,%,$2),$d))
 
 HCH_PATH := $(abspath ../..)
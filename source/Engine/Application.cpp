@@ -54,16 +54,22 @@ public:
 #include <Engine/Bytecode/ScriptManager.h>
 #include <Engine/Bytecode/ScriptEntity.h>
 #include <Engine/Bytecode/GarbageCollector.h>
+#include <Engine/Bytecode/JIT.h>
+#include <Engine/Bytecode/ObjectPool.h>
+#include <Engine/Bytecode/ScriptProfiler.h>
 #include <Engine/Bytecode/SourceFileMap.h>
 #include <Engine/Diagnostics/Clock.h>
 #include <Engine/Diagnostics/Log.h>
 #include <Engine/Diagnostics/Memory.h>
 #include <Engine/Diagnostics/MemoryPools.h>
+#include <Engine/Diagnostics/PerformanceMeasure.h>
 #include <Engine/Filesystem/Directory.h>
 #include <Engine/ResourceTypes/ResourceManager.h>
 #include <Engine/Scene/SceneInfo.h>
 #include <Engine/TextFormats/XML/XMLParser.h>
 #include <Engine/TextFormats/XML/XMLNode.h>
+#include <Engine/Types/EntityPool.h>
+#include <Engine/Utilities/JobSystem.h>
 #include <Engine/Utilities/StringUtils.h>
 
 #include <Engine/Media/MediaSource.h>
@@ -145,6 +151,7 @@ bool    ShowFPS = false;
 bool    TakeSnapshot = false;
 bool    DoNothing = false;
 int     UpdatesPerFastForward = 4;
+int     ProfilerInterval = 1;
 
 int     BenchmarkFrameCount = 0;
 double  BenchmarkTickStart = 0.0;
@@ -182,6 +189,7 @@ PUBLIC STATIC void Application::Init(int argc, char* args[]) {
 #endif
 
     MemoryPools::Init();
+    JobSystem::Init();
 
     SDL_SetHint(SDL_HINT_WINDOWS_DISABLE_THREAD_NAMING, "1");
     SDL_SetHint(SDL_HINT_ACCELEROMETER_AS_JOYSTICK, "0");
@@ -425,6 +433,8 @@ PUBLIC STATIC void Application::GetPerformanceSnapshot() {
         double totalUpdateLate = 0.0;
         double totalRender = 0.0;
         Log::Print(Log::LOG_IMPORTANT, "Object Performance Snapshot:");
+        if (!PerformanceMeasure::ObjectTiming)
+            Log::Print(Log::LOG_INFO, "Object timing is off (enable it with \"objectTiming\" in the \"dev\" settings).");
         for (size_t i = 0; i < ListList.size(); i++) {
             ObjectList* list = ListList[i];
             ObjectListPerformance& perf = list->Performance;
@@ -450,6 +460,15 @@ PUBLIC STATIC void Application::GetPerformanceSnapshot() {
 
         Log::Print(Log::LOG_IMPORTANT, "Garbage Size:");
         Log::Print(Log::LOG_INFO, "%u", (Uint32)GarbageCollector::GarbageSize);
+
+        Log::Print(Log::LOG_IMPORTANT, "Garbage Collector Pauses:");
+        Log::Print(Log::LOG_INFO, "Last %.3f ms, Max %.3f ms, Avg %.3f ms (%u slices, %u cycles, %u minor)",
+            GarbageCollector::LastPause, GarbageCollector::MaxPause,
+            GarbageCollector::SliceCount ? GarbageCollector::TotalPause / GarbageCollector::SliceCount : 0.0,
+            GarbageCollector::SliceCount, GarbageCollector::CycleCount, GarbageCollector::MinorCount);
+
+        ObjectPool::PrintStatus();
+        EntityPool::PrintStatus();
     }
 }
 
@@ -620,6 +639,7 @@ PRIVATE STATIC void Application::LoadKeyBinds() {
     GET_KEY("devShowTileCol",        DevTileCol,       Key_F7);
     GET_KEY("devShowObjectRegions",  DevObjectRegions, Key_F8);
     GET_KEY("devQuit",               DevQuit,          Key_ESCAPE);
+    GET_KEY("devToggleProfiler",     DevProfiler,      Key_F11);
 
 #undef GET_KEY
 }
@@ -629,6 +649,13 @@ PRIVATE STATIC void Application::LoadDevSettings() {
     Application::Settings->GetBool("dev", "viewPerformance", &ShowFPS);
     Application::Settings->GetBool("dev", "donothing", &DoNothing);
     Application::Settings->GetInteger("dev", "fastforward", &UpdatesPerFastForward);
+    Application::Settings->GetInteger("dev", "profilerInterval", &ProfilerInterval);
+
+    bool objectTiming = false;
+    int objectTimingInterval = PerformanceMeasure::ObjectTimingInterval;
+    Application::Settings->GetBool("dev", "objectTiming", &objectTiming);
+    Application::Settings->GetInteger("dev", "objectTimingInterval", &objectTimingInterval);
+    PerformanceMeasure::SetObjectTiming(objectTiming, objectTimingInterval);
 }
 
 PUBLIC STATIC bool Application::IsWindowResizeable() {
@@ -802,6 +829,20 @@ PRIVATE STATIC void Application::PollEvents() {
                         Application::UpdateWindowTitle();
                         break;
                     }
+                    // Toggle script profiler (dev)
+                    else if (key == KeyBindsSDL[(int)KeyBind::DevProfiler]) {
+                        if (!ScriptProfiler::IsRunning()) {
+                            ScriptProfiler::Start(ProfilerInterval);
+                            break;
+                        }
+
+                        ScriptProfiler::Stop();
+                        if (ScriptProfiler::WriteCollapsedStacks("profile.folded"))
+                            Log::Print(Log::LOG_IMPORTANT, "Wrote collapsed stacks to \"profile.folded\".");
+                        if (ScriptProfiler::WriteChromeTrace("profile.json"))
+                            Log::Print(Log::LOG_IMPORTANT, "Wrote trace to \"profile.json\".");
+                        break;
+                    }
                 }
                 break;
             }
@@ -1212,6 +1253,8 @@ PUBLIC STATIC void Application::Cleanup() {
 
     Graphics::Dispose();
 
+    JobSystem::Dispose();
+
     SDL_DestroyWindow(Application::Window);
 
     SDL_Quit();
@@ -1474,6 +1517,20 @@ PUBLIC STATIC void Application::InitSettings(const char* filename) {
     Application::Settings->GetBool("dev", "trackMemory", &Memory::IsTracking);
     Log::SetLogLevel(logLevel);
 
+    int gcSliceBudget = (int)(GarbageCollector::MaxTimeAlotted * 1000.0);
+    Application::Settings->GetBool("dev", "gcIncremental", &GarbageCollector::Incremental);
+    Application::Settings->GetInteger("dev", "gcSliceBudget", &gcSliceBudget);
+    if (gcSliceBudget > 0)
+        GarbageCollector::MaxTimeAlotted = gcSliceBudget / 1000.0;
+
+    int gcNurserySize = (int)(GarbageCollector::NurseryLimit / 1024);
+    Application::Settings->GetBool("dev", "gcGenerational", &GarbageCollector::Generational);
+    Application::Settings->GetInteger("dev", "gcNurserySize", &gcNurserySize);
+    if (gcNurserySize > 0)
+        GarbageCollector::NurseryLimit = (size_t)gcNurserySize * 1024;
+
+    Application::Settings->GetBool("dev", "jit", &JIT::Enabled);
+
     Application::Settings->GetBool("dev", "autoPerfSnapshots", &AutomaticPerformanceSnapshots);
     int apsFrameTimeThreshold = 20, apsMinInterval = 5;
     Application::Settings->GetInteger("dev", "apsMinFrameTime", &apsFrameTimeThreshold);
@@ -17,6 +17,7 @@ public:
 #endif
 
 #include <Engine/Bytecode/Bytecode.h>
+#include <Engine/Bytecode/ScriptManager.h>
 #include <Engine/IO/MemoryStream.h>
 #include <Engine/Utilities/StringUtils.h>
 
@@ -104,9 +105,12 @@ PUBLIC bool        Bytecode::Read(BytecodeContainer bytecode, HashMap<char*>* to
                 case VAL_DECIMAL:
                     function->Chunk.AddConstant(DECIMAL_VAL(stream->ReadFloat()));
                     break;
-                case VAL_OBJECT:
-                    function->Chunk.AddConstant(OBJECT_VAL(TakeString(stream->ReadString())));
+                case VAL_OBJECT: {
+                    char* string = stream->ReadString();
+                    function->Chunk.AddConstant(OBJECT_VAL(ScriptManager::InternString(string)));
+                    Memory::Free(string);
                     break;
+                }
             }
         }
 
@@ -131,7 +135,7 @@ PUBLIC bool        Bytecode::Read(BytecodeContainer bytecode, HashMap<char*>* to
         if (tokens) {
             for (ObjFunction* function : Functions) {
                 if (tokens->Exists(function->NameHash))
-                    function->Name = CopyString(tokens->Get(function->NameHash));
+                    function->Name = ScriptManager::InternString(tokens->Get(function->NameHash));
             }
         }
     }
@@ -143,6 +147,72 @@ PUBLIC bool        Bytecode::Read(BytecodeContainer bytecode, HashMap<char*>* to
     return true;
 }
 
+// Returns the size in bytes of the instruction at the given position,
+// or 0 if it can't be known without running it.
+PUBLIC STATIC int  Bytecode::GetInstructionLength(Uint8* code) {
+    switch (*code) {
+        case OP_GET_LOCAL:
+        case OP_SET_LOCAL:
+        case OP_POPN:
+        case OP_COPY:
+        case OP_CALL:
+        case OP_NEW:
+        case OP_EVENT:
+            return 2;
+
+        case OP_JUMP:
+        case OP_JUMP_IF_FALSE:
+        case OP_JUMP_BACK:
+        case OP_GET_MODULE_LOCAL:
+        case OP_SET_MODULE_LOCAL:
+        case OP_FAILSAFE:
+            return 3;
+
+        case OP_CONSTANT:
+        case OP_DEFINE_GLOBAL:
+        case OP_GET_GLOBAL:
+        case OP_SET_GLOBAL:
+        case OP_GET_GLOBAL_SLOT:
+        case OP_SET_GLOBAL_SLOT:
+        case OP_GET_PROPERTY:
+        case OP_SET_PROPERTY:
+        case OP_HAS_PROPERTY:
+        case OP_NEW_ARRAY:
+        case OP_NEW_MAP:
+        case OP_INHERIT:
+        case OP_IMPORT:
+        case OP_IMPORT_MODULE:
+        case OP_NEW_ENUM:
+        case OP_ADD_ENUM:
+        case OP_USE_NAMESPACE:
+            return 5;
+
+        case OP_CLASS:
+        case OP_METHOD:
+            return 6;
+
+        case OP_INVOKE:
+            return 7;
+
+        case OP_WITH:
+            // WITH_STATE_INIT_SLOTTED carries the receiver slot
+            return code[1] == 3 ? 5 : 4;
+
+        // Inline jump tables, or never emitted
+        case OP_ERROR:
+        case OP_SWITCH_TABLE:
+        case OP_SWITCH:
+        case OP_SUPER:
+        case OP_SYNC:
+            return 0;
+
+        default:
+            if (*code > OP_LAST)
+                return 0;
+            return 1;
+    }
+}
+
 PUBLIC void        Bytecode::Write(Stream* stream, const char* sourceFilename, HashMap<Token>* tokenMap) {
     int hasSourceFilename = (sourceFilename != nullptr) ? 1 : 0;
     int hasDebugInfo = HasDebugInfo ? 1 : 0;
@@ -178,16 +248,20 @@ PUBLIC void        Bytecode::Write(Stream* stream, const char* sourceFilename, H
         stream->WriteUInt32(constSize);
         for (int i = 0; i < constSize; i++) {
             VMValue constt = (*chunk->Constants)[i];
-            Uint8 type = (Uint8)constt.Type;
+            Uint8 type = (Uint8)VALUE_TYPE(constt);
             stream->WriteByte(type);
 
             switch (type) {
-                case VAL_INTEGER:
-                    stream->WriteBytes(&AS_INTEGER(constt), sizeof(int));
+                case VAL_INTEGER: {
+                    int value = AS_INTEGER(constt);
+                    stream->WriteBytes(&value, sizeof(int));
                     break;
-                case VAL_DECIMAL:
-                    stream->WriteBytes(&AS_DECIMAL(constt), sizeof(float));
+                }
+                case VAL_DECIMAL: {
+                    float value = AS_DECIMAL(constt);
+                    stream->WriteBytes(&value, sizeof(float));
                     break;
+                }
                 case VAL_OBJECT:
                     if (OBJECT_TYPE(constt) == OBJ_STRING) {
                         ObjString* str = AS_STRING(constt);
@@ -0,0 +1,712 @@
+#if INTERFACE
+#include <Engine/Bytecode/Types.h>
+#include <Engine/Bytecode/Bytecode.h>
+
+class BytecodeBundle {
+public:
+    static const char*   Magic;
+    static const char*   Filename;
+
+    static bool          Tried;
+    static Uint8*        Data;
+    static size_t        Size;
+    static bool          Mapped;
+    static void*         MapHandle;
+
+    static Uint32        ModuleCount;
+    static Uint32        StringCount;
+    static const Uint8*  Index;
+    static const Uint8*  StringOffsets;
+};
+#endif
+
+#include <Engine/Bytecode/BytecodeBundle.h>
+#include <Engine/Bytecode/GarbageCollector.h>
+#include <Engine/Bytecode/ScriptManager.h>
+#include <Engine/Diagnostics/Log.h>
+#include <Engine/Diagnostics/Memory.h>
+#include <Engine/Filesystem/File.h>
+#include <Engine/IO/FileStream.h>
+#include <Engine/IO/MemoryStream.h>
+#include <Engine/ResourceTypes/ResourceManager.h>
+#include <Engine/Utilities/StringUtils.h>
+
+#if WIN32
+    #include <windows.h>
+    #define BUNDLE_CAN_MAP
+#elif !ANDROID && !SWITCH_ROMFS
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #define BUNDLE_CAN_MAP
+#endif
+
+/*
+
+Objects.hbc layout (all little-endian):
+
+    char[4]  "HBDL"
+    Uint8    version, 0, 0, 0
+    Uint32   module count
+    Uint32   string count
+    { Uint32 filename hash, Uint32 offset } per module, sorted by hash
+    Uint32   offset per string
+
+Strings are a varint length and the bytes, shared by every module.
+
+A module is a flags byte (1 = debug info), the source filename string
+(index + 1, or 0), a varint list of token strings, and a varint list of
+functions: arity, min. arity, the name hash as a Uint32, the name string
+(index + 1, or 0), and the offset of the function's body as a Uint32.
+
+A body is a flags byte (1 = line info), a varint code length, the code,
+the line of every byte as a zigzag varint delta, and a varint list of
+constants. Each constant is a type byte followed by a zigzag varint (integer), a float
+(decimal) or a string index.
+
+Bodies are only decoded when the function is first called.
+
+*/
+
+#define BUNDLE_VERSION 0x01
+
+const char*   BytecodeBundle::Magic = "HBDL";
+const char*   BytecodeBundle::Filename = "Objects/Objects.hbc";
+
+bool          BytecodeBundle::Tried = false;
+Uint8*        BytecodeBundle::Data = NULL;
+size_t        BytecodeBundle::Size = 0;
+bool          BytecodeBundle::Mapped = false;
+void*         BytecodeBundle::MapHandle = NULL;
+
+Uint32        BytecodeBundle::ModuleCount = 0;
+Uint32        BytecodeBundle::StringCount = 0;
+const Uint8*  BytecodeBundle::Index = NULL;
+const Uint8*  BytecodeBundle::StringOffsets = NULL;
+
+static Uint32 ReadRawUInt32(const Uint8* p) {
+    Uint32 value;
+    memcpy(&value, p, sizeof(Uint32));
+    return value;
+}
+
+// Reads from somewhere in the bundle without going past its end. Once a
+// read fails, Failed is set and every read after it returns 0.
+struct BundleReader {
+    const Uint8* Pointer;
+    const Uint8* End;
+    bool         Failed;
+};
+
+static BundleReader  MakeReader(size_t offset) {
+    BundleReader reader;
+    reader.End = BytecodeBundle::Data + BytecodeBundle::Size;
+    reader.Failed = offset >= BytecodeBundle::Size;
+    reader.Pointer = reader.Failed ? reader.End : BytecodeBundle::Data + offset;
+    return reader;
+}
+static const Uint8*  ReadBytes(BundleReader& reader, size_t count) {
+    if (reader.Failed || count > (size_t)(reader.End - reader.Pointer)) {
+        reader.Failed = true;
+        return NULL;
+    }
+    const Uint8* bytes = reader.Pointer;
+    reader.Pointer += count;
+    return bytes;
+}
+static Uint8         ReadByte(BundleReader& reader) {
+    const Uint8* p = ReadBytes(reader, 1);
+    return p ? *p : 0;
+}
+static Uint32        ReadUInt32(BundleReader& reader) {
+    const Uint8* p = ReadBytes(reader, sizeof(Uint32));
+    return p ? ReadRawUInt32(p) : 0;
+}
+static Uint32        ReadVarint(BundleReader& reader) {
+    Uint32 value = 0;
+    int    shift = 0;
+    Uint8  byte;
+    do {
+        byte = ReadByte(reader);
+        value |= (Uint32)(byte & 0x7F) << shift;
+        shift += 7;
+    }
+    while ((byte & 0x80) && shift < 35);
+    return value;
+}
+static Sint32        ReadZigzag(BundleReader& reader) {
+    Uint32 value = ReadVarint(reader);
+    return (Sint32)(value >> 1) ^ -(Sint32)(value & 1);
+}
+
+static void   WriteVarint(vector<Uint8>& out, Uint32 value) {
+    while (value >= 0x80) {
+        out.push_back((Uint8)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((Uint8)value);
+}
+static void   WriteZigzag(vector<Uint8>& out, Sint32 value) {
+    WriteVarint(out, ((Uint32)value << 1) ^ (Uint32)(value >> 31));
+}
+static void   WriteRawUInt32(vector<Uint8>& out, Uint32 value) {
+    Uint8 bytes[4];
+    memcpy(bytes, &value, sizeof(Uint32));
+    out.insert(out.end(), bytes, bytes + 4);
+}
+
+// #region Reading
+PRIVATE STATIC bool BytecodeBundle::Open() {
+    Tried = true;
+
+    if (!ResourceManager::ResourceExists(Filename))
+        return false;
+
+#ifdef BUNDLE_CAN_MAP
+    // Loose files can be mapped straight in; the pages are only read in as
+    // functions get decoded.
+    if (ResourceManager::UsingDataFolder && !ResourceManager::UsingModPack) {
+        char path[4096];
+        ResourceManager::PrefixResourcePath(path, sizeof path, Filename);
+        Mapped = MapFile(path);
+    }
+#endif
+
+    if (!Mapped) {
+        if (!ResourceManager::LoadResource(Filename, &Data, &Size))
+            return false;
+    }
+
+    if (Size < 16 || memcmp(Data, Magic, 4) != 0 || Data[4] > BUNDLE_VERSION
+        || 16 + (size_t)ReadRawUInt32(Data + 8) * 8 + (size_t)ReadRawUInt32(Data + 12) * 4 > Size) {
+        Log::Print(Log::LOG_ERROR, "Invalid bytecode bundle!");
+        Close();
+        Tried = true;
+        return false;
+    }
+
+    ModuleCount = ReadRawUInt32(Data + 8);
+    StringCount = ReadRawUInt32(Data + 12);
+    Index = Data + 16;
+    StringOffsets = Index + ModuleCount * 8;
+
+    Log::Print(Log::LOG_VERBOSE, "Using bytecode bundle (%u modules, %u strings%s)", ModuleCount, StringCount, Mapped ? ", mapped" : "");
+    return true;
+}
+PRIVATE STATIC bool BytecodeBundle::MapFile(const char* path) {
+#if WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping)
+        return false;
+
+    Data = (Uint8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!Data) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    Size = (size_t)size.QuadPart;
+    MapHandle = mapping;
+    return true;
+#elif defined(BUNDLE_CAN_MAP)
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(file, &st) == 0 && st.st_size > 0)
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED)
+        return false;
+
+    Data = (Uint8*)data;
+    Size = (size_t)st.st_size;
+    return true;
+#else
+    return false;
+#endif
+}
+PUBLIC STATIC void BytecodeBundle::Close() {
+    if (Data) {
+#if WIN32
+        if (Mapped) {
+            UnmapViewOfFile(Data);
+            CloseHandle((HANDLE)MapHandle);
+        }
+#elif defined(BUNDLE_CAN_MAP)
+        if (Mapped)
+            munmap(Data, Size);
+#endif
+        if (!Mapped)
+            Memory::Free(Data);
+    }
+
+    Tried = false;
+    Data = NULL;
+    Size = 0;
+    Mapped = false;
+    MapHandle = NULL;
+    ModuleCount = 0;
+    StringCount = 0;
+    Index = NULL;
+    StringOffsets = NULL;
+}
+
+PRIVATE STATIC const Uint8* BytecodeBundle::FindModule(Uint32 filenameHash) {
+    if (!Tried)
+        Open();
+    if (!Data)
+        return NULL;
+
+    Uint32 low = 0, high = ModuleCount;
+    while (low < high) {
+        Uint32 mid = (low + high) / 2;
+        Uint32 hash = ReadRawUInt32(Index + mid * 8);
+        if (hash == filenameHash) {
+            Uint32 offset = ReadRawUInt32(Index + mid * 8 + 4);
+            if (offset >= Size)
+                return NULL;
+            return Data + offset;
+        }
+        if (hash < filenameHash)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return NULL;
+}
+// Returns NULL if the string doesn't fit in the bundle.
+PRIVATE STATIC const char* BytecodeBundle::GetString(Uint32 index, Uint32* length) {
+    if (index >= StringCount)
+        return NULL;
+
+    BundleReader reader = MakeReader(ReadRawUInt32(StringOffsets + index * 4));
+    *length = ReadVarint(reader);
+    return (const char*)ReadBytes(reader, *length);
+}
+
+PUBLIC STATIC bool BytecodeBundle::HasModule(Uint32 filenameHash) {
+    return FindModule(filenameHash) != NULL;
+}
+// Reads the function list of a module. The functions are left empty
+// until DecodeFunction is called on them.
+PUBLIC STATIC bool BytecodeBundle::ReadModule(Uint32 filenameHash, Bytecode* bytecode, HashMap<char*>* tokens) {
+    const Uint8* module = FindModule(filenameHash);
+    if (!module)
+        return false;
+
+    BundleReader reader = MakeReader(module - Data);
+
+    Uint32 length;
+    Uint8 flags = ReadByte(reader);
+    bytecode->HasDebugInfo = flags & 1;
+
+    Uint32 sourceFilename = ReadVarint(reader);
+    if (sourceFilename) {
+        const char* string = GetString(sourceFilename - 1, &length);
+        if (!string)
+            goto INVALID;
+        bytecode->SourceFilename = StringUtils::Create((void*)string, length);
+    }
+
+    Uint32 tokenCount;
+    tokenCount = ReadVarint(reader);
+    for (Uint32 t = 0; t < tokenCount && !reader.Failed; t++) {
+        const char* string = GetString(ReadVarint(reader), &length);
+        if (!string)
+            goto INVALID;
+        if (!tokens)
+            continue;
+
+        Uint32 hash = Murmur::EncryptData(string, length);
+        if (!tokens->Exists(hash))
+            tokens->Put(hash, StringUtils::Create((void*)string, length));
+    }
+
+    Uint32 functionCount;
+    functionCount = ReadVarint(reader);
+    if (!functionCount || reader.Failed)
+        goto INVALID;
+
+    for (Uint32 i = 0; i < functionCount; i++) {
+        int arity = ReadVarint(reader);
+        int minArity = ReadVarint(reader);
+        Uint32 nameHash = ReadUInt32(reader);
+        Uint32 name = ReadVarint(reader);
+        Uint32 body = ReadUInt32(reader);
+        if (reader.Failed || body >= Size)
+            goto INVALID;
+
+        const char* string = NULL;
+        if (name) {
+            string = GetString(name - 1, &length);
+            if (!string)
+                goto INVALID;
+        }
+
+        ObjFunction* function = NewFunction();
+        function->Arity = arity;
+        function->MinArity = minArity;
+        function->NameHash = nameHash;
+        if (string)
+            function->Name = ScriptManager::InternString(string, length);
+        function->EncodedChunk = Data + body;
+
+        bytecode->Functions.push_back(function);
+    }
+
+    return true;
+
+INVALID:
+    // Anything already made is left for the garbage collector
+    Log::Print(Log::LOG_ERROR, "Module %08X in the bytecode bundle is invalid!", filenameHash);
+    bytecode->Functions.clear();
+    return false;
+}
+// Returns false if the function's body doesn't fit in the bundle.
+PUBLIC STATIC bool BytecodeBundle::DecodeFunction(ObjFunction* function) {
+    if (!ScriptManager::Lock())
+        return false;
+
+    // Another thread may have got here first
+    if (!function->EncodedChunk) {
+        ScriptManager::Unlock();
+        return true;
+    }
+
+    BundleReader reader = MakeReader(function->EncodedChunk - Data);
+    Chunk* chunk = &function->Chunk;
+
+    Uint8 flags = ReadByte(reader);
+    Uint32 count = ReadVarint(reader);
+    const Uint8* code = ReadBytes(reader, count);
+    if (!code || !count) {
+        Log::Print(Log::LOG_ERROR, "Function in the bytecode bundle is invalid!");
+        ScriptManager::Unlock();
+        return false;
+    }
+
+    chunk->Count = (int)count;
+    chunk->Capacity = (int)count;
+    chunk->Code = (Uint8*)Memory::TrackedMalloc("Chunk::Code", count);
+    memcpy(chunk->Code, code, count);
+
+    if (flags & 1) {
+        chunk->Lines = (int*)Memory::TrackedMalloc("Chunk::Lines", count * sizeof(int));
+
+        int line = 0;
+        for (Uint32 i = 0; i < count; i++) {
+            line += ReadZigzag(reader);
+            chunk->Lines[i] = line;
+        }
+    }
+    chunk->OwnsMemory = true;
+
+    Uint32 constantCount = ReadVarint(reader);
+    for (Uint32 c = 0; c < constantCount && !reader.Failed; c++) {
+        Uint8 type = ReadByte(reader);
+        switch (type) {
+            case VAL_INTEGER:
+                chunk->AddConstant(INTEGER_VAL(ReadZigzag(reader)));
+                break;
+            case VAL_DECIMAL: {
+                const Uint8* bytes = ReadBytes(reader, sizeof(float));
+                float value = 0.0f;
+                if (bytes)
+                    memcpy(&value, bytes, sizeof(float));
+                chunk->AddConstant(DECIMAL_VAL(value));
+                break;
+            }
+            case VAL_OBJECT: {
+                Uint32 length;
+                const char* string = GetString(ReadVarint(reader), &length);
+                if (!string) {
+                    reader.Failed = true;
+                    break;
+                }
+                chunk->AddConstant(OBJECT_VAL(ScriptManager::InternString(string, length)));
+                break;
+            }
+            default:
+                reader.Failed = true;
+                break;
+        }
+    }
+
+    if (reader.Failed) {
+        Log::Print(Log::LOG_ERROR, "Function in the bytecode bundle is invalid!");
+        Memory::Free(chunk->Code);
+        if (chunk->Lines)
+            Memory::Free(chunk->Lines);
+        chunk->Code = NULL;
+        chunk->Lines = NULL;
+        chunk->Count = 0;
+        chunk->Capacity = 0;
+        chunk->Constants->clear();
+        ScriptManager::Unlock();
+        return false;
+    }
+    GC_WRITE_BARRIER(function);
+
+    function->EncodedChunk = NULL;
+
+    ScriptManager::LinkGlobals(function);
+
+    ScriptManager::Unlock();
+    return true;
+}
+// #endregion
+
+// #region Writing
+struct BundleWriter {
+    vector<Uint8>                          Strings;
+    vector<Uint32>                         StringOffsets;
+    std::unordered_map<std::string, Uint32> StringIndices;
+
+    Uint32 AddString(const char* string, size_t length) {
+        std::string key(string, length);
+        auto it = StringIndices.find(key);
+        if (it != StringIndices.end())
+            return it->second;
+
+        Uint32 index = (Uint32)StringOffsets.size();
+        StringOffsets.push_back((Uint32)Strings.size());
+        WriteVarint(Strings, (Uint32)length);
+        Strings.insert(Strings.end(), string, string + length);
+        StringIndices[key] = index;
+        return index;
+    }
+};
+
+// Converts a compiled .ibc file into a module record. Function bodies go
+// into `bodies`, with their offsets relative to its start patched in later.
+static bool   AddBundleModule(BundleWriter& writer, Uint8* data, size_t size, vector<Uint8>& module, vector<Uint8>& bodies, vector<size_t>& bodyFixups) {
+    MemoryStream* stream = MemoryStream::New(data, size);
+    if (!stream)
+        return false;
+
+    Uint8 magic[4];
+    stream->ReadBytes(magic, 4);
+    Uint8 version = stream->ReadByte();
+    if (memcmp(Bytecode::Magic, magic, 4) != 0 || version > Bytecode::LatestVersion) {
+        stream->Close();
+        return false;
+    }
+
+    Uint8 opts = stream->ReadByte();
+    stream->Skip(2);
+
+    bool hasDebugInfo = opts & 1;
+
+    struct FunctionInfo {
+        int    Arity;
+        int    MinArity;
+        Uint32 NameHash;
+        size_t Body;
+    };
+    vector<FunctionInfo> functions;
+
+    int chunkCount = stream->ReadInt32();
+    for (int i = 0; i < chunkCount; i++) {
+        FunctionInfo info;
+        int length = stream->ReadInt32();
+        if (version < 0x0001) {
+            info.Arity = stream->ReadInt32();
+            info.MinArity = info.Arity;
+        }
+        else {
+            info.Arity = stream->ReadByte();
+            info.MinArity = stream->ReadByte();
+        }
+        info.NameHash = stream->ReadUInt32();
+        info.Body = bodies.size();
+        functions.push_back(info);
+
+        bodies.push_back(hasDebugInfo ? 1 : 0);
+        WriteVarint(bodies, (Uint32)length);
+        bodies.insert(bodies.end(), stream->pointer, stream->pointer + length);
+        stream->Skip(length);
+
+        if (hasDebugInfo) {
+            int line = 0;
+            for (int b = 0; b < length; b++) {
+                int next = stream->ReadInt32();
+                WriteZigzag(bodies, next - line);
+                line = next;
+            }
+        }
+
+        int constantCount = stream->ReadInt32();
+        WriteVarint(bodies, (Uint32)constantCount);
+        for (int c = 0; c < constantCount; c++) {
+            Uint8 type = stream->ReadByte();
+            bodies.push_back(type);
+            switch (type) {
+                case VAL_INTEGER:
+                    WriteZigzag(bodies, stream->ReadInt32());
+                    break;
+                case VAL_DECIMAL: {
+                    float value = stream->ReadFloat();
+                    Uint8 bytes[sizeof(float)];
+                    memcpy(bytes, &value, sizeof(float));
+                    bodies.insert(bodies.end(), bytes, bytes + sizeof(float));
+                    break;
+                }
+                case VAL_OBJECT: {
+                    const char* string = (const char*)stream->pointer;
+                    size_t length = strlen(string);
+                    stream->Skip(length + 1);
+                    WriteVarint(bodies, writer.AddString(string, length));
+                    break;
+                }
+            }
+        }
+    }
+
+    vector<Uint32> tokens;
+    std::unordered_map<Uint32, Uint32> names;
+    if (hasDebugInfo) {
+        int tokenCount = stream->ReadInt32();
+        for (int t = 0; t < tokenCount; t++) {
+            const char* string = (const char*)stream->pointer;
+            size_t length = strlen(string);
+            stream->Skip(length + 1);
+
+            Uint32 index = writer.AddString(string, length);
+            tokens.push_back(index);
+            names[Murmur::EncryptData(string, length)] = index;
+        }
+    }
+
+    Uint32 sourceFilename = 0;
+    if (opts & 2) {
+        const char* string = (const char*)stream->pointer;
+        sourceFilename = writer.AddString(string, strlen(string)) + 1;
+    }
+
+    stream->Close();
+
+    module.push_back(hasDebugInfo ? 1 : 0);
+    WriteVarint(module, sourceFilename);
+    WriteVarint(module, (Uint32)tokens.size());
+    for (size_t t = 0; t < tokens.size(); t++)
+        WriteVarint(module, tokens[t]);
+
+    WriteVarint(module, (Uint32)functions.size());
+    for (size_t f = 0; f < functions.size(); f++) {
+        FunctionInfo& info = functions[f];
+        WriteVarint(module, (Uint32)info.Arity);
+        WriteVarint(module, (Uint32)info.MinArity);
+        WriteRawUInt32(module, info.NameHash);
+
+        auto it = names.find(info.NameHash);
+        WriteVarint(module, it != names.end() ? it->second + 1 : 0);
+
+        // Fixed width, since the final offset isn't known yet
+        bodyFixups.push_back(module.size());
+        WriteRawUInt32(module, (Uint32)info.Body);
+    }
+
+    return true;
+}
+
+// Packs the compiled .ibc files of the given scripts into one bundle.
+PUBLIC STATIC bool BytecodeBundle::Write(const char* outFile, vector<Uint32>& filenameHashes) {
+    BundleWriter writer;
+
+    std::sort(filenameHashes.begin(), filenameHashes.end());
+
+    vector<Uint32>        hashes;
+    vector<vector<Uint8>> modules;
+    vector<vector<size_t>> fixups;
+    vector<Uint8>         bodies;
+
+    for (size_t i = 0; i < filenameHashes.size(); i++) {
+        char filename[64];
+        snprintf(filename, sizeof filename, "Resources/Objects/%08X.ibc", filenameHashes[i]);
+
+        char* data = NULL;
+        size_t size = File::ReadAllBytes(filename, &data);
+        if (!size) {
+            Memory::Free(data);
+            continue;
+        }
+
+        vector<Uint8> module;
+        vector<size_t> moduleFixups;
+        size_t bodyStart = bodies.size();
+        if (AddBundleModule(writer, (Uint8*)data, size, module, bodies, moduleFixups)) {
+            hashes.push_back(filenameHashes[i]);
+            modules.push_back(module);
+            fixups.push_back(moduleFixups);
+        }
+        else {
+            bodies.resize(bodyStart);
+            Log::Print(Log::LOG_WARN, "Could not add %s to the bytecode bundle.", filename);
+        }
+
+        Memory::Free(data);
+    }
+
+    Uint32 moduleCount = (Uint32)modules.size();
+    Uint32 stringCount = (Uint32)writer.StringOffsets.size();
+
+    size_t headerSize = 16 + moduleCount * 8 + stringCount * 4;
+    size_t stringsStart = headerSize;
+    size_t modulesStart = stringsStart + writer.Strings.size();
+    size_t bodiesStart = modulesStart;
+    for (Uint32 i = 0; i < moduleCount; i++)
+        bodiesStart += modules[i].size();
+
+    vector<Uint8> header;
+    header.insert(header.end(), Magic, Magic + 4);
+    header.push_back(BUNDLE_VERSION);
+    header.push_back(0x00);
+    header.push_back(0x00);
+    header.push_back(0x00);
+    WriteRawUInt32(header, moduleCount);
+    WriteRawUInt32(header, stringCount);
+
+    size_t moduleOffset = modulesStart;
+    for (Uint32 i = 0; i < moduleCount; i++) {
+        WriteRawUInt32(header, hashes[i]);
+        WriteRawUInt32(header, (Uint32)moduleOffset);
+        moduleOffset += modules[i].size();
+
+        // Point the function entries at their bodies
+        for (size_t f = 0; f < fixups[i].size(); f++) {
+            Uint8* entry = &modules[i][fixups[i][f]];
+            Uint32 body;
+            memcpy(&body, entry, sizeof(Uint32));
+            body += (Uint32)bodiesStart;
+            memcpy(entry, &body, sizeof(Uint32));
+        }
+    }
+    for (Uint32 i = 0; i < stringCount; i++)
+        WriteRawUInt32(header, (Uint32)(stringsStart + writer.StringOffsets[i]));
+
+    FileStream* stream = FileStream::New(outFile, FileStream::WRITE_ACCESS);
+    if (!stream)
+        return false;
+
+    stream->WriteBytes(header.data(), header.size());
+    stream->WriteBytes(writer.Strings.data(), writer.Strings.size());
+    for (Uint32 i = 0; i < moduleCount; i++)
+        stream->WriteBytes(modules[i].data(), modules[i].size());
+    stream->WriteBytes(bodies.data(), bodies.size());
+    stream->Close();
+
+    return true;
+}
+// #endregion
@@ -4,15 +4,18 @@
 
 class Compiler {
 public:
-    static Parser               parser;
-    static Scanner              scanner;
-    static ParseRule*           Rules;
-    static vector<ObjFunction*> Functions;
-    static vector<Local>        ModuleLocals;
-    static HashMap<Token>*      TokenMap;
-    static bool                 ShowWarnings;
-    static bool                 WriteDebugInfo;
-    static bool                 WriteSourceFilename;
+    static thread_local Parser               parser;
+    static thread_local Scanner              scanner;
+    static ParseRule*                        Rules;
+    static thread_local vector<ObjFunction*> Functions;
+    static thread_local vector<Local>        ModuleLocals;
+    static thread_local HashMap<Token>*      TokenMap;
+    static thread_local bool                 DeferFatalErrors;
+    static thread_local char*                FatalError;
+    static bool                              ShowWarnings;
+    static bool                              WriteDebugInfo;
+    static bool                              WriteSourceFilename;
+    static bool                              DoOptimizations;
 
     class Compiler* Enclosing = nullptr;
     ObjFunction*    Function = nullptr;
@@ -42,16 +45,21 @@ public:
 
 #include <Engine/Application.h>
 
-Parser               Compiler::parser;
-Scanner              Compiler::scanner;
-ParseRule*           Compiler::Rules = NULL;
-vector<ObjFunction*> Compiler::Functions;
-vector<Local>        Compiler::ModuleLocals;
-HashMap<Token>*      Compiler::TokenMap = NULL;
-
-bool                 Compiler::ShowWarnings = false;
-bool                 Compiler::WriteDebugInfo = false;
-bool                 Compiler::WriteSourceFilename = false;
+// Everything a single compile touches is per-thread, so that several
+// files can be compiled at once.
+thread_local Parser               Compiler::parser;
+thread_local Scanner              Compiler::scanner;
+ParseRule*                        Compiler::Rules = NULL;
+thread_local vector<ObjFunction*> Compiler::Functions;
+thread_local vector<Local>        Compiler::ModuleLocals;
+thread_local HashMap<Token>*      Compiler::TokenMap = NULL;
+thread_local bool                 Compiler::DeferFatalErrors = false;
+thread_local char*                Compiler::FatalError = NULL;
+
+bool                              Compiler::ShowWarnings = false;
+bool                              Compiler::WriteDebugInfo = false;
+bool                              Compiler::WriteSourceFilename = false;
+bool                              Compiler::DoOptimizations = true;
 
 #define Panic(returnMe) if (parser.PanicMode) { SynchronizeToken(); return returnMe; }
 
@@ -719,6 +727,19 @@ PUBLIC bool          Compiler::ReportErrorPos(int line, int pos, bool fatal, con
 
 	Log::Print(Log::LOG_ERROR, textBuffer);
 
+    // Off the main thread, the error is kept for the caller to show.
+    if (Compiler::DeferFatalErrors) {
+        if (Compiler::FatalError)
+            free(textBuffer);
+        else
+            Compiler::FatalError = textBuffer;
+        return false;
+    }
+
+    Compiler::ShowFatalError(textBuffer);
+    return false;
+}
+PUBLIC STATIC void   Compiler::ShowFatalError(char* textBuffer) {
 	const SDL_MessageBoxButtonData buttonsFatal[] = {
 		{ SDL_MESSAGEBOX_BUTTON_ESCAPEKEY_DEFAULT, 0, "Exit" },
 	};
@@ -739,8 +760,6 @@ PUBLIC bool          Compiler::ReportErrorPos(int line, int pos, bool fatal, con
 
 	Application::Cleanup();
 	exit(-1);
-
-    return false;
 }
 PUBLIC void          Compiler::ErrorAt(Token* token, const char* message, bool fatal) {
     if (fatal) {
@@ -1164,7 +1183,7 @@ PUBLIC Uint8 Compiler::GetArgumentList() {
     return argumentCount;
 }
 
-Token InstanceToken = Token { 0, NULL, 0, 0, 0 };
+thread_local Token InstanceToken = Token { 0, NULL, 0, 0, 0 };
 PUBLIC void  Compiler::GetThis(bool canAssign) {
     InstanceToken = parser.Previous;
     GetVariable(false);
@@ -1270,7 +1289,7 @@ PUBLIC void  Compiler::GetElement(bool canAssign) {
 }
 
 // Reading expressions
-bool negateConstant = false;
+thread_local bool negateConstant = false;
 PUBLIC void Compiler::GetGrouping(bool canAssign) {
     GetExpression();
     ConsumeToken(TOKEN_RIGHT_PAREN, "Expected \")\" after expression.");
@@ -1579,12 +1598,12 @@ struct switch_case {
     Uint8* CodeBlock;
     int*   LineBlock;
 };
-stack<vector<int>*> BreakJumpListStack;
-stack<vector<int>*> ContinueJumpListStack;
-stack<vector<switch_case>*> SwitchJumpListStack;
-stack<int> BreakScopeStack;
-stack<int> ContinueScopeStack;
-stack<int> SwitchScopeStack;
+thread_local stack<vector<int>*> BreakJumpListStack;
+thread_local stack<vector<int>*> ContinueJumpListStack;
+thread_local stack<vector<switch_case>*> SwitchJumpListStack;
+thread_local stack<int> BreakScopeStack;
+thread_local stack<int> ContinueScopeStack;
+thread_local stack<int> SwitchScopeStack;
 PUBLIC void Compiler::GetPrintStatement() {
     GetExpression();
     ConsumeToken(TOKEN_SEMICOLON, "Expected \";\" after value.");
@@ -2840,6 +2859,338 @@ PUBLIC void          Compiler::SetReceiverName(Token name) {
     local->Name = name;
 }
 
+// Optimization
+struct OptInstruction {
+    int   Offset; // Offset in the unoptimized chunk
+    int   Length;
+    Uint8 Code[8];
+    int   Line;
+    int   Target; // Unoptimized jump target, or -1
+};
+
+static int  OptGetJumpTarget(Uint8* code, int offset, int length) {
+    Sint16 jump = (Sint16)(code[length - 2] | (code[length - 1] << 8));
+    switch (code[0]) {
+        case OP_JUMP:
+        case OP_JUMP_IF_FALSE:
+            return offset + length + jump;
+        case OP_JUMP_BACK:
+            return offset + length - jump;
+        case OP_WITH:
+            // INIT and INIT_SLOTTED skip the loop, ITERATE loops back
+            if (code[1] == 0 || code[1] == 3)
+                return offset + length + jump;
+            if (code[1] == 1)
+                return offset + length - jump;
+            return -1;
+    }
+    return -1;
+}
+static bool OptSetJump(OptInstruction* inst, int offset, int target) {
+    int jump = target - (offset + inst->Length);
+    if (inst->Code[0] == OP_JUMP_BACK || (inst->Code[0] == OP_WITH && inst->Code[1] == 1))
+        jump = -jump;
+    if (jump < INT16_MIN || jump > INT16_MAX)
+        return false;
+
+    inst->Code[inst->Length - 2] = jump & 0xFF;
+    inst->Code[inst->Length - 1] = (jump >> 8) & 0xFF;
+    return true;
+}
+static bool OptGetConstant(Chunk* chunk, OptInstruction* inst, VMValue* value) {
+    switch (inst->Code[0]) {
+        case OP_TRUE:
+            *value = INTEGER_VAL(1);
+            return true;
+        case OP_FALSE:
+            *value = INTEGER_VAL(0);
+            return true;
+        case OP_CONSTANT:
+            *value = (*chunk->Constants)[*(Uint32*)&inst->Code[1]];
+            return IS_INTEGER(*value) || IS_DECIMAL(*value);
+    }
+    return false;
+}
+static void OptSetConstant(Chunk* chunk, OptInstruction* inst, VMValue value) {
+    Uint32 index = 0;
+    for (; index < chunk->Constants->size(); index++) {
+        // Compare decimals bitwise, so that -0.0 doesn't become 0.0
+        VMValue other = (*chunk->Constants)[index];
+        if (VALUE_TYPE(other) != VALUE_TYPE(value))
+            continue;
+        if (IS_INTEGER(value) && AS_INTEGER(other) == AS_INTEGER(value))
+            break;
+        if (IS_DECIMAL(value)) {
+            float a = AS_DECIMAL(other);
+            float b = AS_DECIMAL(value);
+            if (!memcmp(&a, &b, sizeof(float)))
+                break;
+        }
+    }
+    if (index == chunk->Constants->size())
+        index = chunk->AddConstant(value);
+
+    inst->Length = 5;
+    inst->Code[0] = OP_CONSTANT;
+    inst->Code[1] = index & 0xFF;
+    inst->Code[2] = index >> 8 & 0xFF;
+    inst->Code[3] = index >> 16 & 0xFF;
+    inst->Code[4] = index >> 24 & 0xFF;
+}
+// Mirrors VMThread::Values_* for number operands. Anything that could
+// throw at runtime, or is undefined on the host, is left to the VM.
+static bool OptFoldBinary(Uint8 op, VMValue a, VMValue b, VMValue* result) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
+        float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
+        float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
+        switch (op) {
+            case OP_ADD:            *result = DECIMAL_VAL(a_d + b_d); return true;
+            case OP_SUBTRACT:       *result = DECIMAL_VAL(a_d - b_d); return true;
+            case OP_MULTIPLY:       *result = DECIMAL_VAL(a_d * b_d); return true;
+            case OP_DIVIDE:
+                if (b_d == 0.0)
+                    return false;
+                *result = DECIMAL_VAL(a_d / b_d);
+                return true;
+            case OP_LESS:           *result = INTEGER_VAL(a_d < b_d); return true;
+            case OP_GREATER:        *result = INTEGER_VAL(a_d > b_d); return true;
+            case OP_LESS_EQUAL:     *result = INTEGER_VAL(a_d <= b_d); return true;
+            case OP_GREATER_EQUAL:  *result = INTEGER_VAL(a_d >= b_d); return true;
+            case OP_EQUAL:          *result = INTEGER_VAL(ScriptManager::ValuesSortaEqual(a, b)); return true;
+            case OP_EQUAL_NOT:      *result = INTEGER_VAL(!ScriptManager::ValuesSortaEqual(a, b)); return true;
+        }
+        return false;
+    }
+
+    int a_d = AS_INTEGER(a);
+    int b_d = AS_INTEGER(b);
+    switch (op) {
+        // Wrap on overflow like the VM does on every supported target
+        case OP_ADD:            *result = INTEGER_VAL((int)((Uint32)a_d + (Uint32)b_d)); return true;
+        case OP_SUBTRACT:       *result = INTEGER_VAL((int)((Uint32)a_d - (Uint32)b_d)); return true;
+        case OP_MULTIPLY:       *result = INTEGER_VAL((int)((Uint32)a_d * (Uint32)b_d)); return true;
+        case OP_DIVIDE:
+        case OP_MODULO:
+            if (b_d == 0 || (a_d == INT32_MIN && b_d == -1))
+                return false;
+            *result = INTEGER_VAL(op == OP_DIVIDE ? a_d / b_d : a_d % b_d);
+            return true;
+        case OP_BITSHIFT_LEFT:
+        case OP_BITSHIFT_RIGHT:
+            if (a_d < 0 || b_d < 0 || b_d > 31)
+                return false;
+            *result = INTEGER_VAL(op == OP_BITSHIFT_LEFT ? (int)((Uint32)a_d << b_d) : a_d >> b_d);
+            return true;
+        case OP_BW_AND:         *result = INTEGER_VAL(a_d & b_d); return true;
+        case OP_BW_OR:          *result = INTEGER_VAL(a_d | b_d); return true;
+        case OP_BW_XOR:         *result = INTEGER_VAL(a_d ^ b_d); return true;
+        case OP_LESS:           *result = INTEGER_VAL(a_d < b_d); return true;
+        case OP_GREATER:        *result = INTEGER_VAL(a_d > b_d); return true;
+        case OP_LESS_EQUAL:     *result = INTEGER_VAL(a_d <= b_d); return true;
+        case OP_GREATER_EQUAL:  *result = INTEGER_VAL(a_d >= b_d); return true;
+        case OP_EQUAL:          *result = INTEGER_VAL(a_d == b_d); return true;
+        case OP_EQUAL_NOT:      *result = INTEGER_VAL(a_d != b_d); return true;
+    }
+    return false;
+}
+static bool OptFoldUnary(Uint8 op, VMValue a, VMValue* result) {
+    switch (op) {
+        case OP_NEGATE:
+            if (VALUE_TYPE(a) == VAL_DECIMAL)
+                *result = DECIMAL_VAL(-AS_DECIMAL(a));
+            else
+                *result = INTEGER_VAL((int)(0U - (Uint32)AS_INTEGER(a)));
+            return true;
+        case OP_BW_NOT:
+            if (VALUE_TYPE(a) == VAL_DECIMAL)
+                *result = DECIMAL_VAL((float)(~(int)AS_DECIMAL(a)));
+            else
+                *result = INTEGER_VAL(~AS_INTEGER(a));
+            return true;
+        case OP_LG_NOT:
+            if (VALUE_TYPE(a) == VAL_DECIMAL)
+                *result = DECIMAL_VAL((float)(AS_DECIMAL(a) == 0.0));
+            else
+                *result = INTEGER_VAL(!AS_INTEGER(a));
+            return true;
+    }
+    return false;
+}
+static bool OptIsPurePush(Uint8 op) {
+    switch (op) {
+        case OP_NULL:
+        case OP_TRUE:
+        case OP_FALSE:
+        case OP_CONSTANT:
+        case OP_GET_LOCAL:
+        case OP_GET_MODULE_LOCAL:
+            return true;
+    }
+    return false;
+}
+// Index of the first kept instruction at or after an unoptimized offset
+static size_t OptFindInstruction(vector<OptInstruction>& list, int offset) {
+    size_t lo = 0, hi = list.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (list[mid].Offset < offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+PUBLIC STATIC void   Compiler::OptimizeChunk(Chunk* chunk) {
+    vector<OptInstruction> in;
+    vector<bool> isTarget(chunk->Count + 1, false);
+
+    // Decode. Anything the decoder doesn't understand leaves the chunk as-is.
+    for (int offset = 0; offset < chunk->Count; ) {
+        OptInstruction inst;
+        inst.Offset = offset;
+        inst.Length = Bytecode::GetInstructionLength(chunk->Code + offset);
+        if (inst.Length == 0 || offset + inst.Length > chunk->Count)
+            return;
+
+        memcpy(inst.Code, chunk->Code + offset, inst.Length);
+        inst.Line = chunk->Lines[offset];
+        inst.Target = OptGetJumpTarget(inst.Code, offset, inst.Length);
+        if (inst.Target != -1) {
+            if (inst.Target < 0 || inst.Target > chunk->Count)
+                return;
+            isTarget[inst.Target] = true;
+        }
+
+        in.push_back(inst);
+        offset += inst.Length;
+    }
+
+    // Drop unreachable code, and fold and combine instructions as they're
+    // appended. Only the first instruction of a rewritten sequence may be a
+    // jump target, so control can never land in the middle of one.
+    vector<OptInstruction> out;
+    bool reachable = true;
+    for (size_t i = 0; i < in.size(); i++) {
+        if (!reachable && !isTarget[in[i].Offset])
+            continue;
+
+        reachable = true;
+        switch (in[i].Code[0]) {
+            case OP_JUMP:
+            case OP_JUMP_BACK:
+            case OP_RETURN:
+                reachable = false;
+                break;
+        }
+
+        out.push_back(in[i]);
+
+        for (bool changed = true; changed; ) {
+            changed = false;
+
+            size_t n = out.size();
+            VMValue a, b, result;
+            if (n >= 3
+                && !isTarget[out[n - 1].Offset]
+                && !isTarget[out[n - 2].Offset]
+                && OptGetConstant(chunk, &out[n - 3], &a)
+                && OptGetConstant(chunk, &out[n - 2], &b)
+                && OptFoldBinary(out[n - 1].Code[0], a, b, &result)) {
+                OptSetConstant(chunk, &out[n - 3], result);
+                out.resize(n - 2);
+                changed = true;
+            }
+            else if (n >= 2
+                && !isTarget[out[n - 1].Offset]
+                && OptGetConstant(chunk, &out[n - 2], &a)
+                && OptFoldUnary(out[n - 1].Code[0], a, &result)) {
+                OptSetConstant(chunk, &out[n - 2], result);
+                out.resize(n - 1);
+                changed = true;
+            }
+            else if (n >= 2
+                && !isTarget[out[n - 1].Offset]
+                && out[n - 1].Code[0] == OP_POP
+                && OptIsPurePush(out[n - 2].Code[0])) {
+                out.resize(n - 2);
+                changed = true;
+            }
+            else if (n >= 2
+                && !isTarget[out[n - 1].Offset]
+                && (out[n - 1].Code[0] == OP_POP || out[n - 1].Code[0] == OP_POPN)
+                && (out[n - 2].Code[0] == OP_POP || out[n - 2].Code[0] == OP_POPN)) {
+                int count = (out[n - 2].Code[0] == OP_POP ? 1 : out[n - 2].Code[1])
+                          + (out[n - 1].Code[0] == OP_POP ? 1 : out[n - 1].Code[1]);
+                if (count <= UINT8_MAX) {
+                    out[n - 2].Length = 2;
+                    out[n - 2].Code[0] = OP_POPN;
+                    out[n - 2].Code[1] = count;
+                    out.resize(n - 1);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // Thread jumps that land on other jumps straight to their destination.
+    for (size_t i = 0; i < out.size(); i++) {
+        Uint8 op = out[i].Code[0];
+        if (op != OP_JUMP && op != OP_JUMP_IF_FALSE)
+            continue;
+
+        size_t dest = OptFindInstruction(out, out[i].Target);
+        for (int hops = 0; hops < 8 && dest < out.size() && dest != i; hops++) {
+            Uint8 destOp = out[dest].Code[0];
+            // OP_JUMP_IF_FALSE leaves its condition on the stack,
+            // so a second one would take the same branch.
+            if (destOp != OP_JUMP && !(op == OP_JUMP_IF_FALSE && destOp == OP_JUMP_IF_FALSE))
+                break;
+
+            out[i].Target = out[dest].Target;
+            dest = OptFindInstruction(out, out[i].Target);
+        }
+
+        if (op == OP_JUMP && out[i].Target < out[i].Offset)
+            out[i].Code[0] = OP_JUMP_BACK;
+    }
+
+    // Jumps to the next instruction do nothing.
+    vector<OptInstruction> list;
+    for (size_t i = 0; i < out.size(); i++) {
+        Uint8 op = out[i].Code[0];
+        if ((op == OP_JUMP || op == OP_JUMP_IF_FALSE)
+            && OptFindInstruction(out, out[i].Target) == i + 1)
+            continue;
+        list.push_back(out[i]);
+    }
+
+    // Lay out the new code, then re-patch the jumps against it.
+    vector<int> offsets(list.size() + 1);
+    int count = 0;
+    for (size_t i = 0; i < list.size(); i++) {
+        offsets[i] = count;
+        count += list[i].Length;
+    }
+    offsets[list.size()] = count;
+
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i].Target == -1)
+            continue;
+        int target = offsets[OptFindInstruction(list, list[i].Target)];
+        if (!OptSetJump(&list[i], offsets[i], target))
+            return;
+    }
+
+    for (size_t i = 0; i < list.size(); i++) {
+        for (int b = 0; b < list[i].Length; b++) {
+            chunk->Code[offsets[i] + b] = list[i].Code[b];
+            chunk->Lines[offsets[i] + b] = list[i].Line;
+        }
+    }
+    chunk->Count = count;
+}
+
 // Debugging functions
 PUBLIC STATIC int    Compiler::HashInstruction(const char* name, Chunk* chunk, int offset) {
     uint32_t hash = *(uint32_t*)&chunk->Code[offset + 1];
@@ -3095,6 +3446,7 @@ PUBLIC STATIC void   Compiler::Init() {
     Compiler::ShowWarnings = false;
     Compiler::WriteDebugInfo = true;
     Compiler::WriteSourceFilename = true;
+    Compiler::DoOptimizations = true;
 }
 PUBLIC STATIC void   Compiler::PrepareCompiling() {
     if (Compiler::TokenMap == NULL) {
@@ -3176,6 +3528,11 @@ PUBLIC bool          Compiler::Compile(const char* filename, const char* source,
 
     Finish();
 
+    if (Compiler::DoOptimizations) {
+        for (size_t c = 0; c < Compiler::Functions.size(); c++)
+            OptimizeChunk(&Compiler::Functions[c]->Chunk);
+    }
+
     bool debugCompiler = false;
     Application::Settings->GetBool("dev", "debugCompiler", &debugCompiler);
     if (debugCompiler) {
@@ -14,6 +14,31 @@ public:
     static bool         Print;
     static bool         FilterSweepEnabled;
     static int          FilterSweepType;
+
+    static bool         Incremental;
+    static int          State;
+    static Obj*         SweepList;
+    static Obj**        SweepCursor;
+
+    static bool         Generational;
+    static bool         CollectingYoung;
+    static Obj*         NurseryObject;
+    static size_t       NurserySize;
+    static size_t       NurseryLimit;
+    static vector<Obj*> RememberedSet;
+
+    static double       LastPause;
+    static double       MaxPause;
+    static double       TotalPause;
+    static Uint32       SliceCount;
+    static Uint32       CycleCount;
+    static Uint32       MinorCount;
+
+    enum {
+        STATE_IDLE,
+        STATE_MARK,
+        STATE_SWEEP
+    };
 };
 #endif
 
@@ -28,6 +53,11 @@ public:
 
 #define GC_HEAP_GROW_FACTOR 2
 
+// How much marking or sweeping to do between clock checks
+#define GC_WORK_PER_CHECK 32
+
+#define GC_NO_DEADLINE -1.0
+
 vector<Obj*> GarbageCollector::GrayList;
 Obj*         GarbageCollector::RootObject;
 
@@ -39,18 +69,201 @@ bool         GarbageCollector::Print = false;
 bool         GarbageCollector::FilterSweepEnabled = false;
 int          GarbageCollector::FilterSweepType = 0;
 
+bool         GarbageCollector::Incremental = false;
+int          GarbageCollector::State = GarbageCollector::STATE_IDLE;
+Obj*         GarbageCollector::SweepList = NULL;
+Obj**        GarbageCollector::SweepCursor = NULL;
+
+bool         GarbageCollector::Generational = false;
+bool         GarbageCollector::CollectingYoung = false;
+Obj*         GarbageCollector::NurseryObject = NULL;
+size_t       GarbageCollector::NurserySize = 0;
+size_t       GarbageCollector::NurseryLimit = 256 * 1024;
+vector<Obj*> GarbageCollector::RememberedSet;
+
+double       GarbageCollector::LastPause = 0.0;
+double       GarbageCollector::MaxPause = 0.0;
+double       GarbageCollector::TotalPause = 0.0;
+Uint32       GarbageCollector::SliceCount = 0;
+Uint32       GarbageCollector::CycleCount = 0;
+Uint32       GarbageCollector::MinorCount = 0;
+
+static int   ObjectTypeFreed[MAX_OBJ_TYPE];
+static int   ObjectTypeCounts[MAX_OBJ_TYPE];
+
 PUBLIC STATIC void GarbageCollector::Init() {
     GarbageCollector::RootObject = NULL;
     GarbageCollector::NextGC = 0x100000;
+    GarbageCollector::State = STATE_IDLE;
+    GarbageCollector::SweepList = NULL;
+    GarbageCollector::SweepCursor = NULL;
+    GarbageCollector::GrayList.clear();
+    GarbageCollector::NurseryObject = NULL;
+    GarbageCollector::NurserySize = 0;
+    GarbageCollector::RememberedSet.clear();
 }
 
 PUBLIC STATIC void GarbageCollector::Collect() {
+    double pauseStart = Clock::GetTicks();
+
+    // A forced collection has to free everything that is unreachable
+    // right now, so an incremental cycle can't just be resumed.
+    if (State == STATE_MARK) {
+        for (Obj* object = RootObject; object; object = object->Next) {
+            object->IsDark = false;
+            object->IsGray = false;
+        }
+        for (Obj* object = NurseryObject; object; object = object->Next) {
+            object->IsDark = false;
+            object->IsGray = false;
+        }
+        State = STATE_IDLE;
+    }
+    else if (State == STATE_SWEEP) {
+        SweepObjects(GC_NO_DEADLINE);
+        FinishCycle();
+    }
+
     GrayList.clear();
 
     double grayElapsed = Clock::GetTicks();
 
+    GrayRoots();
+
+    grayElapsed = Clock::GetTicks() - grayElapsed;
+
+    double blackenElapsed = Clock::GetTicks();
+
+    // Traverse references
+    DrainGrayList(GC_NO_DEADLINE);
+
+    blackenElapsed = Clock::GetTicks() - blackenElapsed;
+
+    double freeElapsed = Clock::GetTicks();
+
+    // Collect the white objects
+    BeginSweep();
+    SweepObjects(GC_NO_DEADLINE);
+
+    freeElapsed = Clock::GetTicks() - freeElapsed;
+
+    Log::Print(Log::LOG_VERBOSE, "Sweep: Graying took %.1f ms", grayElapsed);
+    Log::Print(Log::LOG_VERBOSE, "Sweep: Blackening took %.1f ms", blackenElapsed);
+    Log::Print(Log::LOG_VERBOSE, "Sweep: Freeing took %.1f ms", freeElapsed);
+
+    FinishCycle();
+
+    RecordPause(Clock::GetTicks() - pauseStart);
+}
+PUBLIC STATIC void GarbageCollector::Step() {
+    double pauseStart = Clock::GetTicks();
+    double deadline = pauseStart + MaxTimeAlotted;
+
+    if (State == STATE_IDLE) {
+        GrayList.clear();
+        GrayRoots();
+        State = STATE_MARK;
+    }
+
+    if (State == STATE_MARK && DrainGrayList(deadline)) {
+        // Roots aren't behind the write barrier, so pick up whatever the
+        // stacks, globals and entity lists gained since the cycle began.
+        // This last pass can't be split up, but the stacks are empty at
+        // the end of a frame so there's rarely much left to trace.
+        GrayRoots();
+        DrainGrayList(GC_NO_DEADLINE);
+        BeginSweep();
+    }
+
+    if (State == STATE_SWEEP && SweepObjects(deadline))
+        FinishCycle();
+
+    RecordPause(Clock::GetTicks() - pauseStart);
+}
+
+PUBLIC STATIC void GarbageCollector::CollectYoung() {
+    if (State != STATE_IDLE)
+        return;
+
+    double pauseStart = Clock::GetTicks();
+
+    // Only objects allocated since the last collection are traced;
+    // everything older is assumed to be alive.
+    CollectingYoung = true;
+
+    GrayList.clear();
+    GrayRoots();
+
+    // Old objects that were stored into may be all that keeps
+    // a young object alive, so scan those too.
+    for (size_t i = 0; i < RememberedSet.size(); i++) {
+        RememberedSet[i]->IsRemembered = false;
+        BlackenObject(RememberedSet[i]);
+    }
+    RememberedSet.clear();
+
+    DrainGrayList(GC_NO_DEADLINE);
+
+    CollectingYoung = false;
+
+    // Freeing an instance can delete its entity, which may allocate,
+    // so start a new nursery before walking the old one.
+    Obj* object = NurseryObject;
+    NurseryObject = NULL;
+    NurserySize = 0;
+
+    while (object) {
+        Obj* next = object->Next;
+        if (!object->IsDark) {
+            GarbageCollector::FreeValue(OBJECT_VAL(object));
+        }
+        else {
+            // Promote survivors to the old generation
+            object->IsDark = false;
+            object->IsOld = true;
+            object->Next = RootObject;
+            RootObject = object;
+        }
+        object = next;
+    }
+
+    MinorCount++;
+
+    RecordPause(Clock::GetTicks() - pauseStart);
+}
+
+PUBLIC STATIC void GarbageCollector::WriteBarrier(Obj* object) {
+    if (State == STATE_MARK)
+        Regray(object);
+
+    if (Generational && object->IsOld && !object->IsRemembered) {
+        object->IsRemembered = true;
+        RememberedSet.push_back(object);
+    }
+}
+PUBLIC STATIC void GarbageCollector::WriteBarrierValues(VMValue* values, int count) {
+    if (State != STATE_MARK && !Generational)
+        return;
+
+    for (int i = 0; i < count; i++) {
+        if (IS_OBJECT(values[i]))
+            WriteBarrier(AS_OBJECT(values[i]));
+    }
+}
+PUBLIC STATIC void GarbageCollector::Regray(Obj* object) {
+    // A white object will still be found through whatever refers to it,
+    // and a gray one hasn't been scanned yet.
+    if (!object->IsDark || object->IsGray)
+        return;
+
+    object->IsGray = true;
+    GrayList.push_back(object);
+}
+
+PRIVATE STATIC void GarbageCollector::GrayRoots() {
     // Mark threads (should lock here for safety)
-    for (Uint32 t = 0; t < ScriptManager::ThreadCount; t++) {
+    // Worker threads aren't numbered by ThreadCount, so every one is scanned.
+    for (Uint32 t = 0; t < sizeof(ScriptManager::Threads) / sizeof(VMThread); t++) {
         VMThread* thread = ScriptManager::Threads + t;
         // Mark stack roots
         for (VMValue* slot = thread->Stack; slot < thread->StackTop; slot++) {
@@ -62,6 +275,18 @@ PUBLIC STATIC void GarbageCollector::Collect() {
         }
     }
 
+    // Mark script jobs that are waiting to run or to be joined
+    for (Uint32 i = 0; i < ScriptManager::MAX_JOBS; i++) {
+        ScriptJob* job = &ScriptManager::Jobs[i];
+        if (SDL_AtomicGet(&job->State) == ScriptManager::JOB_FREE)
+            continue;
+
+        GrayValue(job->Callback);
+        for (int a = 0; a < job->ArgCount; a++)
+            GrayValue(job->Args[a]);
+        GrayValue(job->Result);
+    }
+
     // Mark global roots
     GrayHashMap(ScriptManager::Globals);
 
@@ -104,58 +329,107 @@ PUBLIC STATIC void GarbageCollector::Collect() {
     for (size_t i = 0; i < ScriptManager::ClassImplList.size(); i++) {
         GrayObject(ScriptManager::ClassImplList[i]);
     }
+}
+PRIVATE STATIC bool GarbageCollector::DrainGrayList(double deadline) {
+    Uint32 work = 0;
+    while (!GrayList.empty()) {
+        Obj* object = GrayList.back();
+        GrayList.pop_back();
+        BlackenObject(object);
+
+        if (deadline != GC_NO_DEADLINE
+            && ++work % GC_WORK_PER_CHECK == 0
+            && Clock::GetTicks() >= deadline)
+            return false;
+    }
+    return true;
+}
+PRIVATE STATIC void GarbageCollector::BeginSweep() {
+    // The nursery is swept along with everything else, and whatever
+    // survives this cycle is old from here on.
+    if (NurseryObject) {
+        Obj* tail = NurseryObject;
+        tail->IsOld = true;
+        while (tail->Next) {
+            tail = tail->Next;
+            tail->IsOld = true;
+        }
+        tail->Next = RootObject;
+        RootObject = NurseryObject;
+        NurseryObject = NULL;
+        NurserySize = 0;
+    }
 
-    grayElapsed = Clock::GetTicks() - grayElapsed;
-
-    double blackenElapsed = Clock::GetTicks();
+    ScriptManager::PruneInternedStrings();
 
-    // Traverse references
-    for (size_t i = 0; i < GrayList.size(); i++) {
-        BlackenObject(GrayList[i]);
-    }
+    // Nothing is young any more, and some of these may be freed
+    for (size_t i = 0; i < RememberedSet.size(); i++)
+        RememberedSet[i]->IsRemembered = false;
+    RememberedSet.clear();
 
-    blackenElapsed = Clock::GetTicks() - blackenElapsed;
+    // Everything allocated from here on goes into the nursery, so
+    // objects created between slices are never mistaken for garbage.
+    SweepList = RootObject;
+    SweepCursor = &SweepList;
+    RootObject = NULL;
 
-    double freeElapsed = Clock::GetTicks();
+    memset(ObjectTypeFreed, 0, sizeof ObjectTypeFreed);
+    memset(ObjectTypeCounts, 0, sizeof ObjectTypeCounts);
 
-    int objectTypeFreed[MAX_OBJ_TYPE] = { 0 };
-    int objectTypeCounts[MAX_OBJ_TYPE] = { 0 };
+    State = STATE_SWEEP;
+}
+PRIVATE STATIC bool GarbageCollector::SweepObjects(double deadline) {
+    Uint32 work = 0;
+    while (*SweepCursor != NULL) {
+        Obj* object = *SweepCursor;
 
-    // Collect the white objects
-    Obj** object = &GarbageCollector::RootObject;
-    while (*object != NULL) {
-        objectTypeCounts[(*object)->Type]++;
+        ObjectTypeCounts[object->Type]++;
 
-        if (!((*object)->IsDark)) {
-            objectTypeFreed[(*object)->Type]++;
+        if (!object->IsDark) {
+            ObjectTypeFreed[object->Type]++;
 
             // This object wasn't reached, so remove it from the list and
             // free it.
-            Obj* unreached = *object;
-            *object = unreached->Next;
+            *SweepCursor = object->Next;
 
-            GarbageCollector::FreeValue(OBJECT_VAL(unreached));
+            GarbageCollector::FreeValue(OBJECT_VAL(object));
         }
         else {
             // This object was reached, so unmark it (for the next GC) and
             // move on to the next.
-            (*object)->IsDark = false;
-            object = &(*object)->Next;
+            object->IsDark = false;
+            SweepCursor = &object->Next;
         }
-    }
-
-    freeElapsed = Clock::GetTicks() - freeElapsed;
 
-    Log::Print(Log::LOG_VERBOSE, "Sweep: Graying took %.1f ms", grayElapsed);
-    Log::Print(Log::LOG_VERBOSE, "Sweep: Blackening took %.1f ms", blackenElapsed);
-    Log::Print(Log::LOG_VERBOSE, "Sweep: Freeing took %.1f ms", freeElapsed);
+        if (deadline != GC_NO_DEADLINE
+            && ++work % GC_WORK_PER_CHECK == 0
+            && Clock::GetTicks() >= deadline)
+            return false;
+    }
 
+    // Put the survivors back in front of anything allocated meanwhile
+    *SweepCursor = RootObject;
+    RootObject = SweepList;
+    SweepList = NULL;
+    SweepCursor = NULL;
+    return true;
+}
+PRIVATE STATIC void GarbageCollector::FinishCycle() {
     for (size_t i = 0; i < MAX_OBJ_TYPE; i++) {
-        if (objectTypeCounts[i])
-            Log::Print(Log::LOG_VERBOSE, "Freed %d %s objects out of %d.", objectTypeFreed[i], GetObjectTypeString(i), objectTypeCounts[i]);
+        if (ObjectTypeCounts[i])
+            Log::Print(Log::LOG_VERBOSE, "Freed %d %s objects out of %d.", ObjectTypeFreed[i], GetObjectTypeString(i), ObjectTypeCounts[i]);
     }
 
     GarbageCollector::NextGC = GarbageCollector::GarbageSize + (1024 * 1024);
+    GarbageCollector::State = STATE_IDLE;
+    GarbageCollector::CycleCount++;
+}
+PRIVATE STATIC void GarbageCollector::RecordPause(double elapsed) {
+    LastPause = elapsed;
+    if (MaxPause < elapsed)
+        MaxPause = elapsed;
+    TotalPause += elapsed;
+    SliceCount++;
 }
 
 PRIVATE STATIC void GarbageCollector::FreeValue(VMValue value) {
@@ -181,8 +455,10 @@ PRIVATE STATIC void GarbageCollector::GrayObject(void* obj) {
 
     Obj* object = (Obj*)obj;
     if (object->IsDark) return;
+    if (CollectingYoung && object->IsOld) return;
 
     object->IsDark = true;
+    object->IsGray = true;
 
     GrayList.push_back(object);
 }
@@ -195,6 +471,8 @@ PRIVATE STATIC void GarbageCollector::GrayHashMap(void* pointer) {
 }
 
 PRIVATE STATIC void GarbageCollector::BlackenObject(Obj* object) {
+    object->IsGray = false;
+
     GrayObject(object->Class);
 
     switch (object->Type) {
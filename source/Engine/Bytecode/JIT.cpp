@@ -0,0 +1,596 @@
+#if INTERFACE
+#include <Engine/Bytecode/Types.h>
+#include <Engine/Bytecode/VMThread.h>
+
+class JIT {
+public:
+    enum {
+        // Calls plus loop iterations before a function gets compiled
+        HOT_THRESHOLD = 500
+    };
+
+    static bool   Enabled;
+    static Uint32 CompiledCount;
+    static size_t CodeBytes;
+};
+#endif
+
+#include <Engine/Bytecode/JIT.h>
+#include <Engine/Bytecode/Bytecode.h>
+#include <Engine/Bytecode/ScriptManager.h>
+#include <Engine/Diagnostics/Log.h>
+#include <Engine/Diagnostics/Memory.h>
+
+#ifdef USING_VM_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/*
+
+Baseline JIT
+
+Compiled code is a straight translation of the bytecode, one template per
+instruction. It keeps the thread in rbx, the frame in r12, the stack top
+in r13 and the frame's slots in r14, so locals, constants, jumps and the
+quickened integer and decimal operations never touch the interpreter.
+
+Anything else, and any quickened operation whose operands turn out to
+have the wrong type, is run by the interpreter one instruction at a time.
+If that instruction changes the call stack or fails, the compiled code
+returns, and RunInstructionSet picks up from whatever frame is on top.
+It can be entered again at any instruction through the Targets table,
+which is also how it gets back in after a call returns.
+
+*/
+
+struct JITCode {
+    Uint8*  Code;
+    size_t  Size;
+    // Native address of every bytecode offset, or ExitStub for offsets
+    // that aren't the start of an instruction
+    void**  Targets;
+    void*   ExitStub;
+    // Most the compiled code can push before it checks the stack again
+    Uint32  PushBound;
+};
+
+typedef int (*JITEntry)(VMThread* thread, CallFrame* frame, void* target);
+
+bool   JIT::Enabled = true;
+Uint32 JIT::CompiledCount = 0;
+size_t JIT::CodeBytes = 0;
+
+#ifdef USING_VM_JIT
+
+enum {
+    RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RSI = 6, RDI = 7,
+    R12 = 12, R13 = 13, R14 = 14, R15 = 15
+};
+
+#define VALUE_SIZE ((Sint32)sizeof(VMValue))
+#ifdef USING_COMPACT_VALUES
+    #define PAYLOAD_OFFSET 0
+#else
+    #define PAYLOAD_OFFSET ((Sint32)offsetof(VMValue, as))
+#endif
+
+#define THREAD_STACK_TOP ((Sint32)offsetof(VMThread, StackTop))
+#define THREAD_REGISTER  ((Sint32)offsetof(VMThread, RegisterValue))
+#define FRAME_IP         ((Sint32)offsetof(CallFrame, IP))
+#define FRAME_SLOTS      ((Sint32)offsetof(CallFrame, Slots))
+
+struct Assembler {
+    vector<Uint8> Code;
+
+    int  Size() { return (int)Code.size(); }
+    void Byte(Uint8 value) { Code.push_back(value); }
+    void Int16(Uint16 value) { Byte(value & 0xFF); Byte(value >> 8); }
+    void Int32(Uint32 value) {
+        for (int i = 0; i < 4; i++)
+            Byte((value >> (i * 8)) & 0xFF);
+    }
+    void Int64(Uint64 value) {
+        for (int i = 0; i < 8; i++)
+            Byte((value >> (i * 8)) & 0xFF);
+    }
+    void Patch32(int at, Sint32 value) {
+        memcpy(&Code[at], &value, sizeof(Sint32));
+    }
+
+    // [base + disp]. A displacement is always encoded, so r13 needs no
+    // special casing, and rsp/r12 get their SIB byte.
+    void Op(Uint8 prefix, bool wide, Uint32 opcode, int reg, int base, Sint32 disp) {
+        if (prefix)
+            Byte(prefix);
+        Uint8 rex = 0x40 | (wide << 3) | (((reg >> 3) & 1) << 2) | ((base >> 3) & 1);
+        if (rex != 0x40)
+            Byte(rex);
+        if (opcode > 0xFF)
+            Byte(opcode >> 8);
+        Byte(opcode & 0xFF);
+
+        bool short_ = disp >= -128 && disp <= 127;
+        Byte(((short_ ? 1 : 2) << 6) | ((reg & 7) << 3) | (base & 7));
+        if ((base & 7) == RSP)
+            Byte(0x24);
+        if (short_)
+            Byte((Uint8)disp);
+        else
+            Int32((Uint32)disp);
+    }
+
+    void Push(int reg) {
+        if (reg >= 8)
+            Byte(0x41);
+        Byte(0x50 + (reg & 7));
+    }
+    void Pop(int reg) {
+        if (reg >= 8)
+            Byte(0x41);
+        Byte(0x58 + (reg & 7));
+    }
+    void MovRR(int dst, int src) {
+        Byte(0x48 | (((src >> 3) & 1) << 2) | ((dst >> 3) & 1));
+        Byte(0x89);
+        Byte(0xC0 | ((src & 7) << 3) | (dst & 7));
+    }
+    void MovImm64(int reg, Uint64 value) {
+        Byte(0x48 | ((reg >> 3) & 1));
+        Byte(0xB8 + (reg & 7));
+        Int64(value);
+    }
+    void AddImm(int reg, Sint32 value) {
+        Byte(0x48 | ((reg >> 3) & 1));
+        Byte(0x81);
+        Byte(0xC0 | (reg & 7));
+        Int32((Uint32)value);
+    }
+    void Load64(int reg, int base, Sint32 disp)  { Op(0, true, 0x8B, reg, base, disp); }
+    void Store64(int base, Sint32 disp, int reg) { Op(0, true, 0x89, reg, base, disp); }
+    void Load32(int reg, int base, Sint32 disp)  { Op(0, false, 0x8B, reg, base, disp); }
+    void Store32(int base, Sint32 disp, int reg) { Op(0, false, 0x89, reg, base, disp); }
+    void StoreImm32(int base, Sint32 disp, Uint32 value) {
+        Op(0, false, 0xC7, 0, base, disp);
+        Int32(value);
+    }
+    void CmpImm32(int base, Sint32 disp, Uint32 value) {
+        Op(0, false, 0x81, 7, base, disp);
+        Int32(value);
+    }
+    void CmpImm16(int base, Sint32 disp, Uint16 value) {
+        Op(0x66, false, 0x81, 7, base, disp);
+        Int16(value);
+    }
+    void Call(void* function) {
+        MovImm64(RAX, (Uint64)(uintptr_t)function);
+        Byte(0xFF); Byte(0xD0); // call rax
+    }
+    // Returns where the rel32 goes, to be patched later
+    int  Jump() {
+        Byte(0xE9);
+        Int32(0);
+        return Size() - 4;
+    }
+    int  JumpIf(Uint8 condition) {
+        Byte(0x0F); Byte(0x80 | condition);
+        Int32(0);
+        return Size() - 4;
+    }
+    void Bind(int rel32) {
+        Patch32(rel32, Size() - (rel32 + 4));
+    }
+    void BindTo(int rel32, int target) {
+        Patch32(rel32, target - (rel32 + 4));
+    }
+};
+
+// Condition codes
+enum {
+    CC_E = 0x4, CC_NE = 0x5, CC_S = 0x8,
+    CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF,
+    CC_AE = 0x3, CC_A = 0x7
+};
+
+// Runs the instruction at frame->IP in the interpreter. Returns the
+// offset to carry on from, or -1 to leave the compiled code with *status.
+static int StepInstruction(VMThread* thread, CallFrame* frame, int* status) {
+    Uint32 frameCount = thread->FrameCount;
+    int result = thread->RunInstruction();
+    if (result != INTERPRET_OK || thread->FrameCount != frameCount) {
+        *status = result;
+        return -1;
+    }
+
+    // Let the interpreter's checks handle a nearly full stack
+    if (thread->StackTop + frame->Function->Compiled->PushBound > thread->Stack + STACK_SIZE_MAX) {
+        *status = INTERPRET_OK;
+        return -1;
+    }
+
+    return (int)(frame->IP - frame->IPStart);
+}
+
+static void EmitCopyValue(Assembler& a, int dstBase, Sint32 dst, int srcBase, Sint32 src) {
+#ifdef USING_COMPACT_VALUES
+    a.Load64(RAX, srcBase, src);
+    a.Store64(dstBase, dst, RAX);
+#else
+    a.Op(0, false, 0x0F10, 0, srcBase, src); // movups xmm0, [src]
+    a.Op(0, false, 0x0F11, 0, dstBase, dst); // movups [dst], xmm0
+#endif
+}
+static void EmitPushConstant(Assembler& a, VMValue value) {
+    Uint64 words[2] = { 0, 0 };
+    memcpy(words, &value, sizeof(VMValue));
+    for (Sint32 i = 0; i < VALUE_SIZE / 8; i++) {
+        a.MovImm64(RAX, words[i]);
+        a.Store64(R13, i * 8, RAX);
+    }
+    a.AddImm(R13, VALUE_SIZE);
+}
+// Jumps to the returned rel32 if the value at [r13 + disp] isn't of the given type
+static int  EmitTypeCheck(Assembler& a, Sint32 disp, Uint32 type) {
+#ifdef USING_COMPACT_VALUES
+    a.CmpImm16(R13, disp + 6, (Uint16)type);
+#else
+    a.CmpImm32(R13, disp + (Sint32)offsetof(VMValue, Type), type);
+#endif
+    return a.JumpIf(CC_NE);
+}
+// Stores eax (or xmm0 for decimals) as the value at [r13 + disp]. The type
+// is only written if it changed.
+static void EmitStoreResult(Assembler& a, Sint32 disp, Uint32 type, bool typeChanged) {
+#ifdef USING_COMPACT_VALUES
+    if (type == VAL_DECIMAL) {
+        a.Byte(0x66); a.Byte(0x0F); a.Byte(0x7E); a.Byte(0xC0); // movd eax, xmm0
+    }
+    // mov eax, eax clears the top half, then the type goes on top
+    a.Byte(0x89); a.Byte(0xC0);
+    a.MovImm64(RCX, (Uint64)type << VALUE_TYPE_SHIFT);
+    a.Byte(0x48); a.Byte(0x09); a.Byte(0xC8); // or rax, rcx
+    a.Store64(R13, disp, RAX);
+#else
+    if (type == VAL_DECIMAL)
+        a.Op(0xF3, false, 0x0F11, 0, R13, disp + PAYLOAD_OFFSET); // movss [mem], xmm0
+    else
+        a.Store32(R13, disp + PAYLOAD_OFFSET, RAX);
+    if (typeChanged)
+        a.StoreImm32(R13, disp + (Sint32)offsetof(VMValue, Type), type);
+#endif
+}
+static void EmitSetFlag(Assembler& a, Uint8 condition) {
+    a.Byte(0x0F); a.Byte(0x90 | condition); a.Byte(0xC0); // setcc al
+    a.Byte(0x0F); a.Byte(0xB6); a.Byte(0xC0);             // movzx eax, al
+}
+
+static bool Translate(ObjFunction* function, JITCode* jit, Assembler& a, vector<int>& nativeOffsets) {
+    Chunk* chunk = &function->Chunk;
+
+    // Jumps to bytecode offsets, patched once everything is emitted
+    vector<std::pair<int, int>> jumps;
+    int resume, leave, exitStub;
+
+    // Entry: (thread, frame, target)
+    a.Push(RBX); a.Push(R12); a.Push(R13); a.Push(R14); a.Push(R15);
+    // Keeps the stack aligned, and [rsp] holds the status to return
+    a.AddImm(RSP, -16);
+    a.MovRR(RBX, RDI);
+    a.MovRR(R12, RSI);
+    a.Load64(R13, RBX, THREAD_STACK_TOP);
+    a.Load64(R14, R12, FRAME_SLOTS);
+    a.Byte(0xFF); a.Byte(0xE2); // jmp rdx
+
+    // Leave with the status in [rsp]
+    leave = a.Size();
+    a.Load32(RAX, RSP, 0);
+    a.Store64(RBX, THREAD_STACK_TOP, R13);
+    a.AddImm(RSP, 16);
+    a.Pop(R15); a.Pop(R14); a.Pop(R13); a.Pop(R12); a.Pop(RBX);
+    a.Byte(0xC3); // ret
+
+    // Carry on from the offset in eax, or leave if it's negative
+    resume = a.Size();
+    a.Byte(0x85); a.Byte(0xC0); // test eax, eax
+    a.BindTo(a.JumpIf(CC_S), leave);
+    a.MovImm64(RCX, (Uint64)(uintptr_t)jit->Targets);
+    a.Byte(0xFF); a.Byte(0x24); a.Byte(0xC1); // jmp [rcx + rax * 8]
+
+    exitStub = a.Size();
+    a.StoreImm32(RSP, 0, INTERPRET_OK);
+    a.BindTo(a.Jump(), leave);
+
+    Uint32 pushBound = 0;
+    for (int offset = 0; offset < chunk->Count;) {
+        Uint8* code = chunk->Code + offset;
+        int length = Bytecode::GetInstructionLength(code);
+        // Inline jump tables can't be walked
+        if (length == 0 || offset + length > chunk->Count)
+            return false;
+
+        int next = offset + length;
+        int slow = -1;
+        int done = -1;
+        vector<int> fails;
+
+        nativeOffsets[offset] = a.Size();
+
+        #define TOP(n) (-(n) * VALUE_SIZE)
+
+        switch (*code) {
+            case OP_GET_LOCAL:
+                EmitCopyValue(a, R13, 0, R14, code[1] * VALUE_SIZE);
+                a.AddImm(R13, VALUE_SIZE);
+                pushBound++;
+                break;
+            case OP_SET_LOCAL:
+                EmitCopyValue(a, R14, code[1] * VALUE_SIZE, R13, TOP(1));
+                break;
+            case OP_CONSTANT: {
+                Uint32 index;
+                memcpy(&index, code + 1, sizeof(Uint32));
+                if (index >= chunk->Constants->size())
+                    return false;
+                EmitPushConstant(a, (*chunk->Constants)[index]);
+                pushBound++;
+                break;
+            }
+            case OP_NULL:
+                EmitPushConstant(a, NULL_VAL);
+                pushBound++;
+                break;
+            case OP_TRUE:
+                EmitPushConstant(a, INTEGER_VAL(1));
+                pushBound++;
+                break;
+            case OP_FALSE:
+                EmitPushConstant(a, INTEGER_VAL(0));
+                pushBound++;
+                break;
+            case OP_POP:
+                a.AddImm(R13, TOP(1));
+                break;
+            case OP_POPN:
+                a.AddImm(R13, TOP(code[1]));
+                break;
+            case OP_COPY:
+                for (int i = 0; i < code[1]; i++) {
+                    EmitCopyValue(a, R13, 0, R13, TOP(code[1]));
+                    a.AddImm(R13, VALUE_SIZE);
+                }
+                pushBound += code[1];
+                break;
+            case OP_SAVE_VALUE:
+                EmitCopyValue(a, RBX, THREAD_REGISTER, R13, TOP(1));
+                a.AddImm(R13, TOP(1));
+                break;
+            case OP_LOAD_VALUE:
+                EmitCopyValue(a, R13, 0, RBX, THREAD_REGISTER);
+                a.AddImm(R13, VALUE_SIZE);
+                pushBound++;
+                break;
+
+            case OP_JUMP:
+            case OP_JUMP_BACK: {
+                Sint16 jump;
+                memcpy(&jump, code + 1, sizeof(Sint16));
+                jumps.push_back(std::make_pair(a.Jump(), *code == OP_JUMP ? next + jump : next - jump));
+                break;
+            }
+            case OP_JUMP_IF_FALSE: {
+                // Only integers are checked here, anything else is stepped.
+                Sint16 jump;
+                memcpy(&jump, code + 1, sizeof(Sint16));
+                fails.push_back(EmitTypeCheck(a, TOP(1), VAL_INTEGER));
+                a.CmpImm32(R13, TOP(1) + PAYLOAD_OFFSET, 0);
+                jumps.push_back(std::make_pair(a.JumpIf(CC_E), next + jump));
+                slow = 1;
+                break;
+            }
+
+            case OP_ADD_INTEGER:
+            case OP_SUBTRACT_INTEGER:
+            case OP_MULTIPLY_INTEGER:
+            case OP_LESS_INTEGER:
+            case OP_GREATER_INTEGER:
+            case OP_LESS_EQUAL_INTEGER:
+            case OP_GREATER_EQUAL_INTEGER:
+                fails.push_back(EmitTypeCheck(a, TOP(2), VAL_INTEGER));
+                fails.push_back(EmitTypeCheck(a, TOP(1), VAL_INTEGER));
+                a.Load32(RAX, R13, TOP(2) + PAYLOAD_OFFSET);
+                switch (*code) {
+                    case OP_ADD_INTEGER:      a.Op(0, false, 0x03, RAX, R13, TOP(1) + PAYLOAD_OFFSET); break;
+                    case OP_SUBTRACT_INTEGER: a.Op(0, false, 0x2B, RAX, R13, TOP(1) + PAYLOAD_OFFSET); break;
+                    case OP_MULTIPLY_INTEGER: a.Op(0, false, 0x0FAF, RAX, R13, TOP(1) + PAYLOAD_OFFSET); break;
+                    default:
+                        a.Op(0, false, 0x3B, RAX, R13, TOP(1) + PAYLOAD_OFFSET); // cmp eax, b
+                        switch (*code) {
+                            case OP_LESS_INTEGER:          EmitSetFlag(a, CC_L); break;
+                            case OP_GREATER_INTEGER:       EmitSetFlag(a, CC_G); break;
+                            case OP_LESS_EQUAL_INTEGER:    EmitSetFlag(a, CC_LE); break;
+                            case OP_GREATER_EQUAL_INTEGER: EmitSetFlag(a, CC_GE); break;
+                        }
+                        break;
+                }
+                a.AddImm(R13, TOP(1));
+                EmitStoreResult(a, TOP(1), VAL_INTEGER, false);
+                slow = 1;
+                break;
+
+            case OP_ADD_DECIMAL:
+            case OP_SUBTRACT_DECIMAL:
+            case OP_MULTIPLY_DECIMAL:
+                fails.push_back(EmitTypeCheck(a, TOP(2), VAL_DECIMAL));
+                fails.push_back(EmitTypeCheck(a, TOP(1), VAL_DECIMAL));
+                a.Op(0xF3, false, 0x0F10, 0, R13, TOP(2) + PAYLOAD_OFFSET); // movss xmm0, a
+                switch (*code) {
+                    case OP_ADD_DECIMAL:      a.Op(0xF3, false, 0x0F58, 0, R13, TOP(1) + PAYLOAD_OFFSET); break;
+                    case OP_SUBTRACT_DECIMAL: a.Op(0xF3, false, 0x0F5C, 0, R13, TOP(1) + PAYLOAD_OFFSET); break;
+                    case OP_MULTIPLY_DECIMAL: a.Op(0xF3, false, 0x0F59, 0, R13, TOP(1) + PAYLOAD_OFFSET); break;
+                }
+                a.AddImm(R13, TOP(1));
+                EmitStoreResult(a, TOP(1), VAL_DECIMAL, false);
+                slow = 1;
+                break;
+
+            case OP_LESS_DECIMAL:
+            case OP_GREATER_DECIMAL:
+            case OP_LESS_EQUAL_DECIMAL:
+            case OP_GREATER_EQUAL_DECIMAL: {
+                fails.push_back(EmitTypeCheck(a, TOP(2), VAL_DECIMAL));
+                fails.push_back(EmitTypeCheck(a, TOP(1), VAL_DECIMAL));
+                // a < b is tested as b > a, so that NaN compares false
+                // like it does in C.
+                bool swap = *code == OP_LESS_DECIMAL || *code == OP_LESS_EQUAL_DECIMAL;
+                bool orEqual = *code == OP_LESS_EQUAL_DECIMAL || *code == OP_GREATER_EQUAL_DECIMAL;
+                a.Op(0xF3, false, 0x0F10, 0, R13, (swap ? TOP(1) : TOP(2)) + PAYLOAD_OFFSET);
+                a.Op(0, false, 0x0F2E, 0, R13, (swap ? TOP(2) : TOP(1)) + PAYLOAD_OFFSET); // ucomiss
+                EmitSetFlag(a, orEqual ? CC_AE : CC_A);
+                a.AddImm(R13, TOP(1));
+                EmitStoreResult(a, TOP(1), VAL_INTEGER, true);
+                slow = 1;
+                break;
+            }
+
+            default:
+                slow = 0;
+                break;
+        }
+
+        #undef TOP
+
+        if (slow >= 0) {
+            if (slow) {
+                done = a.Jump();
+                for (size_t i = 0; i < fails.size(); i++)
+                    a.Bind(fails[i]);
+            }
+
+            a.Store64(RBX, THREAD_STACK_TOP, R13);
+            a.MovImm64(RAX, (Uint64)(uintptr_t)code);
+            a.Store64(R12, FRAME_IP, RAX);
+            a.MovRR(RDI, RBX);
+            a.MovRR(RSI, R12);
+            a.MovRR(RDX, RSP);
+            a.Call((void*)StepInstruction);
+            a.Load64(R13, RBX, THREAD_STACK_TOP);
+            a.Byte(0x3D); a.Int32((Uint32)next); // cmp eax, next
+            a.BindTo(a.JumpIf(CC_NE), resume);
+
+            if (done >= 0)
+                a.Bind(done);
+        }
+
+        offset = next;
+    }
+
+    // Falling off the end leaves it to the interpreter
+    nativeOffsets[chunk->Count] = a.Size();
+    a.BindTo(a.Jump(), exitStub);
+
+    for (size_t i = 0; i < jumps.size(); i++) {
+        int target = jumps[i].second;
+        if (target < 0 || target > chunk->Count || nativeOffsets[target] < 0)
+            return false;
+        a.BindTo(jumps[i].first, nativeOffsets[target]);
+    }
+
+    nativeOffsets.push_back(exitStub);
+    jit->PushBound = pushBound;
+    return true;
+}
+#endif
+
+PUBLIC STATIC void JIT::Compile(ObjFunction* function) {
+#ifdef USING_VM_JIT
+    if (!Enabled || function->Compiled || !function->Chunk.Code || function->EncodedChunk)
+        return;
+    if (!ScriptManager::Lock())
+        return;
+    // Another thread may have got here first
+    if (function->Compiled) {
+        ScriptManager::Unlock();
+        return;
+    }
+
+    Chunk* chunk = &function->Chunk;
+
+    JITCode* jit = (JITCode*)Memory::TrackedCalloc("JIT::Targets", 1, sizeof(JITCode));
+    jit->Targets = (void**)Memory::TrackedCalloc("JIT::Targets", chunk->Count + 1, sizeof(void*));
+
+    Assembler a;
+    vector<int> nativeOffsets(chunk->Count + 1, -1);
+    if (!Translate(function, jit, a, nativeOffsets)) {
+        Memory::Free(jit->Targets);
+        Memory::Free(jit);
+        ScriptManager::Unlock();
+        return;
+    }
+
+    // Write it out, then make it executable
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = (a.Code.size() + pageSize - 1) & ~(pageSize - 1);
+    void* memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        Log::Print(Log::LOG_WARN, "Could not allocate memory for compiled code!");
+        Memory::Free(jit->Targets);
+        Memory::Free(jit);
+        ScriptManager::Unlock();
+        return;
+    }
+    memcpy(memory, a.Code.data(), a.Code.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        Log::Print(Log::LOG_WARN, "Could not make compiled code executable!");
+        munmap(memory, size);
+        Memory::Free(jit->Targets);
+        Memory::Free(jit);
+        ScriptManager::Unlock();
+        return;
+    }
+
+    jit->Code = (Uint8*)memory;
+    jit->Size = size;
+    jit->ExitStub = jit->Code + nativeOffsets.back();
+    for (int i = 0; i <= chunk->Count; i++)
+        jit->Targets[i] = nativeOffsets[i] >= 0 ? jit->Code + nativeOffsets[i] : jit->ExitStub;
+
+    function->Compiled = jit;
+
+    CompiledCount++;
+    CodeBytes += size;
+
+    ScriptManager::Unlock();
+#endif
+}
+
+// Runs the frame's function from its current instruction until it calls,
+// returns or fails.
+PUBLIC STATIC int  JIT::Run(VMThread* thread, CallFrame* frame) {
+#ifdef USING_VM_JIT
+    JITCode* jit = frame->Function->Compiled;
+    void* target = jit->Targets[frame->IP - frame->IPStart];
+    if (target == jit->ExitStub
+        || thread->StackTop + jit->PushBound > thread->Stack + STACK_SIZE_MAX)
+        return thread->RunInstruction();
+
+    return ((JITEntry)jit->Code)(thread, frame, target);
+#else
+    return thread->RunInstruction();
+#endif
+}
+
+PUBLIC STATIC void JIT::Free(ObjFunction* function) {
+#ifdef USING_VM_JIT
+    JITCode* jit = function->Compiled;
+    if (!jit)
+        return;
+
+    CompiledCount--;
+    CodeBytes -= jit->Size;
+
+    munmap(jit->Code, jit->Size);
+    Memory::Free(jit->Targets);
+    Memory::Free(jit);
+    function->Compiled = NULL;
+#endif
+}
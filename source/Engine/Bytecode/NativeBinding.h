@@ -0,0 +1,144 @@
+#ifndef ENGINE_BYTECODE_NATIVEBINDING_H
+#define ENGINE_BYTECODE_NATIVEBINDING_H
+
+#include <Engine/Bytecode/Types.h>
+#include <Engine/Bytecode/StandardLibrary.h>
+
+// Typed natives
+//
+// A native written as a plain C++ function, like
+//
+//     float Math_Sin(float x);
+//
+// is turned into a NativeFn by BIND_NATIVE(Math_Sin). The argument count
+// is checked once, and each argument is converted inline for the type the
+// parameter has, falling back to StandardLibrary's getters (and their
+// error messages) for anything unusual.
+
+// #region Arguments
+template <typename T> struct NativeArg;
+
+template <> struct NativeArg<int> {
+    static inline int Get(VMValue* args, int index, Uint32 threadID) {
+        if (VALUE_TYPE(args[index]) == VAL_INTEGER)
+            return AS_INTEGER(args[index]);
+        return StandardLibrary::GetInteger(args, index, threadID);
+    }
+};
+template <> struct NativeArg<bool> {
+    static inline bool Get(VMValue* args, int index, Uint32 threadID) {
+        return !!NativeArg<int>::Get(args, index, threadID);
+    }
+};
+template <> struct NativeArg<float> {
+    static inline float Get(VMValue* args, int index, Uint32 threadID) {
+        if (VALUE_TYPE(args[index]) == VAL_DECIMAL)
+            return AS_DECIMAL(args[index]);
+        if (VALUE_TYPE(args[index]) == VAL_INTEGER)
+            return (float)AS_INTEGER(args[index]);
+        return StandardLibrary::GetDecimal(args, index, threadID);
+    }
+};
+template <> struct NativeArg<VMValue> {
+    static inline VMValue Get(VMValue* args, int index, Uint32 threadID) {
+        return args[index];
+    }
+};
+// #endregion
+
+// #region Return values
+template <typename T> struct NativeReturn;
+
+template <> struct NativeReturn<int> {
+    static inline VMValue Wrap(int value) { return INTEGER_VAL(value); }
+};
+template <> struct NativeReturn<bool> {
+    static inline VMValue Wrap(bool value) { return INTEGER_VAL(value ? 1 : 0); }
+};
+template <> struct NativeReturn<float> {
+    static inline VMValue Wrap(float value) { return DECIMAL_VAL(value); }
+};
+template <> struct NativeReturn<VMValue> {
+    static inline VMValue Wrap(VMValue value) { return value; }
+};
+// #endregion
+
+// #region Binding
+template <int... I> struct NativeIndices { };
+
+template <int N, int... I>
+struct MakeNativeIndices : MakeNativeIndices<N - 1, N - 1, I...> { };
+template <int... I>
+struct MakeNativeIndices<0, I...> {
+    typedef NativeIndices<I...> Type;
+};
+
+template <typename Signature, Signature Function> struct NativeBinding;
+
+template <typename R, typename... Args, R (*Function)(Args...)>
+struct NativeBinding<R (*)(Args...), Function> {
+    template <int... I>
+    static inline VMValue Invoke(VMValue* args, Uint32 threadID, NativeIndices<I...>) {
+        // Unused when the function takes no arguments
+        (void)args; (void)threadID;
+        return NativeReturn<R>::Wrap(Function(NativeArg<Args>::Get(args, I, threadID)...));
+    }
+    static VMValue Call(int argCount, VMValue* args, Uint32 threadID) {
+        if (argCount != (int)sizeof...(Args))
+            return StandardLibrary::ArgCountError(sizeof...(Args), argCount, threadID);
+        return Invoke(args, threadID, typename MakeNativeIndices<sizeof...(Args)>::Type());
+    }
+};
+template <typename... Args, void (*Function)(Args...)>
+struct NativeBinding<void (*)(Args...), Function> {
+    template <int... I>
+    static inline void Invoke(VMValue* args, Uint32 threadID, NativeIndices<I...>) {
+        (void)args; (void)threadID;
+        Function(NativeArg<Args>::Get(args, I, threadID)...);
+    }
+    static VMValue Call(int argCount, VMValue* args, Uint32 threadID) {
+        if (argCount != (int)sizeof...(Args))
+            return StandardLibrary::ArgCountError(sizeof...(Args), argCount, threadID);
+        Invoke(args, threadID, typename MakeNativeIndices<sizeof...(Args)>::Type());
+        return NULL_VAL;
+    }
+};
+
+#define BIND_NATIVE(function) (&NativeBinding<decltype(&function), &function>::Call)
+// #endregion
+
+// #region Name hashing
+// Murmur::EncryptString, evaluated at compile time, so static NativeDef
+// tables need no hashing at startup.
+#define NATIVE_HASH_M 0x5BD1E995U
+
+constexpr Uint32 NativeHashBlock(const char* s, size_t i) {
+    return (Uint32)(Uint8)s[i]
+        | ((Uint32)(Uint8)s[i + 1] << 8)
+        | ((Uint32)(Uint8)s[i + 2] << 16)
+        | ((Uint32)(Uint8)s[i + 3] << 24);
+}
+constexpr Uint32 NativeHashMixBlock(Uint32 k) {
+    return ((k * NATIVE_HASH_M) ^ ((k * NATIVE_HASH_M) >> 24)) * NATIVE_HASH_M;
+}
+constexpr Uint32 NativeHashFinish(Uint32 h) {
+    return ((h ^ (h >> 13)) * NATIVE_HASH_M) ^ (((h ^ (h >> 13)) * NATIVE_HASH_M) >> 15);
+}
+constexpr Uint32 NativeHashTail(const char* s, size_t i, size_t left, Uint32 h) {
+    return left == 3 ? (h ^ ((Uint32)(Uint8)s[i + 2] << 16) ^ ((Uint32)(Uint8)s[i + 1] << 8) ^ (Uint8)s[i]) * NATIVE_HASH_M
+        : left == 2 ? (h ^ ((Uint32)(Uint8)s[i + 1] << 8) ^ (Uint8)s[i]) * NATIVE_HASH_M
+        : left == 1 ? (h ^ (Uint8)s[i]) * NATIVE_HASH_M
+        : h;
+}
+constexpr Uint32 NativeHashBody(const char* s, size_t i, size_t size, Uint32 h) {
+    return size - i >= 4
+        ? NativeHashBody(s, i + 4, size, (h * NATIVE_HASH_M) ^ NativeHashMixBlock(NativeHashBlock(s, i)))
+        : NativeHashFinish(NativeHashTail(s, i, size - i, h));
+}
+template <size_t N>
+constexpr Uint32 NativeHash(const char (&name)[N]) {
+    return NativeHashBody(name, 0, N - 1, 0xDEADBEEF ^ (Uint32)(N - 1));
+}
+// #endregion
+
+#endif /* ENGINE_BYTECODE_NATIVEBINDING_H */
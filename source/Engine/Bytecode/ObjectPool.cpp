@@ -0,0 +1,122 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+#include <Engine/Bytecode/Types.h>
+
+class ObjectPool {
+public:
+    enum {
+        GRANULARITY = 16,
+        MAX_SIZE = 256,
+        CLASS_COUNT = MAX_SIZE / GRANULARITY,
+        SLAB_SIZE = 0x10000
+    };
+
+    static void*         FreeLists[CLASS_COUNT];
+    static Uint32        SlotCounts[CLASS_COUNT];
+    static Uint32        UsedCounts[CLASS_COUNT];
+    static vector<void*> Slabs;
+
+    static Uint32        TypeCounts[MAX_OBJ_TYPE];
+    static size_t        TypeBytes[MAX_OBJ_TYPE];
+};
+#endif
+
+#include <Engine/Bytecode/ObjectPool.h>
+
+#include <Engine/Diagnostics/Log.h>
+#include <Engine/Diagnostics/Memory.h>
+
+void*         ObjectPool::FreeLists[ObjectPool::CLASS_COUNT];
+Uint32        ObjectPool::SlotCounts[ObjectPool::CLASS_COUNT];
+Uint32        ObjectPool::UsedCounts[ObjectPool::CLASS_COUNT];
+vector<void*> ObjectPool::Slabs;
+
+Uint32        ObjectPool::TypeCounts[MAX_OBJ_TYPE];
+size_t        ObjectPool::TypeBytes[MAX_OBJ_TYPE];
+
+PUBLIC STATIC void* ObjectPool::Alloc(size_t size, Uint8 type) {
+    TypeCounts[type]++;
+    TypeBytes[type] += size;
+
+    // Anything bigger than the largest size class just goes to the heap
+    if (size > MAX_SIZE)
+        return Memory::TrackedMalloc("ObjectPool::Alloc", size);
+
+    int sizeClass = GetSizeClass(size);
+    if (!FreeLists[sizeClass] && !AddSlab(sizeClass))
+        return NULL;
+
+    void* slot = FreeLists[sizeClass];
+    FreeLists[sizeClass] = *(void**)slot;
+    UsedCounts[sizeClass]++;
+    return slot;
+}
+PUBLIC STATIC void  ObjectPool::Free(void* pointer, size_t size) {
+    Uint8 type = ((Obj*)pointer)->Type;
+    TypeCounts[type]--;
+    TypeBytes[type] -= size;
+
+    if (size > MAX_SIZE) {
+        Memory::Free(pointer);
+        return;
+    }
+
+    int sizeClass = GetSizeClass(size);
+    *(void**)pointer = FreeLists[sizeClass];
+    FreeLists[sizeClass] = pointer;
+    UsedCounts[sizeClass]--;
+}
+
+PRIVATE STATIC int  ObjectPool::GetSizeClass(size_t size) {
+    return (int)((size + GRANULARITY - 1) / GRANULARITY) - 1;
+}
+PRIVATE STATIC bool ObjectPool::AddSlab(int sizeClass) {
+    char* slab = (char*)Memory::TrackedMalloc("ObjectPool::Slab", SLAB_SIZE);
+    if (!slab)
+        return false;
+
+    Slabs.push_back(slab);
+
+    // Thread the new slots onto the free list back to front, so they
+    // get handed out in address order.
+    size_t slotSize = (sizeClass + 1) * GRANULARITY;
+    Uint32 slotCount = SLAB_SIZE / slotSize;
+    for (Uint32 i = slotCount; i > 0; i--) {
+        void* slot = slab + (i - 1) * slotSize;
+        *(void**)slot = FreeLists[sizeClass];
+        FreeLists[sizeClass] = slot;
+    }
+    SlotCounts[sizeClass] += slotCount;
+    return true;
+}
+
+PUBLIC STATIC void  ObjectPool::PrintStatus() {
+    Log::Print(Log::LOG_IMPORTANT, "Object Pool: %u slabs (%u KiB)", (Uint32)Slabs.size(), (Uint32)(Slabs.size() * SLAB_SIZE / 1024));
+    for (int i = 0; i < CLASS_COUNT; i++) {
+        if (!SlotCounts[i])
+            continue;
+
+        Log::Print(Log::LOG_INFO, "%3d bytes: %6u / %6u slots used (%.1f%%)",
+            (i + 1) * GRANULARITY, UsedCounts[i], SlotCounts[i],
+            UsedCounts[i] * 100.0 / SlotCounts[i]);
+    }
+    for (int i = 0; i < MAX_OBJ_TYPE; i++) {
+        if (!TypeCounts[i])
+            continue;
+
+        Log::Print(Log::LOG_INFO, "%s: %u live (%u bytes)",
+            GetObjectTypeString(i), TypeCounts[i], (Uint32)TypeBytes[i]);
+    }
+}
+
+PUBLIC STATIC void  ObjectPool::Dispose() {
+    for (size_t i = 0; i < Slabs.size(); i++)
+        Memory::Free(Slabs[i]);
+    Slabs.clear();
+
+    memset(FreeLists, 0, sizeof(FreeLists));
+    memset(SlotCounts, 0, sizeof(SlotCounts));
+    memset(UsedCounts, 0, sizeof(UsedCounts));
+    memset(TypeCounts, 0, sizeof(TypeCounts));
+    memset(TypeBytes, 0, sizeof(TypeBytes));
+}
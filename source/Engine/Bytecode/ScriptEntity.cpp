@@ -5,6 +5,7 @@
 class ScriptEntity : public Entity {
 public:
     static bool DisableAutoAnimate;
+    static HashMap<NativeField>* NativeFields;
 
     ObjInstance* Instance = NULL;
     HashMap<VMValue>* Properties;
@@ -12,15 +13,39 @@ public:
 #endif
 
 #include <Engine/Bytecode/ScriptEntity.h>
+#include <Engine/Bytecode/GarbageCollector.h>
 #include <Engine/Bytecode/Compiler.h>
 #include <Engine/Bytecode/StandardLibrary.h>
 #include <Engine/Scene.h>
 
 bool ScriptEntity::DisableAutoAnimate = false;
+HashMap<NativeField>* ScriptEntity::NativeFields = NULL;
 
-#define LINK_INT(VAR) Instance->Fields->Put(#VAR, INTEGER_LINK_VAL(&VAR))
-#define LINK_DEC(VAR) Instance->Fields->Put(#VAR, DECIMAL_LINK_VAL(&VAR))
-#define LINK_BOOL(VAR) Instance->Fields->Put(#VAR, INTEGER_LINK_VAL(&VAR))
+// Plain fields are found from the entity, and component fields from the
+// pointer into the entity's component block
+template <typename T>
+static NativeField GetNativeField(Entity* entity, T& field, Uint32 type) {
+    return NativeField { (Uint32)((Uint8*)&field - (Uint8*)entity), type, NATIVE_FIELD_DIRECT };
+}
+template <typename T, size_t Offset>
+static NativeField GetNativeField(Entity* entity, EntityComponentRef<T, Offset>& field, Uint32 type) {
+    return NativeField { (Uint32)Offset, type, (Uint32)((Uint8*)&entity->Components - (Uint8*)entity) };
+}
+
+// Fields that the object grid has to be told about when they change
+static NativeField MarksBounds(NativeField field) {
+    field.Flags |= NATIVE_FIELD_MARKS_BOUNDS;
+    return field;
+}
+
+#define NATIVE_INT(VAR) GetNativeField(this, VAR, VAL_LINKED_INTEGER)
+#define NATIVE_DEC(VAR) GetNativeField(this, VAR, VAL_LINKED_DECIMAL)
+#define NATIVE_BOUNDS_DEC(VAR) MarksBounds(NATIVE_DEC(VAR))
+
+#define LINK_INT(VAR) NativeFields->Put(#VAR, NATIVE_INT(VAR))
+#define LINK_DEC(VAR) NativeFields->Put(#VAR, NATIVE_DEC(VAR))
+#define LINK_BOOL(VAR) NativeFields->Put(#VAR, NATIVE_INT(VAR))
+#define LINK_BOUNDS_DEC(VAR) NativeFields->Put(#VAR, NATIVE_BOUNDS_DEC(VAR))
 
 bool   SavedHashes = false;
 Uint32 Hash_Create = 0;
@@ -71,24 +96,30 @@ PUBLIC void ScriptEntity::Link(ObjInstance* instance) {
     instance->PropertyGet = VM_Getter;
     instance->PropertySet = VM_Setter;
 
-    LinkFields();
+    // Built-in fields are at the same offsets in every entity, so one
+    // table serves all of them and instances only hold script fields.
+    if (!NativeFields) {
+        NativeFields = new HashMap<NativeField>(NULL, 128);
+        LinkFields();
+    }
+    instance->NativeFields = NativeFields;
 }
 
-PUBLIC void ScriptEntity::LinkFields() {
+PRIVATE void ScriptEntity::LinkFields() {
     /***
     * \field X
     * \type Decimal
     * \ns Instance
     * \desc The X position of the entity.
     */
-    LINK_DEC(X);
+    LINK_BOUNDS_DEC(X);
     /***
     * \field Y
     * \type Decimal
     * \ns Instance
     * \desc The Y position of the entity.
     */
-    LINK_DEC(Y);
+    LINK_BOUNDS_DEC(Y);
     /***
     * \field Z
     * \type Decimal
@@ -322,7 +353,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc Alias for <linkto ref="instance.UpdateRegionW"></linkto>.
     */
-    LINK_DEC(OnScreenHitboxW);
+    LINK_BOUNDS_DEC(OnScreenHitboxW);
     /***
     * \field OnScreenHitboxH
     * \type Decimal
@@ -330,7 +361,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc Alias for <linkto ref="instance.UpdateRegionH"></linkto>.
     */
-    LINK_DEC(OnScreenHitboxH);
+    LINK_BOUNDS_DEC(OnScreenHitboxH);
     /***
     * \field ViewRenderFlag
     * \type Integer
@@ -355,7 +386,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc The horizontal on-screen range where the entity can update. If this is set to <code>0.0</code>, the entity will update regardless of the camera's horizontal position.
     */
-    Instance->Fields->Put("UpdateRegionW", DECIMAL_LINK_VAL(&OnScreenHitboxW));
+    NativeFields->Put("UpdateRegionW", NATIVE_BOUNDS_DEC(OnScreenHitboxW));
     /***
     * \field UpdateRegionH
     * \type Decimal
@@ -363,7 +394,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc The vertical on-screen range where the entity can update. If this is set to <code>0.0</code>, the entity will update regardless of the camera's vertical position.
     */
-    Instance->Fields->Put("UpdateRegionH", DECIMAL_LINK_VAL(&OnScreenHitboxH));
+    NativeFields->Put("UpdateRegionH", NATIVE_BOUNDS_DEC(OnScreenHitboxH));
     /***
     * \field UpdateRegionTop
     * \type Decimal
@@ -371,7 +402,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc The top on-screen range where the entity can update. If set to <code>0.0</code>, the entity will use its <linkto ref="instance.UpdateRegionH">UpdateRegionH</linkto> instead.
     */
-    Instance->Fields->Put("UpdateRegionTop", DECIMAL_LINK_VAL(&OnScreenRegionTop));
+    NativeFields->Put("UpdateRegionTop", NATIVE_BOUNDS_DEC(OnScreenRegionTop));
     /***
     * \field UpdateRegionLeft
     * \type Decimal
@@ -379,7 +410,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc The left on-screen range where the entity can update. If set to <code>0.0</code>, the entity will use its <linkto ref="instance.UpdateRegionW">UpdateRegionW</linkto> instead.
     */
-    Instance->Fields->Put("UpdateRegionLeft", DECIMAL_LINK_VAL(&OnScreenRegionLeft));
+    NativeFields->Put("UpdateRegionLeft", NATIVE_BOUNDS_DEC(OnScreenRegionLeft));
     /***
     * \field UpdateRegionRight
     * \type Decimal
@@ -387,7 +418,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc The left on-screen range where the entity can update. If set to <code>0.0</code>, the entity will use its <linkto ref="instance.UpdateRegionW">UpdateRegionW</linkto> instead.
     */
-    Instance->Fields->Put("UpdateRegionRight", DECIMAL_LINK_VAL(&OnScreenRegionRight));
+    NativeFields->Put("UpdateRegionRight", NATIVE_BOUNDS_DEC(OnScreenRegionRight));
     /***
     * \field UpdateRegionBottom
     * \type Decimal
@@ -395,7 +426,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc The bottom on-screen range where the entity can update. If set to <code>0.0</code>, the entity will use its <linkto ref="instance.UpdateRegionH">UpdateRegionH</linkto> instead.
     */
-    Instance->Fields->Put("UpdateRegionBottom", DECIMAL_LINK_VAL(&OnScreenRegionBottom));
+    NativeFields->Put("UpdateRegionBottom", NATIVE_BOUNDS_DEC(OnScreenRegionBottom));
     /***
     * \field RenderRegionW
     * \type Decimal
@@ -452,7 +483,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc The width of the hitbox.
     */
-    Instance->Fields->Put("HitboxW", DECIMAL_LINK_VAL(&Hitbox.Width));
+    NativeFields->Put("HitboxW", NATIVE_BOUNDS_DEC(Hitbox.Width));
     /***
     * \field HitboxH
     * \type Decimal
@@ -460,7 +491,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc The height of the hitbox.
     */
-    Instance->Fields->Put("HitboxH", DECIMAL_LINK_VAL(&Hitbox.Height));
+    NativeFields->Put("HitboxH", NATIVE_BOUNDS_DEC(Hitbox.Height));
     /***
     * \field HitboxOffX
     * \type Decimal
@@ -468,7 +499,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc The horizontal offset of the hitbox.
     */
-    Instance->Fields->Put("HitboxOffX", DECIMAL_LINK_VAL(&Hitbox.OffsetX));
+    NativeFields->Put("HitboxOffX", NATIVE_BOUNDS_DEC(Hitbox.OffsetX));
     /***
     * \field HitboxOffY
     * \type Decimal
@@ -476,7 +507,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc The vertical offset of the hitbox.
     */
-    Instance->Fields->Put("HitboxOffY", DECIMAL_LINK_VAL(&Hitbox.OffsetY));
+    NativeFields->Put("HitboxOffY", NATIVE_BOUNDS_DEC(Hitbox.OffsetY));
 
     /***
     * \field HitboxLeft
@@ -681,7 +712,7 @@ PUBLIC void ScriptEntity::LinkFields() {
     * \ns Instance
     * \desc See <linkto ref="instance.Persistence"></linkto> instead.
     */
-    Instance->Fields->Put("Persistent", INTEGER_LINK_VAL(&Persistence));
+    NativeFields->Put("Persistent", NATIVE_INT(Persistence));
     /***
     * \field Interactable
     * \type Boolean
@@ -703,6 +734,10 @@ PUBLIC void ScriptEntity::LinkFields() {
 #undef LINK_INT
 #undef LINK_DEC
 #undef LINK_BOOL
+#undef LINK_BOUNDS_DEC
+#undef NATIVE_INT
+#undef NATIVE_DEC
+#undef NATIVE_BOUNDS_DEC
 
 PRIVATE bool ScriptEntity::GetCallableValue(Uint32 hash, VMValue& value) {
     // First look for a field which may shadow a method.
@@ -712,6 +747,12 @@ PRIVATE bool ScriptEntity::GetCallableValue(Uint32 hash, VMValue& value) {
         return true;
     }
 
+    NativeField native;
+    if (NativeFields->GetIfExists(hash, &native)) {
+        value = ScriptManager::DelinkValue(NATIVE_FIELD_VAL(this, native));
+        return true;
+    }
+
     ObjClass* klass = Instance->Object.Class;
     if (klass->Methods->GetIfExists(hash, &result)) {
         value = result;
@@ -854,14 +895,11 @@ PUBLIC void ScriptEntity::CopyVMFields(ScriptEntity* other) {
 
     destFields->Clear();
 
+    // Built-in fields aren't in the table, Entity::CopyFields handles those
     srcFields->WithAll([destFields](Uint32 key, VMValue value) -> void {
-        // Don't copy linked fields, because they point to this entity's built-in fields
-        if (value.Type != VAL_LINKED_INTEGER && value.Type != VAL_LINKED_DECIMAL)
-            destFields->Put(key, value);
+        destFields->Put(key, value);
     });
-
-    // Link the built-in fields again, since they have been removed
-    other->LinkFields();
+    GC_WRITE_BARRIER(other->Instance);
 }
 
 // Events called from C++
@@ -920,6 +958,7 @@ PUBLIC void ScriptEntity::Initialize() {
 
     Hitbox.Clear();
     FlipFlag = 0;
+    MarkBoundsChanged();
 
     VelocityX = 0.0f;
     VelocityY = 0.0f;
@@ -968,10 +1007,14 @@ PUBLIC void ScriptEntity::UpdateLate() {
 
     RunFunction(Hash_UpdateLate);
 
+    // Done for every entity at once, after the late update pass
+    Uint8 pending = 0;
     if (AutoAnimate)
-        Animate();
+        pending |= ENTITY_PENDING_ANIMATE;
     if (AutoPhysics)
-        ApplyMotion();
+        pending |= ENTITY_PENDING_MOTION;
+    if (pending)
+        EntityComponents::SetPending(ComponentSlot, pending);
 }
 PUBLIC void ScriptEntity::RenderEarly() {
     if (!Active) return;
@@ -1077,23 +1120,31 @@ PUBLIC STATIC bool ScriptEntity::VM_Setter(Obj* object, Uint32 hash, VMValue val
     Entity* self = GetScriptEntity(object);
 
     if (hash == Hash_HitboxLeft) {
-        if (ScriptManager::DoDecimalConversion(value, threadID))
+        if (ScriptManager::DoDecimalConversion(value, threadID)) {
             self->Hitbox.SetLeft(AS_DECIMAL(value));
+            self->MarkBoundsChanged();
+        }
         return true;
     }
     else if (hash == Hash_HitboxTop) {
-        if (ScriptManager::DoDecimalConversion(value, threadID))
+        if (ScriptManager::DoDecimalConversion(value, threadID)) {
             self->Hitbox.SetTop(AS_DECIMAL(value));
+            self->MarkBoundsChanged();
+        }
         return true;
     }
     else if (hash == Hash_HitboxRight) {
-        if (ScriptManager::DoDecimalConversion(value, threadID))
+        if (ScriptManager::DoDecimalConversion(value, threadID)) {
             self->Hitbox.SetRight(AS_DECIMAL(value));
+            self->MarkBoundsChanged();
+        }
         return true;
     }
     else if (hash == Hash_HitboxBottom) {
-        if (ScriptManager::DoDecimalConversion(value, threadID))
+        if (ScriptManager::DoDecimalConversion(value, threadID)) {
             self->Hitbox.SetBottom(AS_DECIMAL(value));
+            self->MarkBoundsChanged();
+        }
         return true;
     }
 
@@ -1383,6 +1434,7 @@ PUBLIC STATIC VMValue ScriptEntity::VM_GetHitboxFromSprite(int argCount, VMValue
     else {
         self->Hitbox.Set(frameO.Boxes[hitbox]);
     }
+    self->MarkBoundsChanged();
 
     return NULL_VAL;
 }
@@ -1,5 +1,6 @@
 #if INTERFACE
 need_t ScriptEntity;
+need_t Bytecode;
 
 #include <Engine/Includes/Standard.h>
 #include <Engine/Bytecode/VMThread.h>
@@ -18,26 +19,48 @@ public:
     static HashMap<VMValue>*           Globals;
     static HashMap<VMValue>*           Constants;
 
+    static vector<GlobalRef>           GlobalRefs;
+    static HashMap<Uint32>*            GlobalRefIndices;
+
     static std::set<Obj*>              FreedGlobals;
 
+    enum {
+        JOB_FREE,
+        JOB_QUEUED,
+        JOB_RUNNING,
+        JOB_DONE
+    };
+    enum {
+        MAX_JOBS = 64
+    };
+
     static VMThread                    Threads[8];
     static Uint32                      ThreadCount;
+    static ScriptJob                   Jobs[MAX_JOBS];
 
     static vector<ObjModule*>          ModuleList;
 
     static HashMap<BytecodeContainer>* Sources;
     static HashMap<ObjClass*>*         Classes;
     static HashMap<char*>*             Tokens;
+    static HashMap<ObjString*>*        InternedStrings;
     static vector<ObjNamespace*>       AllNamespaces;
     static vector<ObjClass*>           ClassImplList;
 
     static SDL_mutex*                  GlobalLock;
+    static SDL_atomic_t                LockingEnabled;
+
+    static Uint32                      InlineCacheEpoch;
 };
 #endif
 
 #include <Engine/Bytecode/ScriptManager.h>
+#include <Engine/Bytecode/BytecodeBundle.h>
+#include <Engine/Bytecode/JIT.h>
 #include <Engine/Bytecode/ScriptEntity.h>
 #include <Engine/Bytecode/GarbageCollector.h>
+#include <Engine/Bytecode/ObjectPool.h>
+#include <Engine/Bytecode/ScriptProfiler.h>
 #include <Engine/Bytecode/StandardLibrary.h>
 #include <Engine/Bytecode/SourceFileMap.h>
 #include <Engine/Bytecode/Values.h>
@@ -46,12 +69,16 @@ public:
 #include <Engine/Bytecode/TypeImpl/MapImpl.h>
 #include <Engine/Bytecode/TypeImpl/FunctionImpl.h>
 #include <Engine/Bytecode/TypeImpl/StringImpl.h>
+#include <Engine/Bytecode/TypeImpl/TypedArrayImpl.h>
 #include <Engine/Diagnostics/Log.h>
 #include <Engine/Filesystem/File.h>
 #include <Engine/Hashing/CombinedHash.h>
 #include <Engine/Hashing/FNV1A.h>
+#include <Engine/Hashing/Murmur.h>
 #include <Engine/ResourceTypes/ResourceManager.h>
 #include <Engine/TextFormats/XML/XMLParser.h>
+#include <Engine/Types/EntityPool.h>
+#include <Engine/Utilities/JobSystem.h>
 
 #include <Engine/Bytecode/Compiler.h>
 
@@ -59,10 +86,14 @@ bool                        ScriptManager::LoadAllClasses = false;
 
 VMThread                    ScriptManager::Threads[8];
 Uint32                      ScriptManager::ThreadCount = 1;
+ScriptJob                   ScriptManager::Jobs[ScriptManager::MAX_JOBS];
 
 HashMap<VMValue>*           ScriptManager::Globals = NULL;
 HashMap<VMValue>*           ScriptManager::Constants = NULL;
 
+vector<GlobalRef>           ScriptManager::GlobalRefs;
+HashMap<Uint32>*            ScriptManager::GlobalRefIndices = NULL;
+
 std::set<Obj*>              ScriptManager::FreedGlobals;
 
 vector<ObjModule*>          ScriptManager::ModuleList;
@@ -70,14 +101,40 @@ vector<ObjModule*>          ScriptManager::ModuleList;
 HashMap<BytecodeContainer>* ScriptManager::Sources = NULL;
 HashMap<ObjClass*>*         ScriptManager::Classes = NULL;
 HashMap<char*>*             ScriptManager::Tokens = NULL;
+HashMap<ObjString*>*        ScriptManager::InternedStrings = NULL;
 vector<ObjNamespace*>       ScriptManager::AllNamespaces;
 vector<ObjClass*>           ScriptManager::ClassImplList;
 
 SDL_mutex*                  ScriptManager::GlobalLock = NULL;
+SDL_atomic_t                ScriptManager::LockingEnabled;
+
+// How many Lock calls the current thread has yet to Unlock
+static thread_local int     LockDepth = 0;
+
+Uint32                      ScriptManager::InlineCacheEpoch = 1;
 
 // #define DEBUG_STRESS_GC
 
 PUBLIC STATIC void    ScriptManager::RequestGarbageCollection() {
+    if (GarbageCollector::Generational
+        && GarbageCollector::State == GarbageCollector::STATE_IDLE
+        && GarbageCollector::NurserySize > GarbageCollector::NurseryLimit)
+        CollectYoungGarbage();
+
+    if (GarbageCollector::Incremental) {
+#ifndef DEBUG_STRESS_GC
+        if (GarbageCollector::State != GarbageCollector::STATE_IDLE
+            || GarbageCollector::GarbageSize > GarbageCollector::NextGC)
+#endif
+        {
+            StepGarbageCollection();
+
+            if (GarbageCollector::State == GarbageCollector::STATE_IDLE)
+                Log::Print(Log::LOG_INFO, "%04X: Finished incremental collection at %u, next GC at %d (max pause %.3f ms)", Scene::Frame, (Uint32)GarbageCollector::GarbageSize, GarbageCollector::NextGC, GarbageCollector::MaxPause);
+        }
+        return;
+    }
+
 #ifndef DEBUG_STRESS_GC
     if (GarbageCollector::GarbageSize > GarbageCollector::NextGC)
 #endif
@@ -102,6 +159,30 @@ PUBLIC STATIC void    ScriptManager::ForceGarbageCollection() {
         ScriptManager::Unlock();
     }
 }
+PUBLIC STATIC void    ScriptManager::CollectYoungGarbage() {
+    if (ScriptManager::Lock()) {
+        if (ScriptManager::ThreadCount > 1) {
+            ScriptManager::Unlock();
+            return;
+        }
+
+        GarbageCollector::CollectYoung();
+
+        ScriptManager::Unlock();
+    }
+}
+PUBLIC STATIC void    ScriptManager::StepGarbageCollection() {
+    if (ScriptManager::Lock()) {
+        if (ScriptManager::ThreadCount > 1) {
+            ScriptManager::Unlock();
+            return;
+        }
+
+        GarbageCollector::Step();
+
+        ScriptManager::Unlock();
+    }
+}
 
 PUBLIC STATIC void    ScriptManager::ResetStack() {
     Threads[0].ResetStack();
@@ -113,21 +194,27 @@ PUBLIC STATIC void    ScriptManager::Init() {
         Globals = new HashMap<VMValue>(NULL, 8);
     if (Constants == NULL)
         Constants = new HashMap<VMValue>(NULL, 8);
+    if (GlobalRefIndices == NULL)
+        GlobalRefIndices = new HashMap<Uint32>(NULL, 64);
     if (Sources == NULL)
         Sources = new HashMap<BytecodeContainer>(NULL, 8);
     if (Classes == NULL)
         Classes = new HashMap<ObjClass*>(NULL, 8);
     if (Tokens == NULL)
         Tokens = new HashMap<char*>(NULL, 64);
+    if (InternedStrings == NULL)
+        InternedStrings = new HashMap<ObjString*>(NULL, 512);
 
     ArrayImpl::Init();
     MapImpl::Init();
     FunctionImpl::Init();
     StringImpl::Init();
+    TypedArrayImpl::Init();
 
     memset(VMThread::InstructionIgnoreMap, 0, sizeof(VMThread::InstructionIgnoreMap));
 
     GlobalLock = SDL_CreateMutex();
+    SDL_AtomicSet(&LockingEnabled, 0);
 
     for (Uint32 i = 0; i < sizeof(Threads) / sizeof(VMThread); i++) {
         memset(&Threads[i].Stack, 0, sizeof(Threads[i].Stack));
@@ -143,6 +230,14 @@ PUBLIC STATIC void    ScriptManager::Init() {
         Threads[i].StackTop = Threads[i].Stack;
     }
     ThreadCount = 1;
+
+    for (Uint32 i = 0; i < MAX_JOBS; i++) {
+        Jobs[i].Callback = NULL_VAL;
+        Jobs[i].ArgCount = 0;
+        Jobs[i].Result = NULL_VAL;
+        Jobs[i].Generation = 0;
+        SDL_AtomicSet(&Jobs[i].State, JOB_FREE);
+    }
 }
 PUBLIC STATIC void    ScriptManager::DisposeGlobalValueTable(HashMap<VMValue>* globals) {
     globals->ForAll(FreeGlobalValue);
@@ -150,6 +245,9 @@ PUBLIC STATIC void    ScriptManager::DisposeGlobalValueTable(HashMap<VMValue>* g
     delete globals;
 }
 PUBLIC STATIC void    ScriptManager::Dispose() {
+    // Samples point at functions that are about to be freed
+    ScriptProfiler::Dispose();
+
     // NOTE: Remove GC-able values from these tables so they may be cleaned up.
     if (Globals)
         Globals->ForAll(RemoveNonGlobalableValue);
@@ -159,6 +257,11 @@ PUBLIC STATIC void    ScriptManager::Dispose() {
     ClassImplList.clear();
     AllNamespaces.clear();
 
+    // Script jobs may still be using the values freed below
+    WaitForJobs();
+    for (Uint32 i = 0; i < MAX_JOBS; i++)
+        FreeJob(&Jobs[i]);
+
     Threads[0].FrameCount = 0;
     Threads[0].ResetStack();
     ForceGarbageCollection();
@@ -181,6 +284,13 @@ PUBLIC STATIC void    ScriptManager::Dispose() {
 
     FreeModules();
 
+    // Only linked bytecode refers to these, and it's gone now
+    GlobalRefs.clear();
+    if (GlobalRefIndices) {
+        delete GlobalRefIndices;
+        GlobalRefIndices = NULL;
+    }
+
     if (Sources) {
         Sources->WithAll([](Uint32 hash, BytecodeContainer bytecode) -> void {
             Memory::Free(bytecode.Data);
@@ -203,6 +313,26 @@ PUBLIC STATIC void    ScriptManager::Dispose() {
         Tokens = NULL;
     }
 
+    if (InternedStrings) {
+        // Whatever is left here was shared by the modules freed above
+        vector<ObjString*> strings;
+        InternedStrings->WithAll([&strings](Uint32, ObjString* string) -> void {
+            strings.push_back(string);
+        });
+        InternedStrings->Clear();
+        delete InternedStrings;
+        InternedStrings = NULL;
+
+        for (size_t i = 0; i < strings.size(); i++)
+            FreeString(strings[i]);
+    }
+
+    // No function is left to decode from it
+    BytecodeBundle::Close();
+
+    // Anything still allocated past this point has leaked
+    ObjectPool::Dispose();
+
     SDL_DestroyMutex(GlobalLock);
 }
 PRIVATE STATIC void    ScriptManager::RemoveNonGlobalableValue(Uint32 hash, VMValue value) {
@@ -242,26 +372,27 @@ PRIVATE STATIC void    ScriptManager::FreeFunction(ObjFunction* function) {
             "NULL");
     //*/
     if (function->Name != NULL)
-        FreeValue(OBJECT_VAL(function->Name));
+        FreeOwnedValue(OBJECT_VAL(function->Name));
     if (function->ClassName != NULL)
-        FreeValue(OBJECT_VAL(function->ClassName));
+        FreeOwnedValue(OBJECT_VAL(function->ClassName));
 
     for (size_t i = 0; i < function->Chunk.Constants->size(); i++)
-        FreeValue((*function->Chunk.Constants)[i]);
+        FreeOwnedValue((*function->Chunk.Constants)[i]);
     function->Chunk.Constants->clear();
+    JIT::Free(function);
     function->Chunk.Free();
 
     FREE_OBJ(function, ObjFunction);
 }
 PRIVATE STATIC void    ScriptManager::FreeModule(ObjModule* module) {
     if (module->SourceFilename != NULL)
-        FreeValue(OBJECT_VAL(module->SourceFilename));
+        FreeOwnedValue(OBJECT_VAL(module->SourceFilename));
 
     for (size_t i = 0; i < module->Functions->size(); i++)
         FreeFunction((*module->Functions)[i]);
 
     for (size_t i = 0; i < module->Locals->size(); i++)
-        FreeValue((*module->Locals)[i]);
+        FreeOwnedValue((*module->Locals)[i]);
 
     delete module->Functions;
     delete module->Locals;
@@ -279,7 +410,7 @@ PRIVATE STATIC void    ScriptManager::FreeClass(ObjClass* klass) {
     delete klass->Fields;
 
     if (klass->Name)
-        FreeValue(OBJECT_VAL(klass->Name));
+        FreeOwnedValue(OBJECT_VAL(klass->Name));
 
     FREE_OBJ(klass, ObjClass);
 }
@@ -289,7 +420,7 @@ PRIVATE STATIC void    ScriptManager::FreeEnumeration(ObjEnum* enumeration) {
     delete enumeration->Fields;
 
     if (enumeration->Name)
-        FreeValue(OBJECT_VAL(enumeration->Name));
+        FreeOwnedValue(OBJECT_VAL(enumeration->Name));
 
     FREE_OBJ(enumeration, ObjEnum);
 }
@@ -299,11 +430,22 @@ PRIVATE STATIC void    ScriptManager::FreeNamespace(ObjNamespace* ns) {
     delete ns->Fields;
 
     if (ns->Name)
-        FreeValue(OBJECT_VAL(ns->Name));
+        FreeOwnedValue(OBJECT_VAL(ns->Name));
 
     FREE_OBJ(ns, ObjNamespace);
 }
+PRIVATE STATIC void    ScriptManager::FreeOwnedValue(VMValue value) {
+    // Interned strings can be shared between several owners, so they
+    // are left for the GC or the intern table to free.
+    if (IS_STRING(value) && AS_STRING(value)->IsInterned)
+        return;
+
+    FreeValue(value);
+}
 PUBLIC STATIC void    ScriptManager::FreeString(ObjString* string) {
+    if (string->IsInterned)
+        UninternString(string);
+
     if (string->Chars != NULL)
         Memory::Free(string->Chars);
     string->Chars = NULL;
@@ -366,6 +508,8 @@ PRIVATE STATIC void   ScriptManager::FreeModules() {
 PUBLIC STATIC VMValue ScriptManager::CastValueAsString(VMValue v, bool prettyPrint) {
     if (IS_STRING(v))
         return v;
+    if (IS_STRING_BUILDER(v))
+        return OBJECT_VAL(CopyString(AS_STRING_BUILDER(v)->Chars, AS_STRING_BUILDER(v)->Length));
 
     char* buffer = (char*)malloc(512);
     PrintBuffer buffer_info;
@@ -382,7 +526,7 @@ PUBLIC STATIC VMValue ScriptManager::CastValueAsString(VMValue v) {
 }
 PUBLIC STATIC VMValue ScriptManager::CastValueAsInteger(VMValue v) {
     float a;
-    switch (v.Type) {
+    switch (VALUE_TYPE(v)) {
         case VAL_DECIMAL:
         case VAL_LINKED_DECIMAL:
             a = AS_DECIMAL(v);
@@ -399,7 +543,7 @@ PUBLIC STATIC VMValue ScriptManager::CastValueAsInteger(VMValue v) {
 }
 PUBLIC STATIC VMValue ScriptManager::CastValueAsDecimal(VMValue v) {
     int a;
-    switch (v.Type) {
+    switch (VALUE_TYPE(v)) {
         case VAL_DECIMAL:
             return v;
         case VAL_LINKED_DECIMAL:
@@ -414,6 +558,55 @@ PUBLIC STATIC VMValue ScriptManager::CastValueAsDecimal(VMValue v) {
     }
     return NULL_VAL;
 }
+// #region String Interning
+PUBLIC STATIC ObjString* ScriptManager::InternString(const char* chars, size_t length) {
+    // Strings with a NUL inside would hash differently as map keys
+    if (!InternedStrings || memchr(chars, '\0', length))
+        return CopyString(chars, length);
+
+    Uint32 hash = Murmur::EncryptData(chars, length);
+
+    ObjString* string;
+    if (InternedStrings->GetIfExists(hash, &string)) {
+        if (string->Length == length && !memcmp(string->Chars, chars, length))
+            return string;
+
+        // Some other text already owns this hash
+        return CopyString(chars, length);
+    }
+
+    string = CopyString(chars, length);
+    string->IsInterned = true;
+    InternedStrings->Put(hash, string);
+    return string;
+}
+PUBLIC STATIC ObjString* ScriptManager::InternString(const char* chars) {
+    return InternString(chars, strlen(chars));
+}
+PUBLIC STATIC void       ScriptManager::UninternString(ObjString* string) {
+    ObjString* owner;
+    if (InternedStrings && InternedStrings->GetIfExists(string->Hash, &owner) && owner == string)
+        InternedStrings->Remove(string->Hash);
+    string->IsInterned = false;
+}
+PUBLIC STATIC void       ScriptManager::PruneInternedStrings() {
+    if (!InternedStrings)
+        return;
+
+    // The table doesn't keep its strings alive. Anything left unmarked
+    // is about to be swept, so it mustn't be handed out again.
+    vector<Uint32> dead;
+    InternedStrings->WithAll([&dead](Uint32 hash, ObjString* string) -> void {
+        if (!string->Object.IsDark) {
+            string->IsInterned = false;
+            dead.push_back(hash);
+        }
+    });
+    for (size_t i = 0; i < dead.size(); i++)
+        InternedStrings->Remove(dead[i]);
+}
+// #endregion
+
 PUBLIC STATIC VMValue ScriptManager::Concatenate(VMValue va, VMValue vb) {
     ObjString* a = AS_STRING(va);
     ObjString* b = AS_STRING(vb);
@@ -428,8 +621,8 @@ PUBLIC STATIC VMValue ScriptManager::Concatenate(VMValue va, VMValue vb) {
 }
 
 PUBLIC STATIC bool    ScriptManager::ValuesSortaEqual(VMValue a, VMValue b) {
-    if ((a.Type == VAL_DECIMAL && b.Type == VAL_INTEGER) ||
-        (a.Type == VAL_INTEGER && b.Type == VAL_DECIMAL)) {
+    if ((VALUE_TYPE(a) == VAL_DECIMAL && VALUE_TYPE(b) == VAL_INTEGER) ||
+        (VALUE_TYPE(a) == VAL_INTEGER && VALUE_TYPE(b) == VAL_DECIMAL)) {
         float a_d = AS_DECIMAL(CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(CastValueAsDecimal(b));
         return (a_d == b_d);
@@ -438,6 +631,8 @@ PUBLIC STATIC bool    ScriptManager::ValuesSortaEqual(VMValue a, VMValue b) {
     if (IS_STRING(a) && IS_STRING(b)) {
         ObjString* astr = AS_STRING(a);
         ObjString* bstr = AS_STRING(b);
+        if (astr == bstr)
+            return true;
         return astr->Length == bstr->Length && !memcmp(astr->Chars, bstr->Chars, astr->Length);
     }
 
@@ -450,16 +645,16 @@ PUBLIC STATIC bool    ScriptManager::ValuesSortaEqual(VMValue a, VMValue b) {
     return ScriptManager::ValuesEqual(a, b);
 }
 PUBLIC STATIC bool    ScriptManager::ValuesEqual(VMValue a, VMValue b) {
-    if (a.Type == VAL_LINKED_INTEGER) goto SKIP_CHECK;
-    if (a.Type == VAL_LINKED_DECIMAL) goto SKIP_CHECK;
-    if (b.Type == VAL_LINKED_INTEGER) goto SKIP_CHECK;
-    if (b.Type == VAL_LINKED_DECIMAL) goto SKIP_CHECK;
+    if (VALUE_TYPE(a) == VAL_LINKED_INTEGER) goto SKIP_CHECK;
+    if (VALUE_TYPE(a) == VAL_LINKED_DECIMAL) goto SKIP_CHECK;
+    if (VALUE_TYPE(b) == VAL_LINKED_INTEGER) goto SKIP_CHECK;
+    if (VALUE_TYPE(b) == VAL_LINKED_DECIMAL) goto SKIP_CHECK;
 
-    if (a.Type != b.Type) return false;
+    if (VALUE_TYPE(a) != VALUE_TYPE(b)) return false;
 
     SKIP_CHECK:
 
-    switch (a.Type) {
+    switch (VALUE_TYPE(a)) {
         case VAL_LINKED_INTEGER:
         case VAL_INTEGER: return AS_INTEGER(a) == AS_INTEGER(b);
 
@@ -473,9 +668,9 @@ PUBLIC STATIC bool    ScriptManager::ValuesEqual(VMValue a, VMValue b) {
     return false;
 }
 PUBLIC STATIC bool    ScriptManager::ValueFalsey(VMValue a) {
-    if (a.Type == VAL_NULL) return true;
+    if (VALUE_TYPE(a) == VAL_NULL) return true;
 
-    switch (a.Type) {
+    switch (VALUE_TYPE(a)) {
         case VAL_LINKED_INTEGER:
         case VAL_INTEGER: return AS_INTEGER(a) == 0;
         case VAL_LINKED_DECIMAL:
@@ -575,6 +770,26 @@ PUBLIC STATIC void    ScriptManager::FreeValue(VMValue value) {
                 FREE_OBJ(stream, ObjStream);
                 break;
             }
+            case OBJ_TYPED_ARRAY: {
+                ObjTypedArray* array = AS_TYPED_ARRAY(value);
+
+                size_t size = array->Length * GetTypedArrayElementSize(array->ElementType);
+                assert(GarbageCollector::GarbageSize >= size);
+                GarbageCollector::GarbageSize -= size;
+                Memory::Free(array->Data);
+
+                FREE_OBJ(array, ObjTypedArray);
+                break;
+            }
+            case OBJ_STRING_BUILDER: {
+                ObjStringBuilder* builder = AS_STRING_BUILDER(value);
+                assert(GarbageCollector::GarbageSize >= builder->Capacity);
+                GarbageCollector::GarbageSize -= builder->Capacity;
+                free(builder->Chars);
+
+                FREE_OBJ(builder, ObjStringBuilder);
+                break;
+            }
             default:
                 break;
         }
@@ -583,11 +798,69 @@ PUBLIC STATIC void    ScriptManager::FreeValue(VMValue value) {
 // #endregion
 
 // #region GlobalFuncs
+// The global lock is only taken for real while another script thread
+// exists. Until then Lock and Unlock just keep count, so that the
+// caller can take the mutex as many times as it needs to when a thread
+// is started in the middle of a locked section.
 PUBLIC STATIC bool    ScriptManager::Lock() {
-    return (SDL_LockMutex(GlobalLock) == 0);
+    if (SDL_AtomicGet(&LockingEnabled) && SDL_LockMutex(GlobalLock) != 0)
+        return false;
+    LockDepth++;
+    return true;
 }
 PUBLIC STATIC void    ScriptManager::Unlock() {
-    SDL_UnlockMutex(GlobalLock);
+    if (LockDepth > 0)
+        LockDepth--;
+    if (SDL_AtomicGet(&LockingEnabled))
+        SDL_UnlockMutex(GlobalLock);
+}
+// Must be called before starting a thread that runs script code.
+PUBLIC STATIC void    ScriptManager::EnableLocking() {
+    if (SDL_AtomicGet(&LockingEnabled))
+        return;
+
+    for (int i = 0; i < LockDepth; i++)
+        SDL_LockMutex(GlobalLock);
+
+    SDL_AtomicSet(&LockingEnabled, 1);
+}
+// Goes back to unlocked access once every script thread has finished.
+// Only the main thread may call this.
+PUBLIC STATIC void    ScriptManager::CheckLocking() {
+    if (!SDL_AtomicGet(&LockingEnabled))
+        return;
+
+    if (Lock()) {
+        if (ThreadCount > 1) {
+            Unlock();
+            return;
+        }
+
+        SDL_AtomicSet(&LockingEnabled, 0);
+        for (int i = 0; i < LockDepth; i++)
+            SDL_UnlockMutex(GlobalLock);
+
+        Unlock();
+    }
+}
+// Fully releases the global lock held by the calling thread, so it can
+// block on another script thread without deadlocking it. Returns how
+// many times the lock was held, to be passed on to ResumeLock.
+PUBLIC STATIC int     ScriptManager::SuspendLock() {
+    int depth = LockDepth;
+    if (SDL_AtomicGet(&LockingEnabled)) {
+        for (int i = 0; i < depth; i++)
+            SDL_UnlockMutex(GlobalLock);
+    }
+    LockDepth = 0;
+    return depth;
+}
+PUBLIC STATIC void    ScriptManager::ResumeLock(int depth) {
+    if (SDL_AtomicGet(&LockingEnabled)) {
+        for (int i = 0; i < depth; i++)
+            SDL_LockMutex(GlobalLock);
+    }
+    LockDepth = depth;
 }
 
 PUBLIC STATIC void    ScriptManager::DefineMethod(VMThread* thread, ObjFunction* function, Uint32 hash) {
@@ -595,11 +868,14 @@ PUBLIC STATIC void    ScriptManager::DefineMethod(VMThread* thread, ObjFunction*
 
     ObjClass* klass = AS_CLASS(thread->Peek(0));
     klass->Methods->Put(hash, methodValue);
+    GC_WRITE_BARRIER(klass);
+    InvalidateInlineCaches();
 
     if (hash == klass->Hash)
         klass->Initializer = methodValue;
 
-    function->ClassName = CopyString(klass->Name);
+    function->ClassName = InternString(klass->Name->Chars, klass->Name->Length);
+    GC_WRITE_BARRIER(function);
 
     thread->Pop();
 }
@@ -608,8 +884,19 @@ PUBLIC STATIC void    ScriptManager::DefineNative(ObjClass* klass, const char* n
     if (klass == NULL) return;
     if (name == NULL) return;
 
-    if (!klass->Methods->Exists(name))
+    if (!klass->Methods->Exists(name)) {
         klass->Methods->Put(name, OBJECT_VAL(NewNative(function)));
+        InvalidateInlineCaches();
+    }
+}
+PUBLIC STATIC void    ScriptManager::DefineNatives(ObjClass* klass, const NativeDef* natives, size_t count) {
+    if (klass == NULL) return;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!klass->Methods->Exists(natives[i].Hash))
+            klass->Methods->Put(natives[i].Hash, OBJECT_VAL(NewNative(natives[i].Function)));
+    }
+    InvalidateInlineCaches();
 }
 PUBLIC STATIC void    ScriptManager::GlobalLinkInteger(ObjClass* klass, const char* name, int* value) {
     if (name == NULL) return;
@@ -619,6 +906,7 @@ PUBLIC STATIC void    ScriptManager::GlobalLinkInteger(ObjClass* klass, const ch
     }
     else {
         klass->Methods->Put(name, INTEGER_LINK_VAL(value));
+        InvalidateInlineCaches();
     }
 }
 PUBLIC STATIC void    ScriptManager::GlobalLinkDecimal(ObjClass* klass, const char* name, float* value) {
@@ -629,21 +917,31 @@ PUBLIC STATIC void    ScriptManager::GlobalLinkDecimal(ObjClass* klass, const ch
     }
     else {
         klass->Methods->Put(name, DECIMAL_LINK_VAL(value));
+        InvalidateInlineCaches();
     }
 }
 PUBLIC STATIC void    ScriptManager::GlobalConstInteger(ObjClass* klass, const char* name, int value) {
     if (name == NULL) return;
     if (klass == NULL)
         Constants->Put(name, INTEGER_VAL(value));
-    else
+    else {
         klass->Methods->Put(name, INTEGER_VAL(value));
+        InvalidateInlineCaches();
+    }
 }
 PUBLIC STATIC void    ScriptManager::GlobalConstDecimal(ObjClass* klass, const char* name, float value) {
     if (name == NULL) return;
     if (klass == NULL)
         Constants->Put(name, DECIMAL_VAL(value));
-    else
+    else {
         klass->Methods->Put(name, DECIMAL_VAL(value));
+        InvalidateInlineCaches();
+    }
+}
+// Call sites cache where a class-level property was found, which stays
+// correct only as long as no class gains a key that could shadow it.
+PUBLIC STATIC void    ScriptManager::InvalidateInlineCaches() {
+    InlineCacheEpoch++;
 }
 PUBLIC STATIC ObjClass* ScriptManager::GetClassParent(ObjClass* klass) {
     if (!klass->Parent && klass->ParentHash) {
@@ -674,6 +972,147 @@ PUBLIC STATIC void    ScriptManager::LinkExtensions() {
 }
 // #endregion
 
+// #region Jobs
+// Queues a call to be run on one of the worker threads. Returns a handle
+// to the job, or -1 if every job slot is taken.
+PUBLIC STATIC int     ScriptManager::SubmitJob(VMValue callback, VMValue* args, int argCount) {
+    if (argCount > JOB_ARGS_MAX)
+        return -1;
+
+    EnableLocking();
+
+    ScriptJob* job = NULL;
+    int handle = -1;
+    if (Lock()) {
+        // Finished jobs that nobody joined get recycled once every slot
+        // has been used.
+        for (Uint32 pass = 0; pass < 2 && !job; pass++) {
+            for (Uint32 i = 0; i < MAX_JOBS; i++) {
+                int state = SDL_AtomicGet(&Jobs[i].State);
+                if (state == JOB_FREE || (pass == 1 && state == JOB_DONE)) {
+                    job = &Jobs[i];
+                    break;
+                }
+            }
+        }
+
+        if (job) {
+            FreeJob(job);
+
+            job->Callback = callback;
+            job->ArgCount = argCount;
+            for (int i = 0; i < argCount; i++)
+                job->Args[i] = args[i];
+            SDL_AtomicSet(&job->State, JOB_QUEUED);
+            handle = (int)((job->Generation << 8) | (Uint32)(job - Jobs));
+
+            ThreadCount++;
+        }
+        Unlock();
+    }
+    if (!job)
+        return -1;
+
+    if (!JobSystem::Submit(RunJob, job)) {
+        if (Lock()) {
+            FreeJob(job);
+            ThreadCount--;
+            Unlock();
+        }
+        return -1;
+    }
+
+    return handle;
+}
+PRIVATE STATIC void    ScriptManager::RunJob(void* data, int worker) {
+    ScriptJob* job = (ScriptJob*)data;
+    VMThread*  thread = Threads + 1 + worker;
+
+    SDL_AtomicSet(&job->State, JOB_RUNNING);
+
+    thread->FrameCount = 0;
+    thread->ResetStack();
+    thread->InterpretResult = NULL_VAL;
+
+    thread->Push(job->Callback);
+    for (int i = 0; i < job->ArgCount; i++)
+        thread->Push(job->Args[i]);
+    thread->RunValue(job->Callback, job->ArgCount);
+
+    if (Lock()) {
+        job->Result = thread->InterpretResult;
+        thread->FrameCount = 0;
+        thread->ResetStack();
+
+        SDL_AtomicSet(&job->State, JOB_DONE);
+        ThreadCount--;
+        Unlock();
+    }
+}
+PRIVATE STATIC void    ScriptManager::FreeJob(ScriptJob* job) {
+    // Bumping the generation makes old handles to this slot invalid.
+    job->Generation = (job->Generation + 1) & 0x7FFFFF;
+    job->Callback = NULL_VAL;
+    job->ArgCount = 0;
+    job->Result = NULL_VAL;
+    SDL_AtomicSet(&job->State, JOB_FREE);
+}
+PRIVATE STATIC bool    ScriptManager::IsJobFinished(void* data) {
+    return SDL_AtomicGet(&((ScriptJob*)data)->State) == JOB_DONE;
+}
+PRIVATE STATIC bool    ScriptManager::AreJobsFinished(void* data) {
+    return ThreadCount == 1;
+}
+PUBLIC STATIC ScriptJob* ScriptManager::GetJob(int handle) {
+    if (handle < 0 || (handle & 0xFF) >= MAX_JOBS)
+        return NULL;
+
+    ScriptJob* job = &Jobs[handle & 0xFF];
+    if (job->Generation != (Uint32)handle >> 8
+        || SDL_AtomicGet(&job->State) == JOB_FREE)
+        return NULL;
+
+    return job;
+}
+PUBLIC STATIC bool    ScriptManager::IsJobDone(int handle) {
+    ScriptJob* job = GetJob(handle);
+    return job && SDL_AtomicGet(&job->State) == JOB_DONE;
+}
+// Waits for a job to finish, and frees its slot. Returns false if the
+// handle does not refer to a job.
+PUBLIC STATIC bool    ScriptManager::JoinJob(int handle, VMValue* result) {
+    ScriptJob* job = GetJob(handle);
+    if (!job)
+        return false;
+
+    if (!IsJobFinished(job)) {
+        int depth = SuspendLock();
+        JobSystem::WaitUntil(IsJobFinished, job);
+        ResumeLock(depth);
+    }
+
+    // Someone else may have joined it while this thread was waiting.
+    bool joined = false;
+    if (Lock()) {
+        if (GetJob(handle) == job) {
+            *result = job->Result;
+            FreeJob(job);
+            joined = true;
+        }
+        Unlock();
+    }
+    return joined;
+}
+PUBLIC STATIC void    ScriptManager::WaitForJobs() {
+    if (ThreadCount == 1)
+        return;
+
+    int depth = SuspendLock();
+    JobSystem::WaitUntil(AreJobsFinished, NULL);
+    ResumeLock(depth);
+}
+// #endregion
+
 #define FG_YELLOW ""
 #define FG_RESET ""
 
@@ -684,6 +1123,104 @@ PUBLIC STATIC void    ScriptManager::LinkExtensions() {
     #define FG_RESET "\x1b[m"
 #endif
 
+// #region Global References
+// Each global name used by loaded bytecode gets a dense index, shared
+// by every script. The table and slot it was last found in are kept,
+// so OP_GET_GLOBAL_SLOT only has to check that the slot still holds
+// the name instead of hashing into Globals and Constants every time.
+PUBLIC STATIC Uint32  ScriptManager::GetGlobalRefIndex(Uint32 hash) {
+    Uint32 index;
+    if (GlobalRefIndices->GetIfExists(hash, &index))
+        return index;
+
+    GlobalRef ref;
+    ref.Hash = hash;
+    ref.Slot = -1;
+    ref.Table = NULL;
+
+    index = (Uint32)GlobalRefs.size();
+    GlobalRefs.push_back(ref);
+    GlobalRefIndices->Put(hash, index);
+    return index;
+}
+PUBLIC STATIC HashMap<VMValue>* ScriptManager::ResolveGlobalRef(GlobalRef* ref) {
+    // The table pointers are compared before use, since the old tables
+    // may have been freed.
+    if (ref->Table == Globals) {
+        if (Globals->SlotHasKey(ref->Slot, ref->Hash))
+            return Globals;
+    }
+    else if (ref->Table == Constants) {
+        // Globals shadow constants
+        if (Constants->SlotHasKey(ref->Slot, ref->Hash) && !Globals->Exists(ref->Hash))
+            return Constants;
+    }
+
+    ref->Slot = Globals->GetSlot(ref->Hash);
+    if (ref->Slot >= 0) {
+        ref->Table = Globals;
+        return Globals;
+    }
+
+    ref->Slot = Constants->GetSlot(ref->Hash);
+    if (ref->Slot >= 0) {
+        ref->Table = Constants;
+        return Constants;
+    }
+
+    ref->Table = NULL;
+    return NULL;
+}
+PUBLIC STATIC bool    ScriptManager::ReadGlobalRef(Uint32 index, Uint32* hash, VMValue* result) {
+    GlobalRef* ref = &GlobalRefs[index];
+    *hash = ref->Hash;
+
+    HashMap<VMValue>* table = ResolveGlobalRef(ref);
+    if (!table)
+        return false;
+
+    *result = table->Data[ref->Slot].Data;
+    return true;
+}
+// Returns the slot in Globals, or -1 if it isn't a global variable.
+PUBLIC STATIC int     ScriptManager::GetGlobalRefSlot(Uint32 index, Uint32* hash) {
+    GlobalRef* ref = &GlobalRefs[index];
+    *hash = ref->Hash;
+
+    if (ResolveGlobalRef(ref) != Globals)
+        return -1;
+    return ref->Slot;
+}
+// Rewrites global accesses in a freshly loaded function to use
+// reference indices. The operand stays four bytes wide, so offsets
+// and line info are unaffected.
+PUBLIC STATIC void    ScriptManager::LinkGlobals(ObjFunction* function) {
+    Chunk* chunk = &function->Chunk;
+
+    if (ScriptManager::Lock()) {
+        for (int offset = 0; offset < chunk->Count;) {
+            Uint8* code = chunk->Code + offset;
+            int length = Bytecode::GetInstructionLength(code);
+            if (length == 0 || offset + length > chunk->Count)
+                break;
+
+            if (*code == OP_GET_GLOBAL || *code == OP_SET_GLOBAL) {
+                Uint32 hash;
+                memcpy(&hash, code + 1, sizeof(Uint32));
+
+                Uint32 index = GetGlobalRefIndex(hash);
+                memcpy(code + 1, &index, sizeof(Uint32));
+
+                *code = (*code == OP_GET_GLOBAL) ? OP_GET_GLOBAL_SLOT : OP_SET_GLOBAL_SLOT;
+            }
+
+            offset += length;
+        }
+        ScriptManager::Unlock();
+    }
+}
+// #endregion
+
 // #region ObjectFuncs
 PUBLIC STATIC bool    ScriptManager::RunBytecode(BytecodeContainer bytecodeContainer, Uint32 filenameHash) {
     Bytecode* bytecode = new Bytecode();
@@ -692,6 +1229,24 @@ PUBLIC STATIC bool    ScriptManager::RunBytecode(BytecodeContainer bytecodeConta
         return false;
     }
 
+    return RunModule(bytecode, filenameHash);
+}
+PUBLIC STATIC bool    ScriptManager::RunBundledBytecode(Uint32 filenameHash) {
+    Bytecode* bytecode = new Bytecode();
+    if (!BytecodeBundle::ReadModule(filenameHash, bytecode, Tokens)) {
+        delete bytecode;
+        return false;
+    }
+
+    // Nothing to free later; this just marks the module as loaded.
+    BytecodeContainer container;
+    container.Data = nullptr;
+    container.Size = 0;
+    Sources->Put(filenameHash, container);
+
+    return RunModule(bytecode, filenameHash);
+}
+PRIVATE STATIC bool   ScriptManager::RunModule(Bytecode* bytecode, Uint32 filenameHash) {
     ObjModule* module = NewModule();
 
     for (size_t i = 0; i < bytecode->Functions.size(); i++) {
@@ -700,6 +1255,10 @@ PUBLIC STATIC bool    ScriptManager::RunBytecode(BytecodeContainer bytecodeConta
         module->Functions->push_back(function);
 
         function->Module = module;
+
+        // Bundled functions are linked when they get decoded
+        if (!function->EncodedChunk)
+            LinkGlobals(function);
     }
 
     if (bytecode->SourceFilename)
@@ -737,7 +1296,7 @@ PUBLIC STATIC Entity* ScriptManager::SpawnObject(const char* objectName) {
         return nullptr;
     }
 
-    ScriptEntity* object = new ScriptEntity;
+    ScriptEntity* object = new (EntityPool::Alloc(sizeof(ScriptEntity))) ScriptEntity;
 
     ObjInstance* instance = NewInstance(klass);
     object->Link(instance);
@@ -796,6 +1355,9 @@ PUBLIC STATIC bool    ScriptManager::LoadScript(const char* filename) {
 }
 PUBLIC STATIC bool    ScriptManager::LoadScript(Uint32 hash) {
     if (!Sources->Exists(hash)) {
+        if (BytecodeBundle::HasModule(hash))
+            return RunBundledBytecode(hash);
+
         BytecodeContainer bytecode = ScriptManager::GetBytecodeFromFilenameHash(hash);
         if (!bytecode.Data)
             return false;
@@ -821,10 +1383,15 @@ PUBLIC STATIC bool    ScriptManager::LoadObjectClass(const char* objectName, boo
         Uint32 filenameHash = (*filenameHashList)[fn];
 
         if (!Sources->Exists(filenameHash)) {
-            BytecodeContainer bytecode = ScriptManager::GetBytecodeFromFilenameHash(filenameHash);
-            if (!bytecode.Data) {
-                Log::Print(Log::LOG_WARN, "Code for the object class \"%s\" does not exist!", objectName);
-                return false;
+            bool bundled = BytecodeBundle::HasModule(filenameHash);
+
+            BytecodeContainer bytecode;
+            if (!bundled) {
+                bytecode = ScriptManager::GetBytecodeFromFilenameHash(filenameHash);
+                if (!bytecode.Data) {
+                    Log::Print(Log::LOG_WARN, "Code for the object class \"%s\" does not exist!", objectName);
+                    return false;
+                }
             }
 
             if (fn == 0) {
@@ -833,7 +1400,10 @@ PUBLIC STATIC bool    ScriptManager::LoadObjectClass(const char* objectName, boo
                     (int)filenameHashList->size());
             }
 
-            RunBytecode(bytecode, filenameHash);
+            if (bundled)
+                RunBundledBytecode(filenameHash);
+            else
+                RunBytecode(bytecode, filenameHash);
         }
     }
 
@@ -899,6 +1469,11 @@ PUBLIC STATIC void    ScriptManager::LoadClasses() {
         for (size_t fn = 0; fn < filenameHashList->size(); fn++) {
             Uint32 filenameHash = (*filenameHashList)[fn];
 
+            if (BytecodeBundle::HasModule(filenameHash)) {
+                RunBundledBytecode(filenameHash);
+                continue;
+            }
+
             BytecodeContainer bytecode = ScriptManager::GetBytecodeFromFilenameHash(filenameHash);
             if (!bytecode.Data) {
                 Log::Print(Log::LOG_WARN, "Class %08X does not exist!", filenameHash);
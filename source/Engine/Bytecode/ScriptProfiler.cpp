@@ -0,0 +1,262 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+#include <Engine/Includes/StandardSDL2.h>
+#include <Engine/Bytecode/Types.h>
+
+class ScriptProfiler {
+public:
+    enum {
+        MAX_DEPTH = 64,
+        MAX_SAMPLES = 1000000
+    };
+
+    static SDL_Thread*   Thread;
+    static SDL_mutex*    Lock;
+    static volatile bool Running;
+    static int           Interval;
+    static double        StartTime;
+};
+#endif
+
+#include <Engine/Bytecode/ScriptProfiler.h>
+#include <Engine/Bytecode/ScriptManager.h>
+#include <Engine/Diagnostics/Clock.h>
+#include <Engine/Diagnostics/Log.h>
+#include <Engine/IO/FileStream.h>
+
+SDL_Thread*   ScriptProfiler::Thread = NULL;
+SDL_mutex*    ScriptProfiler::Lock = NULL;
+volatile bool ScriptProfiler::Running = false;
+int           ScriptProfiler::Interval = 1;
+double        ScriptProfiler::StartTime = 0.0;
+
+// A sample holds the call stack of one script thread, outermost call
+// first, as indices into Frames.
+struct ProfilerFrame {
+    ObjFunction* Function;
+    Uint32       Offset;
+};
+struct ProfilerSample {
+    double Time;
+    Uint32 ThreadID;
+    Uint32 FrameStart;
+    Uint32 FrameCount;
+};
+
+static vector<ProfilerFrame>  Frames;
+static vector<ProfilerSample> Samples;
+
+// The script threads aren't stopped while their stacks are read. A frame
+// that's being pushed or popped at that moment can make for one bad
+// sample; TakeSample drops frames whose offset doesn't fit their function.
+static void TakeSample(VMThread* thread, double time) {
+    Uint32 frameCount = *(volatile Uint32*)&thread->FrameCount;
+    if (frameCount == 0 || frameCount > FRAMES_MAX)
+        return;
+    if (frameCount > ScriptProfiler::MAX_DEPTH)
+        frameCount = ScriptProfiler::MAX_DEPTH;
+
+    ProfilerSample sample;
+    sample.Time = time;
+    sample.ThreadID = thread->ID;
+    sample.FrameStart = (Uint32)Frames.size();
+    sample.FrameCount = 0;
+
+    for (Uint32 i = 0; i < frameCount; i++) {
+        CallFrame* callFrame = &thread->Frames[i];
+        ProfilerFrame frame;
+        frame.Function = *(ObjFunction* volatile*)&callFrame->Function;
+        Uint8* ipStart = *(Uint8* volatile*)&callFrame->IPStart;
+        Uint8* ipLast = *(Uint8* volatile*)&callFrame->IPLast;
+        if (!frame.Function || ipLast < ipStart || ipLast - ipStart >= frame.Function->Chunk.Count)
+            break;
+
+        frame.Offset = (Uint32)(ipLast - ipStart);
+        Frames.push_back(frame);
+        sample.FrameCount++;
+    }
+
+    if (sample.FrameCount)
+        Samples.push_back(sample);
+}
+static int  SamplerMain(void* data) {
+    while (ScriptProfiler::Running) {
+        SDL_Delay(ScriptProfiler::Interval);
+
+        double time = Clock::GetTicks();
+        SDL_LockMutex(ScriptProfiler::Lock);
+        if (Samples.size() < ScriptProfiler::MAX_SAMPLES) {
+            for (Uint32 i = 0; i < sizeof(ScriptManager::Threads) / sizeof(VMThread); i++)
+                TakeSample(&ScriptManager::Threads[i], time);
+        }
+        SDL_UnlockMutex(ScriptProfiler::Lock);
+    }
+    return 0;
+}
+
+static std::string GetFrameName(ObjFunction* function) {
+    std::string name;
+    if (function->ClassName) {
+        name += function->ClassName->Chars;
+        name += "::";
+    }
+    name += function->Name ? function->Name->Chars : "<anonymous-fn>";
+    return name;
+}
+static std::string GetFrameSource(ProfilerFrame* frame) {
+    ObjFunction* function = frame->Function;
+    int line = function->Chunk.Lines ? function->Chunk.Lines[frame->Offset] & 0xFFFF : 0;
+
+    std::string source = function->Module && function->Module->SourceFilename
+        ? function->Module->SourceFilename->Chars
+        : "?";
+    return source + ":" + std::to_string(line);
+}
+static bool        WriteFile(const char* filename, std::string& text) {
+    FileStream* stream = FileStream::New(filename, FileStream::WRITE_ACCESS);
+    if (!stream) {
+        Log::Print(Log::LOG_ERROR, "Could not open \"%s\" for writing!", filename);
+        return false;
+    }
+    stream->WriteBytes((void*)text.data(), text.size());
+    stream->Close();
+    return true;
+}
+
+// Interval is how many milliseconds to wait between samples.
+PUBLIC STATIC bool ScriptProfiler::Start(int interval) {
+    if (Running)
+        return true;
+
+    if (!Lock)
+        Lock = SDL_CreateMutex();
+
+    Reset();
+    Interval = interval > 0 ? interval : 1;
+    StartTime = Clock::GetTicks();
+    Running = true;
+
+    Thread = SDL_CreateThread(SamplerMain, "Script Profiler", NULL);
+    if (!Thread) {
+        Log::Print(Log::LOG_ERROR, "Could not create profiler thread: %s", SDL_GetError());
+        Running = false;
+        return false;
+    }
+
+    Log::Print(Log::LOG_INFO, "Started script profiler (sampling every %d ms).", Interval);
+    return true;
+}
+PUBLIC STATIC void ScriptProfiler::Stop() {
+    if (!Running)
+        return;
+
+    Running = false;
+    SDL_WaitThread(Thread, NULL);
+    Thread = NULL;
+
+    Log::Print(Log::LOG_INFO, "Stopped script profiler with %u samples.", (Uint32)Samples.size());
+}
+PUBLIC STATIC bool ScriptProfiler::IsRunning() {
+    return Running;
+}
+PUBLIC STATIC void ScriptProfiler::Reset() {
+    if (Lock)
+        SDL_LockMutex(Lock);
+    Frames.clear();
+    Samples.clear();
+    if (Lock)
+        SDL_UnlockMutex(Lock);
+}
+
+// Writes one line per distinct stack, with the number of samples it was
+// seen in, as read by flamegraph.pl, speedscope and similar tools.
+PUBLIC STATIC bool ScriptProfiler::WriteCollapsedStacks(const char* filename) {
+    std::map<std::string, Uint32> stacks;
+
+    if (Lock)
+        SDL_LockMutex(Lock);
+    for (size_t s = 0; s < Samples.size(); s++) {
+        ProfilerSample& sample = Samples[s];
+
+        std::string stack = "Thread " + std::to_string(sample.ThreadID);
+        for (Uint32 i = 0; i < sample.FrameCount; i++) {
+            ProfilerFrame* frame = &Frames[sample.FrameStart + i];
+            stack += ";" + GetFrameName(frame->Function) + " (" + GetFrameSource(frame) + ")";
+        }
+        stacks[stack]++;
+    }
+    if (Lock)
+        SDL_UnlockMutex(Lock);
+
+    std::string text;
+    for (std::map<std::string, Uint32>::iterator it = stacks.begin(); it != stacks.end(); it++)
+        text += it->first + " " + std::to_string(it->second) + "\n";
+
+    return WriteFile(filename, text);
+}
+// Writes the samples as begin and end events of each function call in the
+// Trace Event format, as read by chrome://tracing and Perfetto.
+PUBLIC STATIC bool ScriptProfiler::WriteChromeTrace(const char* filename) {
+    std::string text = "{\"traceEvents\":[\n";
+    bool first = true;
+
+    if (Lock)
+        SDL_LockMutex(Lock);
+
+    // The open calls of each thread, as of its last sample
+    std::map<Uint32, vector<ObjFunction*> > open;
+    double endTime = StartTime;
+    char event[512];
+
+    #define ADD_EVENT(phase, function, time, tid) \
+        snprintf(event, sizeof(event), "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.0f,\"pid\":0,\"tid\":%u}", \
+            first ? "" : ",\n", GetFrameName(function).c_str(), phase, ((time) - StartTime) * 1000.0, tid); \
+        text += event; \
+        first = false
+
+    for (size_t s = 0; s < Samples.size(); s++) {
+        ProfilerSample& sample = Samples[s];
+        vector<ObjFunction*>& stack = open[sample.ThreadID];
+
+        // Keep whatever this sample has in common with the last one
+        Uint32 same = 0;
+        while (same < stack.size() && same < sample.FrameCount
+            && stack[same] == Frames[sample.FrameStart + same].Function)
+            same++;
+
+        while (stack.size() > same) {
+            ADD_EVENT('E', stack.back(), sample.Time, sample.ThreadID);
+            stack.pop_back();
+        }
+        for (Uint32 i = same; i < sample.FrameCount; i++) {
+            ObjFunction* function = Frames[sample.FrameStart + i].Function;
+            ADD_EVENT('B', function, sample.Time, sample.ThreadID);
+            stack.push_back(function);
+        }
+
+        endTime = sample.Time;
+    }
+
+    for (std::map<Uint32, vector<ObjFunction*> >::iterator it = open.begin(); it != open.end(); it++) {
+        while (it->second.size()) {
+            ADD_EVENT('E', it->second.back(), endTime, it->first);
+            it->second.pop_back();
+        }
+    }
+
+    #undef ADD_EVENT
+
+    if (Lock)
+        SDL_UnlockMutex(Lock);
+
+    text += "\n]}\n";
+    return WriteFile(filename, text);
+}
+
+PUBLIC STATIC void ScriptProfiler::Dispose() {
+    Stop();
+    Reset();
+    if (Lock)
+        SDL_DestroyMutex(Lock);
+    Lock = NULL;
+}
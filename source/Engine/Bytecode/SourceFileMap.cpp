@@ -15,6 +15,7 @@ public:
 
 #include <Engine/Bytecode/SourceFileMap.h>
 
+#include <Engine/Bytecode/BytecodeBundle.h>
 #include <Engine/Bytecode/ScriptManager.h>
 #include <Engine/Bytecode/Compiler.h>
 #include <Engine/Diagnostics/Log.h>
@@ -24,6 +25,7 @@ public:
 #include <Engine/Filesystem/File.h>
 #include <Engine/Hashing/FNV1A.h>
 #include <Engine/ResourceTypes/ResourceManager.h>
+#include <Engine/Utilities/JobSystem.h>
 
 bool                      SourceFileMap::Initialized = false;
 HashMap<Uint32>*          SourceFileMap::Checksums = NULL;
@@ -33,6 +35,121 @@ Uint32                    SourceFileMap::Magic = *(Uint32*)"HMAP";
 
 bool                      SourceFileMap::DoLogging = false;
 
+struct CompileJob {
+    char*          Path;
+    const char*    Filename;
+    char*          Source;
+    char           OutputFile[35];
+    Uint32         FilenameHash;
+    vector<Uint32> ClassHashList;
+    vector<Uint32> ClassExtendedList;
+    char*          Error;
+};
+
+// How many of the queued files have been compiled so far
+static SDL_atomic_t       CompiledCount;
+static int                CompileTotal;
+
+static void CompileFile(void* data, int worker) {
+    CompileJob* job = (CompileJob*)data;
+
+    Compiler::DeferFatalErrors = true;
+    Compiler::PrepareCompiling();
+
+    Compiler* compiler = new Compiler;
+    compiler->Compile(job->Filename, job->Source, job->OutputFile);
+
+    job->ClassHashList = compiler->ClassHashList;
+    job->ClassExtendedList = compiler->ClassExtendedList;
+
+    delete compiler;
+    Compiler::FinishCompiling();
+
+    job->Error = Compiler::FatalError;
+    Compiler::FatalError = NULL;
+    Compiler::DeferFatalErrors = false;
+
+    SDL_AtomicIncRef(&CompiledCount);
+}
+static bool IsCompilingDone(void* data) {
+    return SDL_AtomicGet(&CompiledCount) == CompileTotal;
+}
+
+static void CompileScripts(vector<CompileJob*>& jobs) {
+    if (jobs.size() == 0)
+        return;
+
+    // Files don't depend on each other at compile time (imports are
+    // resolved when the bytecode is loaded), so they can all be compiled
+    // at once. The memory tracker isn't thread-safe, though.
+    bool parallel = jobs.size() > 1 && JobSystem::GetWorkerCount() > 0 && !Memory::IsTracking;
+
+    SDL_AtomicSet(&CompiledCount, 0);
+    CompileTotal = (int)jobs.size();
+
+    if (parallel) {
+        ScriptManager::EnableLocking();
+
+        for (size_t i = 0; i < jobs.size(); i++) {
+            // If the queue is full, this thread helps out instead.
+            if (!JobSystem::Submit(CompileFile, jobs[i]))
+                CompileFile(jobs[i], -1);
+        }
+
+        JobSystem::WaitUntil(IsCompilingDone, NULL);
+
+        ScriptManager::CheckLocking();
+    }
+    else {
+        for (size_t i = 0; i < jobs.size(); i++)
+            CompileFile(jobs[i], -1);
+    }
+
+    // Merge the results in file order, so the class map comes out the
+    // same no matter which file finished first.
+    char* error = NULL;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        CompileJob* job = jobs[i];
+        Uint32 filenameHash = job->FilenameHash;
+
+        // Add this file to the list
+        for (size_t h = 0; h < job->ClassHashList.size(); h++) {
+            Uint32 classHash = job->ClassHashList[h];
+            Uint32 classExtended = job->ClassExtendedList[h];
+            if (SourceFileMap::ClassMap->Exists(classHash)) {
+                vector<Uint32>* filenameHashList = SourceFileMap::ClassMap->Get(classHash);
+                if (std::count(filenameHashList->begin(), filenameHashList->end(), filenameHash) == 0) {
+                    // NOTE: We need a better way of sorting
+                    if (classExtended == 0)
+                        filenameHashList->insert(filenameHashList->begin(), filenameHash);
+                    else if (classExtended == 1)
+                        filenameHashList->push_back(filenameHash);
+                }
+            }
+            else {
+                vector<Uint32>* filenameHashList = new vector<Uint32>();
+                filenameHashList->push_back(filenameHash);
+                SourceFileMap::ClassMap->Put(classHash, filenameHashList);
+            }
+        }
+
+        if (job->Error) {
+            if (!error)
+                error = job->Error;
+            else
+                free(job->Error);
+        }
+
+        Memory::Free(job->Source);
+        Memory::Free(job->Path);
+        delete job;
+    }
+    jobs.clear();
+
+    if (error)
+        Compiler::ShowFatalError(error);
+}
+
 PUBLIC STATIC void SourceFileMap::CheckInit() {
     if (SourceFileMap::Initialized) return;
 
@@ -97,6 +214,7 @@ PUBLIC STATIC void SourceFileMap::CheckInit() {
 
     Application::Settings->GetBool("compiler", "writeDebugInfo", &Compiler::WriteDebugInfo);
     Application::Settings->GetBool("compiler", "writeSourceFilename", &Compiler::WriteSourceFilename);
+    Application::Settings->GetBool("compiler", "optimizations", &Compiler::DoOptimizations);
 
     SourceFileMap::Initialized = true;
 }
@@ -153,6 +271,8 @@ PUBLIC STATIC void SourceFileMap::CheckForUpdate() {
     const char* scriptFolderPath = scriptFolderPathStr.c_str();
     size_t scriptFolderPathLen = strlen(scriptFolderPath);
 
+    vector<CompileJob*> jobs;
+
     for (size_t i = 0; i < list.size(); i++) {
         char* filename = strrchr(list[i], '/');
         Uint32 filenameHash = 0;
@@ -184,12 +304,19 @@ PUBLIC STATIC void SourceFileMap::CheckForUpdate() {
 
         // If changed, then compile.
         if (doRecompile || !File::Exists(outFile)) {
-            Compiler::PrepareCompiling();
-
             char* scriptFilename = list[i];
             if (StringUtils::StartsWith(scriptFilename, scriptFolderPath))
                 scriptFilename += scriptFolderPathLen;
 
+            CompileJob* job = new CompileJob;
+            job->Path = list[i];
+            job->Filename = scriptFilename;
+            job->Source = source;
+            memcpy(job->OutputFile, outFile, sizeof outFile);
+            job->FilenameHash = filenameHash;
+            job->Error = NULL;
+            jobs.push_back(job);
+
             if (SourceFileMap::DoLogging) {
                 if (doRecompile)
                     Log::Print(Log::LOG_VERBOSE, "Recompiling %s...", scriptFilename);
@@ -197,43 +324,23 @@ PUBLIC STATIC void SourceFileMap::CheckForUpdate() {
                     Log::Print(Log::LOG_VERBOSE, "Compiling %s...", scriptFilename);
             }
 
-            Compiler* compiler = new Compiler;
-            compiler->Compile(scriptFilename, source, outFile);
-
-            // Add this file to the list
-            // Log::Print(Log::LOG_INFO, "filename: %s (0x%08X)", filename, filenameHash);
-            for (size_t h = 0; h < compiler->ClassHashList.size(); h++) {
-                Uint32 classHash = compiler->ClassHashList[h];
-                Uint32 classExtended = compiler->ClassExtendedList[h];
-                if (SourceFileMap::ClassMap->Exists(classHash)) {
-                    vector<Uint32>* filenameHashList = SourceFileMap::ClassMap->Get(classHash);
-                    if (std::count(filenameHashList->begin(), filenameHashList->end(), filenameHash) == 0) {
-                        // NOTE: We need a better way of sorting
-                        if (classExtended == 0)
-                            filenameHashList->insert(filenameHashList->begin(), filenameHash);
-                        else if (classExtended == 1)
-                            filenameHashList->push_back(filenameHash);
-                    }
-                }
-                else {
-                    vector<Uint32>* filenameHashList = new vector<Uint32>();
-                    filenameHashList->push_back(filenameHash);
-                    SourceFileMap::ClassMap->Put(classHash, filenameHashList);
-                }
-            }
-
-            delete compiler;
-            Compiler::FinishCompiling();
+            // The job owns these now
+            source = NULL;
+            list[i] = NULL;
         }
 
-        Memory::Free(source);
+        if (source)
+            Memory::Free(source);
 
         // Log::Print(Log::LOG_INFO, "List: %s (%08X) (old: %08X, new: %08X) %d", list[i], filenameHash, oldChecksum, newChecksum, false);
 
         SourceFileMap::Checksums->Put(filenameHash, newChecksum);
-        Memory::Free(list[i]);
+        if (list[i])
+            Memory::Free(list[i]);
     }
 
+    CompileScripts(jobs);
+
     if (anyChanges) {
         FileStream* stream;
         // SourceFileMap.bin
@@ -270,6 +377,18 @@ PUBLIC STATIC void SourceFileMap::CheckForUpdate() {
         }
     }
 
+    // Objects.hbc
+    if (anyChanges || !File::Exists("Resources/Objects/Objects.hbc")) {
+        vector<Uint32> filenameHashes;
+        SourceFileMap::Checksums->WithAll([&filenameHashes](Uint32 hash, Uint32) -> void {
+            filenameHashes.push_back(hash);
+        });
+
+        // Don't keep reading from the old one
+        BytecodeBundle::Close();
+        BytecodeBundle::Write("Resources/Objects/Objects.hbc", filenameHashes);
+    }
+
     list.clear();
     list.shrink_to_fit();
 
@@ -17,8 +17,12 @@ public:
 #include <Engine/Audio/AudioManager.h>
 #include <Engine/Bytecode/ScriptEntity.h>
 #include <Engine/Bytecode/ScriptManager.h>
+#include <Engine/Bytecode/ScriptProfiler.h>
 #include <Engine/Bytecode/Compiler.h>
+#include <Engine/Bytecode/GarbageCollector.h>
+#include <Engine/Bytecode/NativeBinding.h>
 #include <Engine/Bytecode/Values.h>
+#include <Engine/Bytecode/TypeImpl/TypedArrayImpl.h>
 #include <Engine/Diagnostics/Clock.h>
 #include <Engine/Filesystem/File.h>
 #include <Engine/Filesystem/Directory.h>
@@ -47,7 +51,9 @@ public:
 #include <Engine/Scene/SceneEnums.h>
 #include <Engine/Scene/SceneInfo.h>
 #include <Engine/TextFormats/JSON/jsmn.h>
+#include <Engine/Types/EntityPool.h>
 #include <Engine/Utilities/ColorUtils.h>
+#include <Engine/Utilities/RadixSort.h>
 #include <Engine/Utilities/StringUtils.h>
 
 
@@ -79,7 +85,7 @@ public:
 namespace LOCAL {
     inline int             GetInteger(VMValue* args, int index, Uint32 threadID) {
         int value = 0;
-        switch (args[index].Type) {
+        switch (VALUE_TYPE(args[index])) {
             case VAL_INTEGER:
             case VAL_LINKED_INTEGER:
                 value = AS_INTEGER(args[index]);
@@ -93,7 +99,7 @@ namespace LOCAL {
     }
     inline float           GetDecimal(VMValue* args, int index, Uint32 threadID) {
         float value = 0.0f;
-        switch (args[index].Type) {
+        switch (VALUE_TYPE(args[index])) {
             case VAL_DECIMAL:
             case VAL_LINKED_DECIMAL:
                 value = AS_DECIMAL(args[index]);
@@ -112,6 +118,12 @@ namespace LOCAL {
     inline char*           GetString(VMValue* args, int index, Uint32 threadID) {
         char* value = NULL;
         if (ScriptManager::Lock()) {
+            // A builder's text can be read in place
+            if (IS_STRING_BUILDER(args[index])) {
+                value = AS_STRING_BUILDER(args[index])->Chars;
+                ScriptManager::Unlock();
+                return value;
+            }
             if (!IS_STRING(args[index])) {
                 if (THROW_ERROR(
                     "Expected argument %d to be of type %s instead of %s.", index + 1, GetObjectTypeString(OBJ_STRING), GetValueTypeString(args[index])) == ERROR_RES_CONTINUE) {
@@ -130,6 +142,13 @@ namespace LOCAL {
         }
         return value;
     }
+    // The length of an argument already read with GetString, which may be
+    // a string or a string builder
+    inline size_t          GetStringLength(VMValue* args, int index) {
+        if (IS_STRING_BUILDER(args[index]))
+            return AS_STRING_BUILDER(args[index])->Length;
+        return AS_STRING(args[index])->Length;
+    }
     inline ObjArray*       GetArray(VMValue* args, int index, Uint32 threadID) {
         ObjArray* value = NULL;
         if (ScriptManager::Lock()) {
@@ -239,6 +258,42 @@ namespace LOCAL {
         }
         return value;
     }
+    inline ObjStringBuilder* GetStringBuilder(VMValue* args, int index, Uint32 threadID) {
+        ObjStringBuilder* value = NULL;
+        if (ScriptManager::Lock()) {
+            if (!IS_STRING_BUILDER(args[index]))
+                if (THROW_ERROR(
+                    "Expected argument %d to be of type %s instead of %s.", index + 1, GetObjectTypeString(OBJ_STRING_BUILDER), GetValueTypeString(args[index])) == ERROR_RES_CONTINUE)
+                    ScriptManager::Threads[threadID].ReturnFromNative();
+
+            value = (ObjStringBuilder*)(AS_OBJECT(args[index]));
+            ScriptManager::Unlock();
+        }
+        if (!value) {
+            if (THROW_ERROR("Argument %d could not be read as type %s.", index + 1,
+                "String Builder"))
+                ScriptManager::Threads[threadID].ReturnFromNative();
+        }
+        return value;
+    }
+    inline ObjTypedArray* GetTypedArray(VMValue* args, int index, Uint32 threadID) {
+        ObjTypedArray* value = NULL;
+        if (ScriptManager::Lock()) {
+            if (!IS_TYPED_ARRAY(args[index]))
+                if (THROW_ERROR(
+                    "Expected argument %d to be of type %s instead of %s.", index + 1, GetObjectTypeString(OBJ_TYPED_ARRAY), GetValueTypeString(args[index])) == ERROR_RES_CONTINUE)
+                    ScriptManager::Threads[threadID].ReturnFromNative();
+
+            value = (ObjTypedArray*)(AS_OBJECT(args[index]));
+            ScriptManager::Unlock();
+        }
+        if (!value) {
+            if (THROW_ERROR("Argument %d could not be read as type %s.", index + 1,
+                "Typed Array"))
+                ScriptManager::Threads[threadID].ReturnFromNative();
+        }
+        return value;
+    }
 
     inline ISprite*        GetSpriteIndex(int where, Uint32 threadID) {
         if (where < 0 || where >= (int)Scene::SpriteList.size()) {
@@ -360,6 +415,10 @@ namespace LOCAL {
 // NOTE:
 // Integers specifically need to be whole integers.
 // Floats can be just any countable real number.
+PUBLIC STATIC VMValue      StandardLibrary::ArgCountError(int expects, int argCount, Uint32 threadID) {
+    THROW_ERROR("Expected %d arguments but got %d.", expects, argCount);
+    return NULL_VAL;
+}
 PUBLIC STATIC int          StandardLibrary::GetInteger(VMValue* args, int index, Uint32 threadID) {
     return LOCAL::GetInteger(args, index, threadID);
 }
@@ -375,6 +434,9 @@ PUBLIC STATIC ObjArray*    StandardLibrary::GetArray(VMValue* args, int index, U
 PUBLIC STATIC ObjMap*      StandardLibrary::GetMap(VMValue* args, int index, Uint32 threadID) {
     return LOCAL::GetMap(args, index, threadID);
 }
+PUBLIC STATIC ObjTypedArray* StandardLibrary::GetTypedArray(VMValue* args, int index, Uint32 threadID) {
+    return LOCAL::GetTypedArray(args, index, threadID);
+}
 PUBLIC STATIC ISprite*     StandardLibrary::GetSprite(VMValue* args, int index, Uint32 threadID) {
     return LOCAL::GetSprite(args, index, threadID);
 }
@@ -1414,11 +1476,53 @@ VMValue Array_Reverse(int argCount, VMValue* args, Uint32 threadID) {
     }
     return NULL_VAL;
 }
+// Puts the entries that have a key first, ordered by it, followed by the
+// ones that don't, in their original order.
+static void Array_SortByKeys(ObjArray* array, vector<VMValue>& entries, vector<Uint32>& keys, vector<Uint32>& indices) {
+    size_t count = keys.size();
+    vector<Uint32> tempKeys(count);
+    vector<Uint32> tempIndices(count);
+    RadixSort::Sort(keys.data(), indices.data(), tempKeys.data(), tempIndices.data(), count);
+
+    vector<bool> placed(entries.size(), false);
+    array->Values->clear();
+    for (size_t i = 0; i < count; i++) {
+        array->Values->push_back(entries[indices[i]]);
+        placed[indices[i]] = true;
+    }
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (!placed[i])
+            array->Values->push_back(entries[i]);
+    }
+}
+static bool Array_IsNumeric(ObjArray* array) {
+    for (size_t i = 0; i < array->Values->size(); i++) {
+        VMValue value = (*array->Values)[i];
+        if (!IS_INTEGER(value) && !IS_DECIMAL(value))
+            return false;
+    }
+    return true;
+}
+static VMValue Array_GetFieldKey(VMValue value, Uint32 hash) {
+    VMValue result = NULL_VAL;
+    if (IS_INSTANCE(value)) {
+        ObjInstance* instance = AS_INSTANCE(value);
+        NativeField native;
+        if (instance->Fields->GetIfExists(hash, &result))
+            return ScriptManager::DelinkValue(result);
+        if (instance->NativeFields && instance->NativeFields->GetIfExists(hash, &native))
+            return ScriptManager::DelinkValue(NATIVE_FIELD_VAL(instance->EntityPtr, native));
+    }
+    else if (IS_MAP(value))
+        AS_MAP(value)->Values->GetIfExists(hash, &result);
+    return result;
+}
+
 /***
  * Array.Sort
  * \desc Sorts the entries of the given array.
  * \param array (Array): Array to sort.
- * \paramOpt compFunction (Function): Comparison function. If not given, a default comparison function is used; the entries of the array are sorted in ascending order, and non-numeric values do not participate in the comparison.
+ * \paramOpt compFunction (Function): Comparison function. If not given, a default comparison function is used; the entries of the array are sorted in ascending order, and non-numeric values do not participate in the comparison. Arrays of only numbers are then sorted natively. To sort many entries by a value they hold, <linkto ref="Array.SortBy"></linkto> is much faster than a comparison function.
  * \ns Array
  */
 VMValue Array_Sort(int argCount, VMValue* args, Uint32 threadID) {
@@ -1443,6 +1547,23 @@ VMValue Array_Sort(int argCount, VMValue* args, Uint32 threadID) {
 
                 return false;
             });
+        } else if (Array_IsNumeric(array)) {
+            // Nothing to call back into, so this can be a radix sort
+            vector<VMValue> entries(*array->Values);
+            vector<Uint32> keys(entries.size());
+            vector<Uint32> indices(entries.size());
+            bool anyDecimal = false;
+            for (size_t i = 0; i < entries.size(); i++) {
+                if (IS_DECIMAL(entries[i]))
+                    anyDecimal = true;
+            }
+            for (size_t i = 0; i < entries.size(); i++) {
+                keys[i] = anyDecimal
+                    ? RadixSort::DecimalKey(AS_DECIMAL(ScriptManager::CastValueAsDecimal(entries[i])))
+                    : RadixSort::IntegerKey(AS_INTEGER(entries[i]));
+                indices[i] = (Uint32)i;
+            }
+            Array_SortByKeys(array, entries, keys, indices);
         } else {
             std::stable_sort(array->Values->begin(), array->Values->end(), [array](const VMValue& a, const VMValue& b) {
                 if (IS_NOT_NUMBER(a) || IS_NOT_NUMBER(b)) {
@@ -1461,6 +1582,70 @@ VMValue Array_Sort(int argCount, VMValue* args, Uint32 threadID) {
     }
     return NULL_VAL;
 }
+/***
+ * Array.SortBy
+ * \desc Sorts the entries of an array by a numeric key. The key of each entry is found only once, and the entries are then sorted natively, so this is much faster than <linkto ref="Array.Sort"></linkto> with a comparison function. Entries with equal keys keep their order, and entries without a numeric key are moved to the end.
+ * \param array (Array): Array to sort.
+ * \param key (Value): Either the name of the field to sort instances or maps by (String), or a function that takes an entry and returns its key.
+ * \paramOpt descending (Boolean): Whether to sort from largest to smallest key. Default: false.
+ * \ns Array
+ */
+VMValue Array_SortBy(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_AT_LEAST_ARGCOUNT(2);
+    if (ScriptManager::Lock()) {
+        ObjArray* array = GET_ARG(0, GetArray);
+        ObjFunction* function = NULL;
+        Uint32 fieldHash = 0;
+        if (IS_STRING(args[1])) {
+            ObjString* name = AS_STRING(args[1]);
+            fieldHash = Murmur::EncryptData(name->Chars, name->Length);
+        }
+        else
+            function = GET_ARG(1, GetFunction);
+        bool descending = !!GET_ARG_OPT(2, GetInteger, false);
+
+        // A key function may change the array, so work on a copy of it
+        vector<VMValue> entries(*array->Values);
+        vector<VMValue> keyValues;
+        vector<Uint32> indices;
+        keyValues.reserve(entries.size());
+        indices.reserve(entries.size());
+
+        VMThread* thread = &ScriptManager::Threads[threadID];
+        bool anyDecimal = false;
+        for (size_t i = 0; i < entries.size(); i++) {
+            VMValue key = NULL_VAL;
+            if (function) {
+                thread->Push(entries[i]);
+                key = thread->RunEntityFunction(function, 1);
+                thread->Pop(1);
+            }
+            else
+                key = Array_GetFieldKey(entries[i], fieldHash);
+
+            if (!IS_INTEGER(key) && !IS_DECIMAL(key))
+                continue;
+            if (IS_DECIMAL(key))
+                anyDecimal = true;
+
+            keyValues.push_back(key);
+            indices.push_back((Uint32)i);
+        }
+
+        vector<Uint32> keys(keyValues.size());
+        for (size_t i = 0; i < keyValues.size(); i++) {
+            keys[i] = anyDecimal
+                ? RadixSort::DecimalKey(AS_DECIMAL(ScriptManager::CastValueAsDecimal(keyValues[i])))
+                : RadixSort::IntegerKey(AS_INTEGER(keyValues[i]));
+            if (descending)
+                keys[i] = ~keys[i];
+        }
+
+        Array_SortByKeys(array, entries, keys, indices);
+        ScriptManager::Unlock();
+    }
+    return NULL_VAL;
+}
 // #endregion
 
 // #region Controller
@@ -5171,10 +5356,9 @@ VMValue File_ReadAllText(int argCount, VMValue* args, Uint32 threadID) {
 VMValue File_WriteAllText(int argCount, VMValue* args, Uint32 threadID) {
     CHECK_ARGCOUNT(2);
     char* filePath = GET_ARG(0, GetString);
-    // To verify 2nd argument is string
-    GET_ARG(1, GetString);
+    char* text = GET_ARG(1, GetString);
     if (ScriptManager::Lock()) {
-        ObjString* text = AS_STRING(args[1]);
+        size_t textLength = GetStringLength(args, 1);
 
         Stream* stream = NULL;
         if (strncmp(filePath, "save://", 7) == 0)
@@ -5186,7 +5370,7 @@ VMValue File_WriteAllText(int argCount, VMValue* args, Uint32 threadID) {
             return INTEGER_VAL(false);
         }
 
-        stream->WriteBytes(text->Chars, text->Length);
+        stream->WriteBytes(text, textLength);
         stream->Close();
 
         ScriptManager::Unlock();
@@ -5960,6 +6144,84 @@ VMValue Instance_GetBySlotID(int argCount, VMValue* args, Uint32 threadID) {
 
     return NULL_VAL;
 }
+/***
+ * Instance.GetHandle
+ * \desc Gets a handle to an instance, which can be stored in place of the instance and turned back into it with <linkto ref="Instance.GetByHandle"></linkto>. Unlike the instance, a handle doesn't keep it from being deleted.
+ * \param instance (Instance): The instance.
+ * \return Returns an Integer value, or <code>0</code> if the instance has no handle.
+ * \ns Instance
+ */
+VMValue Instance_GetHandle(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+
+    ObjInstance* instance = GET_ARG(0, GetInstance);
+    Entity* self = (Entity*)instance->EntityPtr;
+    if (!self)
+        return INTEGER_VAL(0);
+
+    return INTEGER_VAL((int)EntityPool::GetHandle(self));
+}
+/***
+ * Instance.GetByHandle
+ * \desc Gets the instance a handle was made for.
+ * \param handle (Integer): A handle from <linkto ref="Instance.GetHandle"></linkto>.
+ * \return Returns the instance, or <code>null</code> if it has since been deleted or removed from the scene.
+ * \ns Instance
+ */
+VMValue Instance_GetByHandle(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+
+    Entity* ent = EntityPool::Get((Uint32)GET_ARG(0, GetInteger));
+    if (!ent || ent->Removed)
+        return NULL_VAL;
+
+    return OBJECT_VAL(((ScriptEntity*)ent)->Instance);
+}
+static ObjArray* Instance_ToArray(vector<Entity*>& entities, Entity* exclude, ObjectList* objectList) {
+    ObjArray* array = NewArray();
+    for (size_t i = 0; i < entities.size(); i++) {
+        Entity* ent = entities[i];
+        if (ent == exclude || (objectList && ent->List != objectList))
+            continue;
+        array->Values->push_back(OBJECT_VAL(((ScriptEntity*)ent)->Instance));
+    }
+    return array;
+}
+/***
+ * Instance.GetOverlapping
+ * \desc Gets every instance whose hitbox touches the hitbox of an instance, without looping through every instance in the scene.
+ * \param instance (Instance): The instance to check.
+ * \paramOpt className (String): Only get instances of this object class.
+ * \return Returns an Array of instances.
+ * \ns Instance
+ */
+VMValue Instance_GetOverlapping(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_AT_LEAST_ARGCOUNT(1);
+
+    ObjInstance* instance = GET_ARG(0, GetInstance);
+    char* objectName = GET_ARG_OPT(1, GetString, NULL);
+
+    Entity* self = (Entity*)instance->EntityPtr;
+    if (!self)
+        return OBJECT_VAL(NewArray());
+
+    ObjectList* objectList = NULL;
+    if (objectName) {
+        if (!Scene::ObjectLists->Exists(objectName))
+            return OBJECT_VAL(NewArray());
+        objectList = Scene::ObjectLists->Get(objectName);
+    }
+
+    float x = std::floor(self->X + self->Hitbox.OffsetX * ((self->FlipFlag & 1) ? -1.0 : 1.0));
+    float y = std::floor(self->Y + self->Hitbox.OffsetY * ((self->FlipFlag & 2) ? -1.0 : 1.0));
+    float hitboxW = self->Hitbox.Width * 0.5;
+    float hitboxH = self->Hitbox.Height * 0.5;
+
+    vector<Entity*> entities;
+    Scene::GetEntitiesInRegion(x - hitboxW, y - hitboxH, x + hitboxW, y + hitboxH, &entities);
+
+    return OBJECT_VAL(Instance_ToArray(entities, self, objectList));
+}
 /***
  * Instance.DisableAutoAnimate
  * \desc Disables the AutoAnimate function of entities.
@@ -6235,8 +6497,9 @@ static int JSON_FillArray(ObjArray* arr, const char* text, jsmntok_t* t, size_t
  */
 VMValue JSON_Parse(int argCount, VMValue* args, Uint32 threadID) {
     CHECK_ARGCOUNT(1);
+    char* text = GET_ARG(0, GetString);
     if (ScriptManager::Lock()) {
-        ObjString* string = AS_STRING(args[0]);
+        size_t     textLength = GetStringLength(args, 0);
         ObjMap*    map = NewMap();
 
         jsmn_parser p;
@@ -6244,12 +6507,13 @@ VMValue JSON_Parse(int argCount, VMValue* args, Uint32 threadID) {
         size_t tokcount = 16;
         tok = (jsmntok_t*)malloc(sizeof(*tok) * tokcount);
         if (tok == NULL) {
+            ScriptManager::Unlock();
             return NULL_VAL;
         }
 
         jsmn_init(&p);
         while (true) {
-            int r = jsmn_parse(&p, string->Chars, string->Length, tok, (Uint32)tokcount);
+            int r = jsmn_parse(&p, text, textLength, tok, (Uint32)tokcount);
             if (r < 0) {
                 if (r == JSMN_ERROR_NOMEM) {
                     tokcount = tokcount * 2;
@@ -6262,7 +6526,7 @@ VMValue JSON_Parse(int argCount, VMValue* args, Uint32 threadID) {
                 }
             }
             else {
-                JSON_FillMap(map, string->Chars, tok, p.toknext);
+                JSON_FillMap(map, text, tok, p.toknext);
             }
             break;
         }
@@ -6295,9 +6559,8 @@ VMValue JSON_ToString(int argCount, VMValue* args, Uint32 threadID) {
  * \return The cosine of x radians.
  * \ns Math
  */
-VMValue Math_Cos(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(Math::Cos(GET_ARG(0, GetDecimal)));
+float Math_Cos(float x) {
+    return Math::Cos(x);
 }
 /***
  * Math.Sin
@@ -6306,9 +6569,8 @@ VMValue Math_Cos(int argCount, VMValue* args, Uint32 threadID) {
  * \return The sine of x radians.
  * \ns Math
  */
-VMValue Math_Sin(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(Math::Sin(GET_ARG(0, GetDecimal)));
+float Math_Sin(float x) {
+    return Math::Sin(x);
 }
 /***
  * Math.Tan
@@ -6317,9 +6579,8 @@ VMValue Math_Sin(int argCount, VMValue* args, Uint32 threadID) {
  * \return The tangent of x radians.
  * \ns Math
  */
-VMValue Math_Tan(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(Math::Tan(GET_ARG(0, GetDecimal)));
+float Math_Tan(float x) {
+    return Math::Tan(x);
 }
 /***
  * Math.Acos
@@ -6328,9 +6589,8 @@ VMValue Math_Tan(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the angle (in radians) as a Decimal value.
  * \ns Math
  */
-VMValue Math_Acos(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(Math::Acos(GET_ARG(0, GetDecimal)));
+float Math_Acos(float x) {
+    return Math::Acos(x);
 }
 /***
  * Math.Asin
@@ -6339,9 +6599,8 @@ VMValue Math_Acos(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the angle (in radians) as a Decimal value.
  * \ns Math
  */
-VMValue Math_Asin(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(Math::Asin(GET_ARG(0, GetDecimal)));
+float Math_Asin(float x) {
+    return Math::Asin(x);
 }
 /***
  * Math.Atan
@@ -6351,9 +6610,8 @@ VMValue Math_Asin(int argCount, VMValue* args, Uint32 threadID) {
  * \return The angle from x and y.
  * \ns Math
  */
-VMValue Math_Atan(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(2);
-    return DECIMAL_VAL(Math::Atan(GET_ARG(0, GetDecimal), GET_ARG(1, GetDecimal)));
+float Math_Atan(float x, float y) {
+    return Math::Atan(x, y);
 }
 /***
  * Math.Distance
@@ -6365,9 +6623,8 @@ VMValue Math_Atan(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the distance from (x1,y1) to (x2,y2) as a Decimal value.
  * \ns Math
  */
-VMValue Math_Distance(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(4);
-    return DECIMAL_VAL(Math::Distance(GET_ARG(0, GetDecimal), GET_ARG(1, GetDecimal), GET_ARG(2, GetDecimal), GET_ARG(3, GetDecimal)));
+float Math_Distance(float x1, float y1, float x2, float y2) {
+    return Math::Distance(x1, y1, x2, y2);
 }
 /***
  * Math.Direction
@@ -6379,9 +6636,8 @@ VMValue Math_Distance(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the angle from (x1,y1) to (x2,y2) as a Decimal value.
  * \ns Math
  */
-VMValue Math_Direction(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(4);
-    return DECIMAL_VAL(Math::Atan(GET_ARG(2, GetDecimal) - GET_ARG(0, GetDecimal), GET_ARG(1, GetDecimal) - GET_ARG(3, GetDecimal)));
+float Math_Direction(float x1, float y1, float x2, float y2) {
+    return Math::Atan(x2 - x1, y1 - y2);
 }
 /***
  * Math.Abs
@@ -6390,9 +6646,8 @@ VMValue Math_Direction(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the absolute value of n.
  * \ns Math
  */
-VMValue Math_Abs(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(Math::Abs(GET_ARG(0, GetDecimal)));
+float Math_Abs(float n) {
+    return Math::Abs(n);
 }
 /***
  * Math.Min
@@ -6402,10 +6657,8 @@ VMValue Math_Abs(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the lesser value of a and b.
  * \ns Math
  */
-VMValue Math_Min(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(2);
-    // respect the type of number
-    return DECIMAL_VAL(Math::Min(GET_ARG(0, GetDecimal), GET_ARG(1, GetDecimal)));
+float Math_Min(float a, float b) {
+    return Math::Min(a, b);
 }
 /***
  * Math.Max
@@ -6415,9 +6668,8 @@ VMValue Math_Min(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the greater value of a and b.
  * \ns Math
  */
-VMValue Math_Max(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(2);
-    return DECIMAL_VAL(Math::Max(GET_ARG(0, GetDecimal), GET_ARG(1, GetDecimal)));
+float Math_Max(float a, float b) {
+    return Math::Max(a, b);
 }
 /***
  * Math.Clamp
@@ -6428,9 +6680,8 @@ VMValue Math_Max(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the Number value if within the range, otherwise returns closest range value.
  * \ns Math
  */
-VMValue Math_Clamp(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(3);
-    return DECIMAL_VAL(Math::Clamp(GET_ARG(0, GetDecimal), GET_ARG(1, GetDecimal), GET_ARG(2, GetDecimal)));
+float Math_Clamp(float n, float minValue, float maxValue) {
+    return Math::Clamp(n, minValue, maxValue);
 }
 /***
  * Math.Sign
@@ -6439,9 +6690,8 @@ VMValue Math_Clamp(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns <code>-1</code> if <code>n</code> is negative, <code>1</code> if positive, and <code>0</code> if otherwise.
  * \ns Math
  */
-VMValue Math_Sign(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(Math::Sign(GET_ARG(0, GetDecimal)));
+float Math_Sign(float n) {
+    return Math::Sign(n);
 }
 /***
  * Math.Random
@@ -6449,9 +6699,8 @@ VMValue Math_Sign(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the random number.
  * \ns Math
  */
-VMValue Math_Random(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(0);
-    return DECIMAL_VAL(Math::Random());
+float Math_Random() {
+    return Math::Random();
 }
 /***
  * Math.RandomMax
@@ -6460,9 +6709,8 @@ VMValue Math_Random(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the random number.
  * \ns Math
  */
-VMValue Math_RandomMax(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(Math::RandomMax(GET_ARG(0, GetDecimal)));
+float Math_RandomMax(float max) {
+    return Math::RandomMax(max);
 }
 /***
  * Math.RandomRange
@@ -6472,9 +6720,8 @@ VMValue Math_RandomMax(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the random number.
  * \ns Math
  */
-VMValue Math_RandomRange(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(2);
-    return DECIMAL_VAL(Math::RandomRange(GET_ARG(0, GetDecimal), GET_ARG(1, GetDecimal)));
+float Math_RandomRange(float min, float max) {
+    return Math::RandomRange(min, max);
 }
 /***
  * Math.GetRandSeed
@@ -6482,9 +6729,8 @@ VMValue Math_RandomRange(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns an integer of the engine's random seed value.
  * \ns Math
  */
-VMValue Math_GetRandSeed(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(0);
-    return INTEGER_VAL(Math::GetRandSeed());
+int Math_GetRandSeed() {
+    return Math::GetRandSeed();
 }
 /***
  * Math.SetRandSeed
@@ -6492,10 +6738,8 @@ VMValue Math_GetRandSeed(int argCount, VMValue* args, Uint32 threadID) {
  * \param key (Integer): Value to set the seed to.
  * \ns Math
  */
-VMValue Math_SetRandSeed(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    Math::SetRandSeed(GET_ARG(0, GetInteger));
-    return NULL_VAL;
+void Math_SetRandSeed(int key) {
+    Math::SetRandSeed(key);
 }
 /***
  * Math.RandomInteger
@@ -6505,9 +6749,8 @@ VMValue Math_SetRandSeed(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the random number as an integer.
  * \ns Math
  */
-VMValue Math_RandomInteger(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(2);
-    return INTEGER_VAL(Math::RandomInteger(GET_ARG(0, GetInteger), GET_ARG(1, GetInteger)));
+int Math_RandomInteger(int min, int max) {
+    return Math::RandomInteger(min, max);
 }
 /***
  * Math.RandomIntegerSeeded
@@ -6531,9 +6774,8 @@ VMValue Math_RandomIntegerSeeded(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the floored number value.
  * \ns Math
  */
-VMValue Math_Floor(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(std::floor(GET_ARG(0, GetDecimal)));
+float Math_Floor(float n) {
+    return std::floor(n);
 }
 /***
  * Math.Ceil
@@ -6542,9 +6784,8 @@ VMValue Math_Floor(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the ceiling-ed number value.
  * \ns Math
  */
-VMValue Math_Ceil(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(std::ceil(GET_ARG(0, GetDecimal)));
+float Math_Ceil(float n) {
+    return std::ceil(n);
 }
 /***
  * Math.Round
@@ -6553,9 +6794,8 @@ VMValue Math_Ceil(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the rounded number value.
  * \ns Math
  */
-VMValue Math_Round(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(std::round(GET_ARG(0, GetDecimal)));
+float Math_Round(float n) {
+    return std::round(n);
 }
 /***
  * Math.Sqrt
@@ -6564,9 +6804,8 @@ VMValue Math_Round(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the square root of the number n.
  * \ns Math
  */
-VMValue Math_Sqrt(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(sqrt(GET_ARG(0, GetDecimal)));
+float Math_Sqrt(float n) {
+    return sqrt(n);
 }
 /***
  * Math.Pow
@@ -6576,9 +6815,8 @@ VMValue Math_Sqrt(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the number n to the power of p.
  * \ns Math
  */
-VMValue Math_Pow(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(2);
-    return DECIMAL_VAL(pow(GET_ARG(0, GetDecimal), GET_ARG(1, GetDecimal)));
+float Math_Pow(float n, float p) {
+    return pow(n, p);
 }
 /***
  * Math.Exp
@@ -6587,9 +6825,8 @@ VMValue Math_Pow(int argCount, VMValue* args, Uint32 threadID) {
  * \return Returns the result number.
  * \ns Math
  */
-VMValue Math_Exp(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL(std::exp(GET_ARG(0, GetDecimal)));
+float Math_Exp(float p) {
+    return std::exp(p);
 }
 // #endregion
 
@@ -6599,20 +6836,16 @@ VMValue Math_Exp(int argCount, VMValue* args, Uint32 threadID) {
  * \desc Clears the engine's angle lookup tables.
  * \ns RSDK.Math
  */
-VMValue Math_ClearTrigLookupTables(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(0);
+void Math_ClearTrigLookupTables() {
     Math::ClearTrigLookupTables();
-    return NULL_VAL;
 }
 /***
  * RSDK.Math.CalculateTrigAngles
  * \desc Sets the engine's angle lookup tables.
  * \ns RSDK.Math
  */
-VMValue Math_CalculateTrigAngles(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(0);
+void Math_CalculateTrigAngles() {
     Math::CalculateTrigAngles();
-    return NULL_VAL;
 }
 /***
  * RSDK.Math.Sin1024
@@ -6621,9 +6854,8 @@ VMValue Math_CalculateTrigAngles(int argCount, VMValue* args, Uint32 threadID) {
  * \return The sine 1024 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_Sin1024(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::Sin1024(GET_ARG(0, GetInteger)));
+int Math_Sin1024(int angle) {
+    return Math::Sin1024(angle);
 }
 /***
  * RSDK.Math.Cos1024
@@ -6632,9 +6864,8 @@ VMValue Math_Sin1024(int argCount, VMValue* args, Uint32 threadID) {
  * \return The cosine 1024 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_Cos1024(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::Cos1024(GET_ARG(0, GetInteger)));
+int Math_Cos1024(int angle) {
+    return Math::Cos1024(angle);
 }
 /***
  * RSDK.Math.Tan1024
@@ -6643,9 +6874,8 @@ VMValue Math_Cos1024(int argCount, VMValue* args, Uint32 threadID) {
  * \return The tangent 1024 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_Tan1024(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::Tan1024(GET_ARG(0, GetInteger)));
+int Math_Tan1024(int angle) {
+    return Math::Tan1024(angle);
 }
 /***
  * RSDK.Math.ASin1024
@@ -6654,9 +6884,8 @@ VMValue Math_Tan1024(int argCount, VMValue* args, Uint32 threadID) {
  * \return The arc sine 1024 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_ASin1024(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::ASin1024(GET_ARG(0, GetInteger)));
+int Math_ASin1024(int angle) {
+    return Math::ASin1024(angle);
 }
 /***
  * RSDK.Math.ACos1024
@@ -6665,9 +6894,8 @@ VMValue Math_ASin1024(int argCount, VMValue* args, Uint32 threadID) {
  * \return The arc cosine 1024 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_ACos1024(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::ACos1024(GET_ARG(0, GetInteger)));
+int Math_ACos1024(int angle) {
+    return Math::ACos1024(angle);
 }
 /**
  * RSDK.Math.Sin512
@@ -6676,9 +6904,8 @@ VMValue Math_ACos1024(int argCount, VMValue* args, Uint32 threadID) {
  * \return The sine 512 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_Sin512(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::Sin512(GET_ARG(0, GetInteger)));
+int Math_Sin512(int angle) {
+    return Math::Sin512(angle);
 }
 /***
  * RSDK.Math.Cos512
@@ -6687,9 +6914,8 @@ VMValue Math_Sin512(int argCount, VMValue* args, Uint32 threadID) {
  * \return The cosine 512 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_Cos512(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::Cos512(GET_ARG(0, GetInteger)));
+int Math_Cos512(int angle) {
+    return Math::Cos512(angle);
 }
 /***
  * RSDK.Math.Tan512
@@ -6698,9 +6924,8 @@ VMValue Math_Cos512(int argCount, VMValue* args, Uint32 threadID) {
  * \return The tangent 512 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_Tan512(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::Tan512(GET_ARG(0, GetInteger)));
+int Math_Tan512(int angle) {
+    return Math::Tan512(angle);
 }
 /***
  * RSDK.Math.ASin512
@@ -6709,9 +6934,8 @@ VMValue Math_Tan512(int argCount, VMValue* args, Uint32 threadID) {
  * \return The arc sine 512 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_ASin512(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::ASin512(GET_ARG(0, GetInteger)));
+int Math_ASin512(int angle) {
+    return Math::ASin512(angle);
 }
 /***
  * RSDK.Math.ACos512
@@ -6720,9 +6944,8 @@ VMValue Math_ASin512(int argCount, VMValue* args, Uint32 threadID) {
  * \return The arc cosine 512 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_ACos512(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::ACos512(GET_ARG(0, GetInteger)));
+int Math_ACos512(int angle) {
+    return Math::ACos512(angle);
 }
 /**
  * RSDK.Math.Sin256
@@ -6731,9 +6954,8 @@ VMValue Math_ACos512(int argCount, VMValue* args, Uint32 threadID) {
  * \return The sine 256 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_Sin256(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::Sin256(GET_ARG(0, GetInteger)));
+int Math_Sin256(int angle) {
+    return Math::Sin256(angle);
 }
 /***
  * RSDK.Math.Cos256
@@ -6742,9 +6964,8 @@ VMValue Math_Sin256(int argCount, VMValue* args, Uint32 threadID) {
  * \return The cosine 256 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_Cos256(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::Cos256(GET_ARG(0, GetInteger)));
+int Math_Cos256(int angle) {
+    return Math::Cos256(angle);
 }
 /***
  * RSDK.Math.Tan256
@@ -6753,9 +6974,8 @@ VMValue Math_Cos256(int argCount, VMValue* args, Uint32 threadID) {
  * \return The tangent 256 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_Tan256(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::Tan256(GET_ARG(0, GetInteger)));
+int Math_Tan256(int angle) {
+    return Math::Tan256(angle);
 }
 /***
  * RSDK.Math.ASin256
@@ -6764,9 +6984,8 @@ VMValue Math_Tan256(int argCount, VMValue* args, Uint32 threadID) {
  * \return The arc sine 256 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_ASin256(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::ASin256(GET_ARG(0, GetInteger)));
+int Math_ASin256(int angle) {
+    return Math::ASin256(angle);
 }
 /***
  * RSDK.Math.ACos256
@@ -6775,9 +6994,8 @@ VMValue Math_ASin256(int argCount, VMValue* args, Uint32 threadID) {
  * \return The arc cosine 256 of the angle.
  * \ns RSDK.Math
  */
-VMValue Math_ACos256(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL(Math::ACos256(GET_ARG(0, GetInteger)));
+int Math_ACos256(int angle) {
+    return Math::ACos256(angle);
 }
 /***
  * RSDK.Math.RadianToInteger
@@ -6786,9 +7004,8 @@ VMValue Math_ACos256(int argCount, VMValue* args, Uint32 threadID) {
  * \return An integer value of the converted radian.
  * \ns RSDK.Math
  */
-VMValue Math_RadianToInteger(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return INTEGER_VAL((int)((float)GET_ARG(0, GetDecimal) * 256.0 / M_PI));
+int Math_RadianToInteger(float radian) {
+    return (int)(radian * 256.0 / M_PI);
 }
 /***
  * RSDK.Math.IntegerToRadian
@@ -6797,9 +7014,8 @@ VMValue Math_RadianToInteger(int argCount, VMValue* args, Uint32 threadID) {
  * \return A radia Decimal value of the converted integer.
  * \ns RSDK.Math
  */
-VMValue Math_IntegerToRadian(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_ARGCOUNT(1);
-    return DECIMAL_VAL((float)(GET_ARG(0, GetInteger) * M_PI / 256.0));
+float Math_IntegerToRadian(int integer) {
+    return (float)(integer * M_PI / 256.0);
 }
 // #endregion
 
@@ -7820,7 +8036,7 @@ VMValue Number_ToString(int argCount, VMValue* args, Uint32 threadID) {
         base = GET_ARG(1, GetInteger);
     }
 
-    switch (args[0].Type) {
+    switch (VALUE_TYPE(args[0])) {
         case VAL_DECIMAL:
         case VAL_LINKED_DECIMAL: {
             float n = GET_ARG(0, GetDecimal);
@@ -8399,6 +8615,65 @@ VMValue Palette_SetPaletteIndexLines(int argCount, VMValue* args, Uint32 threadI
 #undef CHECK_COLOR_INDEX
 // #endregion
 
+// #region Profiler
+/***
+ * Profiler.Start
+ * \desc Starts sampling the call stacks of all script threads, discarding any earlier samples.
+ * \paramOpt interval (Integer): How many milliseconds to wait between samples. (default: <code>1</code>)
+ * \return Returns whether the profiler is running.
+ * \ns Profiler
+ */
+VMValue Profiler_Start(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_AT_LEAST_ARGCOUNT(0);
+    int interval = GET_ARG_OPT(0, GetInteger, 1);
+    return INTEGER_VAL(ScriptProfiler::Start(interval));
+}
+/***
+ * Profiler.Stop
+ * \desc Stops sampling. The samples taken so far are kept until the profiler is started again.
+ * \ns Profiler
+ */
+VMValue Profiler_Stop(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(0);
+    ScriptProfiler::Stop();
+    return NULL_VAL;
+}
+/***
+ * Profiler.IsRunning
+ * \desc Checks whether the profiler is sampling.
+ * \return Returns a Boolean value.
+ * \ns Profiler
+ */
+VMValue Profiler_IsRunning(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(0);
+    return INTEGER_VAL(ScriptProfiler::IsRunning());
+}
+/***
+ * Profiler.SaveCollapsedStacks
+ * \desc Writes the samples as collapsed stacks, one line per distinct call stack, for flame graph tools.
+ * \param filename (String): The file to write.
+ * \return Returns whether the file was written.
+ * \ns Profiler
+ */
+VMValue Profiler_SaveCollapsedStacks(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    char* filename = GET_ARG(0, GetString);
+    return INTEGER_VAL(ScriptProfiler::WriteCollapsedStacks(filename));
+}
+/***
+ * Profiler.SaveChromeTrace
+ * \desc Writes the samples as a trace in the Trace Event format, for chrome://tracing or Perfetto.
+ * \param filename (String): The file to write.
+ * \return Returns whether the file was written.
+ * \ns Profiler
+ */
+VMValue Profiler_SaveChromeTrace(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    char* filename = GET_ARG(0, GetString);
+    return INTEGER_VAL(ScriptProfiler::WriteChromeTrace(filename));
+}
+// #endregion
+
 // #region Resources
 /***
  * Resources.LoadSprite
@@ -8994,6 +9269,38 @@ VMValue Scene_CheckObjectCollisionPlatform(int argCount, VMValue* args, Uint32 t
     }
     return INTEGER_VAL(!!Scene::CheckObjectCollisionPlatform(thisEnt, &thisBox, otherEnt, &otherBox, setValues));
 }
+/***
+ * Scene.GetInstancesInRegion
+ * \desc Gets every instance whose hitbox touches a region, without looping through every instance in the scene.
+ * \param left (Number): The left edge of the region.
+ * \param top (Number): The top edge of the region.
+ * \param right (Number): The right edge of the region.
+ * \param bottom (Number): The bottom edge of the region.
+ * \paramOpt className (String): Only get instances of this object class.
+ * \return Returns an Array of instances.
+ * \ns Scene
+ */
+VMValue Scene_GetInstancesInRegion(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_AT_LEAST_ARGCOUNT(4);
+
+    float left = GET_ARG(0, GetDecimal);
+    float top = GET_ARG(1, GetDecimal);
+    float right = GET_ARG(2, GetDecimal);
+    float bottom = GET_ARG(3, GetDecimal);
+    char* objectName = GET_ARG_OPT(4, GetString, NULL);
+
+    ObjectList* objectList = NULL;
+    if (objectName) {
+        if (!Scene::ObjectLists->Exists(objectName))
+            return OBJECT_VAL(NewArray());
+        objectList = Scene::ObjectLists->Get(objectName);
+    }
+
+    vector<Entity*> entities;
+    Scene::GetEntitiesInRegion(left, top, right, bottom, &entities);
+
+    return OBJECT_VAL(Instance_ToArray(entities, NULL, objectList));
+}
 /***
  * Scene.Load
  * \desc Changes active scene to the one in the specified resource file.
@@ -10695,7 +11002,7 @@ VMValue Scene_SetLayerDeformOffsetB(int argCount, VMValue* args, Uint32 threadID
 VMValue Scene_SetLayerCustomScanlineFunction(int argCount, VMValue* args, Uint32 threadID) {
     CHECK_ARGCOUNT(2);
     int index = GET_ARG(0, GetInteger);
-    if (args[0].Type == VAL_NULL) {
+    if (VALUE_TYPE(args[0]) == VAL_NULL) {
         Scene::Layers[index].UsingCustomScanlineFunction = false;
     }
     else {
@@ -10753,7 +11060,7 @@ VMValue Scene_SetTileScanline(int argCount, VMValue* args, Uint32 threadID) {
 VMValue Scene_SetLayerCustomRenderFunction(int argCount, VMValue* args, Uint32 threadID) {
     CHECK_ARGCOUNT(2);
     int index = GET_ARG(0, GetInteger);
-    if (args[0].Type == VAL_NULL) {
+    if (VALUE_TYPE(args[0]) == VAL_NULL) {
         Scene::Layers[index].UsingCustomRenderFunction = false;
     }
     else {
@@ -13191,6 +13498,42 @@ VMValue Stream_WriteString(int argCount, VMValue* args, Uint32 threadID) {
     stream->StreamPtr->WriteString(string);
     return NULL_VAL;
 }
+/***
+ * Stream.ReadTypedArray
+ * \desc Reads the elements of a typed array from the stream, as little-endian numbers of the array's type.
+ * \param stream (Stream): The stream.
+ * \param array (TypedArray): The typed array to read into.
+ * \return Returns the number of elements read, which is less than the length of the array if the stream ended.
+ * \ns Stream
+ */
+VMValue Stream_ReadTypedArray(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+    ObjStream* stream = GET_ARG(0, GetStream);
+    ObjTypedArray* array = GET_ARG(1, GetTypedArray);
+    CHECK_READ_STREAM;
+    size_t elementSize = GetTypedArrayElementSize(array->ElementType);
+    size_t left = stream->StreamPtr->Length() - stream->StreamPtr->Position();
+    size_t count = array->Length;
+    if (count > left / elementSize)
+        count = left / elementSize;
+    stream->StreamPtr->ReadBytes(array->Data, count * elementSize);
+    return INTEGER_VAL((int)count);
+}
+/***
+ * Stream.WriteTypedArray
+ * \desc Writes the elements of a typed array to the stream, as little-endian numbers of the array's type.
+ * \param stream (Stream): The stream.
+ * \param array (TypedArray): The typed array to write.
+ * \ns Stream
+ */
+VMValue Stream_WriteTypedArray(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+    ObjStream* stream = GET_ARG(0, GetStream);
+    ObjTypedArray* array = GET_ARG(1, GetTypedArray);
+    CHECK_WRITE_STREAM;
+    stream->StreamPtr->WriteBytes(array->Data, array->Length * GetTypedArrayElementSize(array->ElementType));
+    return NULL_VAL;
+}
 #undef CHECK_WRITE_STREAM
 #undef CHECK_READ_STREAM
 // #endregion
@@ -13434,6 +13777,188 @@ VMValue String_ParseDecimal(int argCount, VMValue* args, Uint32 threadID) {
 }
 // #endregion
 
+// #region StringBuilder
+static bool StringBuilder_Reserve(ObjStringBuilder* builder, size_t length) {
+    if (length + 1 <= builder->Capacity)
+        return true;
+
+    size_t capacity = builder->Capacity;
+    while (capacity < length + 1)
+        capacity <<= 1;
+
+    char* chars = (char*)realloc(builder->Chars, capacity);
+    if (!chars)
+        return false;
+
+    ScriptManager::Lock();
+    GarbageCollector::GarbageSize += capacity - builder->Capacity;
+    ScriptManager::Unlock();
+
+    builder->Chars = chars;
+    builder->Capacity = capacity;
+    return true;
+}
+// Appends a value as the + operator would print it.
+static bool StringBuilder_AppendValue(ObjStringBuilder* builder, VMValue value) {
+    if (IS_STRING(value) || IS_STRING_BUILDER(value)) {
+        size_t length = IS_STRING(value) ? AS_STRING(value)->Length : AS_STRING_BUILDER(value)->Length;
+        if (!StringBuilder_Reserve(builder, builder->Length + length))
+            return false;
+
+        // Read this after reserving, in case the builder is appending itself
+        const char* chars = IS_STRING(value) ? AS_CSTRING(value) : AS_STRING_BUILDER(value)->Chars;
+        memmove(builder->Chars + builder->Length, chars, length);
+        builder->Length += length;
+        builder->Chars[builder->Length] = '\0';
+        return true;
+    }
+
+    // Other objects could hold this builder and print its text, which
+    // must not move while it's being read
+    if (IS_OBJECT(value))
+        return StringBuilder_AppendValue(builder, ScriptManager::CastValueAsString(value));
+
+    // Numbers are printed into a separate buffer first, so that a failed
+    // allocation leaves the builder as it was
+    char* chars = (char*)malloc(32);
+    if (!chars)
+        return false;
+
+    PrintBuffer buffer;
+    buffer.Buffer = &chars;
+    buffer.WriteIndex = 0;
+    buffer.BufferSize = 32;
+    Values::PrintValue(&buffer, value);
+    if (!chars)
+        return false;
+
+    bool appended = StringBuilder_Reserve(builder, builder->Length + buffer.WriteIndex);
+    if (appended) {
+        memcpy(builder->Chars + builder->Length, chars, buffer.WriteIndex);
+        builder->Length += buffer.WriteIndex;
+        builder->Chars[builder->Length] = '\0';
+    }
+    free(chars);
+    return appended;
+}
+
+/***
+ * StringBuilder.Create
+ * \desc Creates a string builder, which text can be added to without making a new String every time. Any function that takes a String also accepts a string builder, and reads its text without copying it.
+ * \paramOpt capacity (Integer): How many characters to make room for up front.
+ * \return Returns the new string builder.
+ * \ns StringBuilder
+ */
+VMValue StringBuilder_Create(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_AT_LEAST_ARGCOUNT(0);
+    int capacity = GET_ARG_OPT(0, GetInteger, 0);
+    ObjStringBuilder* builder = NewStringBuilder(capacity > 0 ? capacity + 1 : 0);
+    if (!builder) {
+        THROW_ERROR("Could not allocate a string builder!");
+        return NULL_VAL;
+    }
+    return OBJECT_VAL(builder);
+}
+/***
+ * StringBuilder.Append
+ * \desc Adds values to the end of a string builder. Values that aren't Strings are written the same way as when they're added to a String.
+ * \param builder (StringBuilder): The string builder.
+ * \param value (Value): The value to add.
+ * \paramOpt values (Value): More values to add after it.
+ * \return Returns the string builder.
+ * \ns StringBuilder
+ */
+VMValue StringBuilder_Append(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_AT_LEAST_ARGCOUNT(2);
+    ObjStringBuilder* builder = GET_ARG(0, GetStringBuilder);
+    if (ScriptManager::Lock()) {
+        for (int i = 1; i < argCount; i++) {
+            if (!StringBuilder_AppendValue(builder, args[i])) {
+                ScriptManager::Unlock();
+                THROW_ERROR("Could not grow string builder!");
+                return NULL_VAL;
+            }
+        }
+        ScriptManager::Unlock();
+    }
+    return args[0];
+}
+/***
+ * StringBuilder.Insert
+ * \desc Inserts a value into a string builder.
+ * \param builder (StringBuilder): The string builder.
+ * \param index (Integer): Where to insert the value, from 0 to the length of the text.
+ * \param value (Value): The value to insert.
+ * \return Returns the string builder.
+ * \ns StringBuilder
+ */
+VMValue StringBuilder_Insert(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(3);
+    ObjStringBuilder* builder = GET_ARG(0, GetStringBuilder);
+    int index = GET_ARG(1, GetInteger);
+    if (index < 0 || (size_t)index > builder->Length) {
+        OUT_OF_RANGE_ERROR("String builder index", index, 0, (int)builder->Length);
+        return NULL_VAL;
+    }
+
+    if (ScriptManager::Lock()) {
+        // Append it, then rotate it into place
+        size_t start = builder->Length;
+        if (!StringBuilder_AppendValue(builder, args[2])) {
+            ScriptManager::Unlock();
+            THROW_ERROR("Could not grow string builder!");
+            return NULL_VAL;
+        }
+        std::rotate(builder->Chars + index, builder->Chars + start, builder->Chars + builder->Length);
+        ScriptManager::Unlock();
+    }
+    return args[0];
+}
+/***
+ * StringBuilder.Length
+ * \desc Gets the length of the text in a string builder.
+ * \param builder (StringBuilder): The string builder.
+ * \return Returns the length of the text.
+ * \ns StringBuilder
+ */
+VMValue StringBuilder_Length(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    ObjStringBuilder* builder = GET_ARG(0, GetStringBuilder);
+    return INTEGER_VAL((int)builder->Length);
+}
+/***
+ * StringBuilder.Clear
+ * \desc Removes all text from a string builder, keeping its memory for reuse.
+ * \param builder (StringBuilder): The string builder.
+ * \return Returns the string builder.
+ * \ns StringBuilder
+ */
+VMValue StringBuilder_Clear(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    ObjStringBuilder* builder = GET_ARG(0, GetStringBuilder);
+    builder->Length = 0;
+    builder->Chars[0] = '\0';
+    return args[0];
+}
+/***
+ * StringBuilder.ToString
+ * \desc Copies the text of a string builder into a new String.
+ * \param builder (StringBuilder): The string builder.
+ * \return Returns a String value.
+ * \ns StringBuilder
+ */
+VMValue StringBuilder_ToString(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    ObjStringBuilder* builder = GET_ARG(0, GetStringBuilder);
+    if (ScriptManager::Lock()) {
+        VMValue string = OBJECT_VAL(CopyString(builder->Chars, builder->Length));
+        ScriptManager::Unlock();
+        return string;
+    }
+    return NULL_VAL;
+}
+// #endregion
+
 // #region Texture
 bool GetTextureListSpace(size_t* out) {
     for (size_t i = 0, listSz = Scene::TextureList.size(); i < listSz; i++) {
@@ -13880,87 +14405,456 @@ VMValue TileInfo_IsCeiling(int argCount, VMValue* args, Uint32 threadID) {
 // #endregion
 
 // #region Thread
-struct _Thread_Bundle {
-    ObjFunction    Callback;
-    int            ArgCount;
-    int            ThreadIndex;
-};
-
-int     _Thread_RunEvent(void* op) {
-    _Thread_Bundle* bundle;
-    bundle = (_Thread_Bundle*)op;
-
-    VMValue*  args = (VMValue*)(bundle + 1);
-    VMThread* thread = ScriptManager::Threads + bundle->ThreadIndex;
-    VMValue   callbackVal = OBJECT_VAL(&bundle->Callback);
+/***
+ * Thread.RunEvent
+ * \desc Runs a function on a worker thread.
+ * \param callback (Function): The function or method to run.
+ * \paramOpt args (Value): Up to 8 arguments to pass to the function.
+ * \return Returns an Integer handle that can be passed to Thread.IsDone and Thread.Join.
+ * \ns Thread
+ */
+VMValue Thread_RunEvent(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_AT_LEAST_ARGCOUNT(1);
 
-    // if (bundle->Callback.Method == NULL) {
-    //     Log::Print(Log::LOG_ERROR, "No callback.");
-    //     ScriptManager::ThreadCount--;
-    //     free(bundle);
-    //     return 0;
-    // }
+    if (!IS_BOUND_METHOD(args[0]) && !IS_FUNCTION(args[0])) {
+        THROW_ERROR("Expected argument %d to be of type %s instead of %s.", 1, GetObjectTypeString(OBJ_FUNCTION), GetValueTypeString(args[0]));
+        return NULL_VAL;
+    }
 
-    thread->Push(callbackVal);
-    for (int i = 0; i < bundle->ArgCount; i++) {
-        thread->Push(args[i]);
+    int subArgCount = argCount - 1;
+    if (subArgCount > JOB_ARGS_MAX) {
+        THROW_ERROR("Too many arguments for thread! (Max %d)", JOB_ARGS_MAX);
+        return NULL_VAL;
     }
-    thread->RunValue(callbackVal, bundle->ArgCount);
 
-    free(bundle);
+    int handle = ScriptManager::SubmitJob(args[0], args + 1, subArgCount);
+    if (handle < 0) {
+        THROW_ERROR("Too many threads running! (Max %d)", ScriptManager::MAX_JOBS);
+        return NULL_VAL;
+    }
 
-    ScriptManager::ThreadCount--;
-    Log::Print(Log::LOG_IMPORTANT, "Thread %d closed.", ScriptManager::ThreadCount);
-    return 0;
+    return INTEGER_VAL(handle);
 }
 /***
- * Thread.RunEvent
+ * Thread.IsDone
+ * \desc Checks whether a function started with Thread.RunEvent has finished.
+ * \param handle (Integer): The thread handle.
+ * \return Returns a Boolean value.
+ * \ns Thread
+ */
+VMValue Thread_IsDone(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    int handle = GET_ARG(0, GetInteger);
+    if (!ScriptManager::GetJob(handle)) {
+        THROW_ERROR("Invalid thread handle %d.", handle);
+        return NULL_VAL;
+    }
+    return INTEGER_VAL(ScriptManager::IsJobDone(handle));
+}
+/***
+ * Thread.Join
+ * \desc Waits for a function started with Thread.RunEvent to finish. The handle is no longer valid afterwards.
+ * \param handle (Integer): The thread handle.
+ * \return Returns the value the function returned.
+ * \ns Thread
+ */
+VMValue Thread_Join(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    int handle = GET_ARG(0, GetInteger);
+    VMValue result = NULL_VAL;
+    if (!ScriptManager::JoinJob(handle, &result)) {
+        THROW_ERROR("Invalid thread handle %d.", handle);
+        return NULL_VAL;
+    }
+    return result;
+}
+/***
+ * Thread.Sleep
  * \desc
  * \return
  * \ns Thread
  */
-VMValue Thread_RunEvent(int argCount, VMValue* args, Uint32 threadID) {
-    CHECK_AT_LEAST_ARGCOUNT(1);
+VMValue Thread_Sleep(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    SDL_Delay(GET_ARG(0, GetInteger));
+    return NULL_VAL;
+}
+// #endregion
 
-    ObjFunction* callback = NULL;
-    if (IS_BOUND_METHOD(args[0])) {
-        callback = GET_ARG(0, GetBoundMethod)->Method;
+// #region TypedArray
+// The loops below do one thing over plain pointers, so that the compiler
+// can vectorize them. The element type is switched on once per call, not
+// once per element.
+template <typename T>
+static void TypedArray_FillLoop(T* data, T value, Uint32 count) {
+    for (Uint32 i = 0; i < count; i++)
+        data[i] = value;
+}
+template <typename T>
+static void TypedArray_AddLoop(T* dest, const T* src, Uint32 count) {
+    for (Uint32 i = 0; i < count; i++)
+        dest[i] += src[i];
+}
+// Going from a float straight to Uint8 is undefined outside 0-255, so
+// bytes go through Sint32 and wrap like integer stores do.
+template <typename T>
+static inline T TypedArray_FromFloat(float value) {
+    return (T)value;
+}
+template <>
+inline Uint8    TypedArray_FromFloat<Uint8>(float value) {
+    return (Uint8)(Sint32)value;
+}
+template <typename T>
+static void TypedArray_ScaleLoop(T* data, float factor, Uint32 count) {
+    for (Uint32 i = 0; i < count; i++)
+        data[i] = TypedArray_FromFloat<T>(data[i] * factor);
+}
+template <typename T>
+static void TypedArray_LerpLoop(T* dest, const T* a, const T* b, float t, Uint32 count) {
+    for (Uint32 i = 0; i < count; i++)
+        dest[i] = TypedArray_FromFloat<T>(a[i] + (b[i] - a[i]) * t);
+}
+template <typename T>
+static T    TypedArray_MinLoop(const T* data, Uint32 count) {
+    T result = data[0];
+    for (Uint32 i = 1; i < count; i++)
+        result = data[i] < result ? data[i] : result;
+    return result;
+}
+template <typename T>
+static T    TypedArray_MaxLoop(const T* data, Uint32 count) {
+    T result = data[0];
+    for (Uint32 i = 1; i < count; i++)
+        result = data[i] > result ? data[i] : result;
+    return result;
+}
+template <typename T, typename Sum>
+static Sum  TypedArray_SumLoop(const T* data, Uint32 count) {
+    Sum result = 0;
+    for (Uint32 i = 0; i < count; i++)
+        result += data[i];
+    return result;
+}
+
+static bool TypedArray_CheckType(int type, Uint32 threadID) {
+    if (type < 0 || type >= MAX_TYPEDARRAY_TYPE) {
+        OUT_OF_RANGE_ERROR("Typed array type", type, 0, MAX_TYPEDARRAY_TYPE - 1);
+        return false;
+    }
+    return true;
+}
+static bool TypedArray_CheckSame(ObjTypedArray* a, ObjTypedArray* b, Uint32 threadID) {
+    if (a->ElementType != b->ElementType || a->Length != b->Length) {
+        THROW_ERROR("Typed arrays must be of the same type and length.");
+        return false;
+    }
+    return true;
+}
+
+/***
+ * TypedArray.Create
+ * \desc Creates a typed array, with every element set to zero.
+ * \param type (Enum): The <linkto ref="TypedArray_*">element type</linkto>.
+ * \param length (Integer): Length of the array.
+ * \return Returns the new typed array.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Create(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+    int type = GET_ARG(0, GetInteger);
+    int length = GET_ARG(1, GetInteger);
+    if (!TypedArray_CheckType(type, threadID))
+        return NULL_VAL;
+    if (length < 0) {
+        THROW_ERROR("Typed array length %d cannot be negative.", length);
+        return NULL_VAL;
     }
-    else if (IS_FUNCTION(args[0])) {
-        callback = AS_FUNCTION(args[0]);
+
+    ObjTypedArray* array = NewTypedArray(type, length);
+    if (!array) {
+        THROW_ERROR("Could not allocate a typed array of length %d!", length);
+        return NULL_VAL;
     }
+    return OBJECT_VAL(array);
+}
+/***
+ * TypedArray.FromArray
+ * \desc Creates a typed array from the numbers in an array.
+ * \param type (Enum): The <linkto ref="TypedArray_*">element type</linkto>.
+ * \param array (Array): The array to copy from.
+ * \return Returns the new typed array.
+ * \ns TypedArray
+ */
+VMValue TypedArray_FromArray(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+    int type = GET_ARG(0, GetInteger);
+    ObjArray* source = GET_ARG(1, GetArray);
+    if (!TypedArray_CheckType(type, threadID))
+        return NULL_VAL;
 
-    if (callback == NULL) {
-        Values::PrintValue(args[0]);
-        printf("\n");
-        Log::Print(Log::LOG_ERROR, "No callback.");
+    if (ScriptManager::Lock()) {
+        Uint32 length = (Uint32)source->Values->size();
+        ObjTypedArray* array = NewTypedArray(type, length);
+        if (!array) {
+            ScriptManager::Unlock();
+            THROW_ERROR("Could not allocate a typed array of length %d!", (int)length);
+            return NULL_VAL;
+        }
+
+        for (Uint32 i = 0; i < length; i++) {
+            if (!TypedArrayImpl::SetValue(array, i, (*source->Values)[i])) {
+                ScriptManager::Unlock();
+                THROW_ERROR("Cannot store a %s value in a typed array.", GetValueTypeString((*source->Values)[i]));
+                return NULL_VAL;
+            }
+        }
+
+        ScriptManager::Unlock();
+        return OBJECT_VAL(array);
+    }
+    return NULL_VAL;
+}
+/***
+ * TypedArray.ToArray
+ * \desc Copies the elements of a typed array into a new array.
+ * \param array (TypedArray): The typed array.
+ * \return Returns an Array of Integer or Decimal values.
+ * \ns TypedArray
+ */
+VMValue TypedArray_ToArray(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    ObjTypedArray* source = GET_ARG(0, GetTypedArray);
+
+    if (ScriptManager::Lock()) {
+        ObjArray* array = NewArray();
+        array->Values->reserve(source->Length);
+        for (Uint32 i = 0; i < source->Length; i++)
+            array->Values->push_back(TypedArrayImpl::GetValue(source, i));
+
+        ScriptManager::Unlock();
+        return OBJECT_VAL(array);
+    }
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Length
+ * \desc Gets the length of a typed array.
+ * \param array (TypedArray): The typed array.
+ * \return Returns the length of the typed array.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Length(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    ObjTypedArray* array = GET_ARG(0, GetTypedArray);
+    return INTEGER_VAL((int)array->Length);
+}
+/***
+ * TypedArray.Fill
+ * \desc Sets every element of a typed array to a value.
+ * \param array (TypedArray): The typed array.
+ * \param value (Number): The value to set the elements to.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Fill(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+    ObjTypedArray* array = GET_ARG(0, GetTypedArray);
+    if (array->ElementType == TYPEDARRAY_FLOAT32) {
+        TypedArray_FillLoop((float*)array->Data, GET_ARG(1, GetDecimal), array->Length);
         return NULL_VAL;
     }
 
-    int subArgCount = argCount - 1;
+    int value = IS_DECIMAL(args[1]) ? (int)GET_ARG(1, GetDecimal) : GET_ARG(1, GetInteger);
+    if (array->ElementType == TYPEDARRAY_UINT8)
+        TypedArray_FillLoop((Uint8*)array->Data, (Uint8)value, array->Length);
+    else
+        TypedArray_FillLoop((Sint32*)array->Data, (Sint32)value, array->Length);
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Copy
+ * \desc Copies elements from one typed array to another of the same type. The ranges may overlap.
+ * \param dest (TypedArray): The typed array to copy to.
+ * \param destIndex (Integer): Where in the destination to start writing.
+ * \param src (TypedArray): The typed array to copy from.
+ * \param srcIndex (Integer): Where in the source to start reading.
+ * \param count (Integer): How many elements to copy.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Copy(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(5);
+    ObjTypedArray* dest = GET_ARG(0, GetTypedArray);
+    int destIndex = GET_ARG(1, GetInteger);
+    ObjTypedArray* src = GET_ARG(2, GetTypedArray);
+    int srcIndex = GET_ARG(3, GetInteger);
+    int count = GET_ARG(4, GetInteger);
 
-    _Thread_Bundle* bundle = (_Thread_Bundle*)malloc(sizeof(_Thread_Bundle) + subArgCount * sizeof(VMValue));
-    bundle->Callback = *callback;
-    bundle->Callback.Object.Next = NULL;
-    bundle->ArgCount = subArgCount;
-    bundle->ThreadIndex = ScriptManager::ThreadCount++;
-    if (subArgCount > 0)
-        memcpy(bundle + 1, args + 1, subArgCount * sizeof(VMValue));
+    if (dest->ElementType != src->ElementType) {
+        THROW_ERROR("Typed arrays must be of the same type.");
+        return NULL_VAL;
+    }
+    if (count < 0 || destIndex < 0 || srcIndex < 0
+        || (Uint32)destIndex + count > dest->Length
+        || (Uint32)srcIndex + count > src->Length) {
+        THROW_ERROR("Cannot copy %d elements from index %d of array of size %d to index %d of array of size %d.",
+            count, srcIndex, (int)src->Length, destIndex, (int)dest->Length);
+        return NULL_VAL;
+    }
 
-    // SDL_DetachThread
-    SDL_CreateThread(_Thread_RunEvent, "_Thread_RunEvent", bundle);
+    size_t elementSize = GetTypedArrayElementSize(dest->ElementType);
+    memmove((Uint8*)dest->Data + destIndex * elementSize, (Uint8*)src->Data + srcIndex * elementSize, count * elementSize);
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Add
+ * \desc Adds each element of one typed array to the same element of another. Integer elements wrap around on overflow.
+ * \param dest (TypedArray): The typed array to add to.
+ * \param src (TypedArray): The typed array to add, of the same type and length.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Add(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+    ObjTypedArray* dest = GET_ARG(0, GetTypedArray);
+    ObjTypedArray* src = GET_ARG(1, GetTypedArray);
+    if (!TypedArray_CheckSame(dest, src, threadID))
+        return NULL_VAL;
 
+    switch (dest->ElementType) {
+        case TYPEDARRAY_INT32:
+            TypedArray_AddLoop((Sint32*)dest->Data, (Sint32*)src->Data, dest->Length);
+            break;
+        case TYPEDARRAY_FLOAT32:
+            TypedArray_AddLoop((float*)dest->Data, (float*)src->Data, dest->Length);
+            break;
+        case TYPEDARRAY_UINT8:
+            TypedArray_AddLoop((Uint8*)dest->Data, (Uint8*)src->Data, dest->Length);
+            break;
+    }
     return NULL_VAL;
 }
 /***
- * Thread.Sleep
- * \desc
- * \return
- * \ns Thread
+ * TypedArray.Scale
+ * \desc Multiplies every element of a typed array. Integer elements are truncated.
+ * \param array (TypedArray): The typed array.
+ * \param factor (Decimal): The value to multiply by.
+ * \ns TypedArray
  */
-VMValue Thread_Sleep(int argCount, VMValue* args, Uint32 threadID) {
+VMValue TypedArray_Scale(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(2);
+    ObjTypedArray* array = GET_ARG(0, GetTypedArray);
+    float factor = GET_ARG(1, GetDecimal);
+
+    switch (array->ElementType) {
+        case TYPEDARRAY_INT32:
+            TypedArray_ScaleLoop((Sint32*)array->Data, factor, array->Length);
+            break;
+        case TYPEDARRAY_FLOAT32:
+            TypedArray_ScaleLoop((float*)array->Data, factor, array->Length);
+            break;
+        case TYPEDARRAY_UINT8:
+            TypedArray_ScaleLoop((Uint8*)array->Data, factor, array->Length);
+            break;
+    }
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Min
+ * \desc Gets the smallest element of a typed array.
+ * \param array (TypedArray): The typed array.
+ * \return Returns the smallest element, or <code>null</code> if the array is empty.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Min(int argCount, VMValue* args, Uint32 threadID) {
     CHECK_ARGCOUNT(1);
-    SDL_Delay(GET_ARG(0, GetInteger));
+    ObjTypedArray* array = GET_ARG(0, GetTypedArray);
+    if (!array->Length)
+        return NULL_VAL;
+
+    switch (array->ElementType) {
+        case TYPEDARRAY_INT32:
+            return INTEGER_VAL(TypedArray_MinLoop((Sint32*)array->Data, array->Length));
+        case TYPEDARRAY_FLOAT32:
+            return DECIMAL_VAL(TypedArray_MinLoop((float*)array->Data, array->Length));
+        case TYPEDARRAY_UINT8:
+            return INTEGER_VAL(TypedArray_MinLoop((Uint8*)array->Data, array->Length));
+    }
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Max
+ * \desc Gets the largest element of a typed array.
+ * \param array (TypedArray): The typed array.
+ * \return Returns the largest element, or <code>null</code> if the array is empty.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Max(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    ObjTypedArray* array = GET_ARG(0, GetTypedArray);
+    if (!array->Length)
+        return NULL_VAL;
+
+    switch (array->ElementType) {
+        case TYPEDARRAY_INT32:
+            return INTEGER_VAL(TypedArray_MaxLoop((Sint32*)array->Data, array->Length));
+        case TYPEDARRAY_FLOAT32:
+            return DECIMAL_VAL(TypedArray_MaxLoop((float*)array->Data, array->Length));
+        case TYPEDARRAY_UINT8:
+            return INTEGER_VAL(TypedArray_MaxLoop((Uint8*)array->Data, array->Length));
+    }
+    return NULL_VAL;
+}
+/***
+ * TypedArray.Sum
+ * \desc Adds up the elements of a typed array.
+ * \param array (TypedArray): The typed array.
+ * \return Returns an Integer value, or a Decimal value for a <code>TypedArray_FLOAT32</code> array.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Sum(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(1);
+    ObjTypedArray* array = GET_ARG(0, GetTypedArray);
+
+    if (array->ElementType == TYPEDARRAY_FLOAT32) {
+        float sum = TypedArray_SumLoop<float, float>((float*)array->Data, array->Length);
+        return DECIMAL_VAL(sum);
+    }
+
+    Sint64 sum;
+    if (array->ElementType == TYPEDARRAY_UINT8)
+        sum = TypedArray_SumLoop<Uint8, Uint32>((Uint8*)array->Data, array->Length);
+    else
+        sum = TypedArray_SumLoop<Sint32, Sint64>((Sint32*)array->Data, array->Length);
+    return INTEGER_VAL((int)sum);
+}
+/***
+ * TypedArray.Lerp
+ * \desc Linearly interpolates between the elements of two typed arrays. The destination may be one of the two.
+ * \param dest (TypedArray): The typed array to write to.
+ * \param a (TypedArray): The typed array to interpolate from.
+ * \param b (TypedArray): The typed array to interpolate to.
+ * \param t (Decimal): How far to interpolate, from 0.0 to 1.0.
+ * \ns TypedArray
+ */
+VMValue TypedArray_Lerp(int argCount, VMValue* args, Uint32 threadID) {
+    CHECK_ARGCOUNT(4);
+    ObjTypedArray* dest = GET_ARG(0, GetTypedArray);
+    ObjTypedArray* a = GET_ARG(1, GetTypedArray);
+    ObjTypedArray* b = GET_ARG(2, GetTypedArray);
+    float t = GET_ARG(3, GetDecimal);
+    if (!TypedArray_CheckSame(dest, a, threadID) || !TypedArray_CheckSame(dest, b, threadID))
+        return NULL_VAL;
+
+    switch (dest->ElementType) {
+        case TYPEDARRAY_INT32:
+            TypedArray_LerpLoop((Sint32*)dest->Data, (Sint32*)a->Data, (Sint32*)b->Data, t, dest->Length);
+            break;
+        case TYPEDARRAY_FLOAT32:
+            TypedArray_LerpLoop((float*)dest->Data, (float*)a->Data, (float*)b->Data, t, dest->Length);
+            break;
+        case TYPEDARRAY_UINT8:
+            TypedArray_LerpLoop((Uint8*)dest->Data, (Uint8*)a->Data, (Uint8*)b->Data, t, dest->Length);
+            break;
+    }
     return NULL_VAL;
 }
 // #endregion
@@ -15145,10 +16039,10 @@ static VMValue XML_FillMap(XMLNode* parent) {
  */
 VMValue XML_Parse(int argCount, VMValue* args, Uint32 threadID) {
     CHECK_ARGCOUNT(1);
+    char* xmlText = GET_ARG(0, GetString);
     VMValue mapValue = NULL_VAL;
     if (ScriptManager::Lock()) {
-        ObjString* string = AS_STRING(args[0]);
-        char* text = StringUtils::Duplicate(string->Chars);
+        char* text = StringUtils::Duplicate(xmlText);
 
         MemoryStream* stream = MemoryStream::New(text, strlen(text));
         if (stream) {
@@ -15229,6 +16123,8 @@ PUBLIC STATIC void StandardLibrary::Link() {
         ns_##nsName->Fields->Put(klass->Hash, OBJECT_VAL(klass))
     #define DEF_NAMESPACED_NATIVE(className, funcName) \
         ScriptManager::DefineNative(klass, #funcName, className##_##funcName)
+    #define TYPED_NATIVE(className, funcName) \
+        { NativeHash(#funcName), BIND_NATIVE(className##_##funcName) }
 
     INIT_NAMESPACE(RSDK);
 
@@ -15343,6 +16239,11 @@ PUBLIC STATIC void StandardLibrary::Link() {
     * \desc App quit keybind. (dev)
     */
     DEF_ENUM_CLASS(KeyBind, DevQuit);
+    /***
+    * \enum KeyBind_DevProfiler
+    * \desc Script profiler toggle keybind. (dev)
+    */
+    DEF_ENUM_CLASS(KeyBind, DevProfiler);
     // #endregion
 
     // #region Audio
@@ -15368,6 +16269,7 @@ PUBLIC STATIC void StandardLibrary::Link() {
     DEF_NATIVE(Array, SetAll);
     DEF_NATIVE(Array, Reverse);
     DEF_NATIVE(Array, Sort);
+    DEF_NATIVE(Array, SortBy);
     // #endregion
 
     // #region Controller
@@ -16473,6 +17375,9 @@ PUBLIC STATIC void StandardLibrary::Link() {
     DEF_NATIVE(Instance, GetCount);
     DEF_NATIVE(Instance, GetNextInstance);
     DEF_NATIVE(Instance, GetBySlotID);
+    DEF_NATIVE(Instance, GetHandle);
+    DEF_NATIVE(Instance, GetByHandle);
+    DEF_NATIVE(Instance, GetOverlapping);
     DEF_NATIVE(Instance, DisableAutoAnimate);
     DEF_NATIVE(Instance, Copy);
     DEF_NATIVE(Instance, ChangeClass);
@@ -16503,55 +17408,61 @@ PUBLIC STATIC void StandardLibrary::Link() {
 
     // #region Math
     INIT_CLASS(Math);
-    DEF_NATIVE(Math, Cos);
-    DEF_NATIVE(Math, Sin);
-    DEF_NATIVE(Math, Tan);
-    DEF_NATIVE(Math, Acos);
-    DEF_NATIVE(Math, Asin);
-    DEF_NATIVE(Math, Atan);
-    DEF_NATIVE(Math, Distance);
-    DEF_NATIVE(Math, Direction);
-    DEF_NATIVE(Math, Abs);
-    DEF_NATIVE(Math, Min);
-    DEF_NATIVE(Math, Max);
-    DEF_NATIVE(Math, Clamp);
-    DEF_NATIVE(Math, Sign);
-    DEF_NATIVE(Math, Random);
-    DEF_NATIVE(Math, RandomMax);
-    DEF_NATIVE(Math, RandomRange);
-    DEF_NATIVE(Math, GetRandSeed);
-    DEF_NATIVE(Math, SetRandSeed);
-    DEF_NATIVE(Math, RandomInteger);
-    DEF_NATIVE(Math, RandomIntegerSeeded);
-    DEF_NATIVE(Math, Floor);
-    DEF_NATIVE(Math, Ceil);
-    DEF_NATIVE(Math, Round);
-    DEF_NATIVE(Math, Sqrt);
-    DEF_NATIVE(Math, Pow);
-    DEF_NATIVE(Math, Exp);
+    static const NativeDef mathNatives[] = {
+        TYPED_NATIVE(Math, Cos),
+        TYPED_NATIVE(Math, Sin),
+        TYPED_NATIVE(Math, Tan),
+        TYPED_NATIVE(Math, Acos),
+        TYPED_NATIVE(Math, Asin),
+        TYPED_NATIVE(Math, Atan),
+        TYPED_NATIVE(Math, Distance),
+        TYPED_NATIVE(Math, Direction),
+        TYPED_NATIVE(Math, Abs),
+        TYPED_NATIVE(Math, Min),
+        TYPED_NATIVE(Math, Max),
+        TYPED_NATIVE(Math, Clamp),
+        TYPED_NATIVE(Math, Sign),
+        TYPED_NATIVE(Math, Random),
+        TYPED_NATIVE(Math, RandomMax),
+        TYPED_NATIVE(Math, RandomRange),
+        TYPED_NATIVE(Math, GetRandSeed),
+        TYPED_NATIVE(Math, SetRandSeed),
+        TYPED_NATIVE(Math, RandomInteger),
+        { NativeHash("RandomIntegerSeeded"), Math_RandomIntegerSeeded },
+        TYPED_NATIVE(Math, Floor),
+        TYPED_NATIVE(Math, Ceil),
+        TYPED_NATIVE(Math, Round),
+        TYPED_NATIVE(Math, Sqrt),
+        TYPED_NATIVE(Math, Pow),
+        TYPED_NATIVE(Math, Exp),
+    };
+    ScriptManager::DefineNatives(klass, mathNatives, SDL_arraysize(mathNatives));
     // #endregion
 
     // #region RSDK.Math
     INIT_NAMESPACED_CLASS(RSDK, Math);
-    DEF_NAMESPACED_NATIVE(Math, ClearTrigLookupTables);
-    DEF_NAMESPACED_NATIVE(Math, CalculateTrigAngles);
-    DEF_NAMESPACED_NATIVE(Math, Sin1024);
-    DEF_NAMESPACED_NATIVE(Math, Cos1024);
-    DEF_NAMESPACED_NATIVE(Math, Tan1024);
-    DEF_NAMESPACED_NATIVE(Math, ASin1024);
-    DEF_NAMESPACED_NATIVE(Math, ACos1024);
-    DEF_NAMESPACED_NATIVE(Math, Sin512);
-    DEF_NAMESPACED_NATIVE(Math, Cos512);
-    DEF_NAMESPACED_NATIVE(Math, Tan512);
-    DEF_NAMESPACED_NATIVE(Math, ASin512);
-    DEF_NAMESPACED_NATIVE(Math, ACos512);
-    DEF_NAMESPACED_NATIVE(Math, Sin256);
-    DEF_NAMESPACED_NATIVE(Math, Cos256);
-    DEF_NAMESPACED_NATIVE(Math, Tan256);
-    DEF_NAMESPACED_NATIVE(Math, ASin256);
-    DEF_NAMESPACED_NATIVE(Math, ACos256);
-    DEF_NAMESPACED_NATIVE(Math, RadianToInteger);
-    DEF_NAMESPACED_NATIVE(Math, IntegerToRadian);
+    static const NativeDef rsdkMathNatives[] = {
+        TYPED_NATIVE(Math, ClearTrigLookupTables),
+        TYPED_NATIVE(Math, CalculateTrigAngles),
+        TYPED_NATIVE(Math, Sin1024),
+        TYPED_NATIVE(Math, Cos1024),
+        TYPED_NATIVE(Math, Tan1024),
+        TYPED_NATIVE(Math, ASin1024),
+        TYPED_NATIVE(Math, ACos1024),
+        TYPED_NATIVE(Math, Sin512),
+        TYPED_NATIVE(Math, Cos512),
+        TYPED_NATIVE(Math, Tan512),
+        TYPED_NATIVE(Math, ASin512),
+        TYPED_NATIVE(Math, ACos512),
+        TYPED_NATIVE(Math, Sin256),
+        TYPED_NATIVE(Math, Cos256),
+        TYPED_NATIVE(Math, Tan256),
+        TYPED_NATIVE(Math, ASin256),
+        TYPED_NATIVE(Math, ACos256),
+        TYPED_NATIVE(Math, RadianToInteger),
+        TYPED_NATIVE(Math, IntegerToRadian),
+    };
+    ScriptManager::DefineNatives(klass, rsdkMathNatives, SDL_arraysize(rsdkMathNatives));
     // #endregion
 
     // #region Matrix
@@ -16642,6 +17553,15 @@ PUBLIC STATIC void StandardLibrary::Link() {
     DEF_NATIVE(Palette, SetPaletteIndexLines);
     // #endregion
 
+    // #region Profiler
+    INIT_CLASS(Profiler);
+    DEF_NATIVE(Profiler, Start);
+    DEF_NATIVE(Profiler, Stop);
+    DEF_NATIVE(Profiler, IsRunning);
+    DEF_NATIVE(Profiler, SaveCollapsedStacks);
+    DEF_NATIVE(Profiler, SaveChromeTrace);
+    // #endregion
+
     // #region Resources
     INIT_CLASS(Resources);
     DEF_NATIVE(Resources, LoadSprite);
@@ -16675,6 +17595,7 @@ PUBLIC STATIC void StandardLibrary::Link() {
     DEF_NATIVE(Scene, CheckObjectCollisionCircle);
     DEF_NATIVE(Scene, CheckObjectCollisionBox);
     DEF_NATIVE(Scene, CheckObjectCollisionPlatform);
+    DEF_NATIVE(Scene, GetInstancesInRegion);
     DEF_NATIVE(Scene, Load);
     DEF_NATIVE(Scene, LoadNoPersistency);
     DEF_NATIVE(Scene, LoadPosition);
@@ -16998,6 +17919,8 @@ PUBLIC STATIC void StandardLibrary::Link() {
     DEF_NATIVE(Stream, WriteInt64);
     DEF_NATIVE(Stream, WriteFloat);
     DEF_NATIVE(Stream, WriteString);
+    DEF_NATIVE(Stream, ReadTypedArray);
+    DEF_NATIVE(Stream, WriteTypedArray);
     /***
     * \enum FileStream_READ_ACCESS
     * \desc Read file access mode. (<code>rb</code>)
@@ -17031,6 +17954,16 @@ PUBLIC STATIC void StandardLibrary::Link() {
     DEF_NATIVE(String, ParseDecimal);
     // #endregion
 
+    // #region StringBuilder
+    INIT_CLASS(StringBuilder);
+    DEF_NATIVE(StringBuilder, Create);
+    DEF_NATIVE(StringBuilder, Append);
+    DEF_NATIVE(StringBuilder, Insert);
+    DEF_NATIVE(StringBuilder, Length);
+    DEF_NATIVE(StringBuilder, Clear);
+    DEF_NATIVE(StringBuilder, ToString);
+    // #endregion
+
     // #region Texture
     INIT_CLASS(Texture);
     DEF_NATIVE(Texture, Create);
@@ -17087,9 +18020,42 @@ PUBLIC STATIC void StandardLibrary::Link() {
     // #region Thread
     INIT_CLASS(Thread);
     DEF_NATIVE(Thread, RunEvent);
+    DEF_NATIVE(Thread, IsDone);
+    DEF_NATIVE(Thread, Join);
     DEF_NATIVE(Thread, Sleep);
     // #endregion
 
+    // #region TypedArray
+    INIT_CLASS(TypedArray);
+    DEF_NATIVE(TypedArray, Create);
+    DEF_NATIVE(TypedArray, FromArray);
+    DEF_NATIVE(TypedArray, ToArray);
+    DEF_NATIVE(TypedArray, Length);
+    DEF_NATIVE(TypedArray, Fill);
+    DEF_NATIVE(TypedArray, Copy);
+    DEF_NATIVE(TypedArray, Add);
+    DEF_NATIVE(TypedArray, Scale);
+    DEF_NATIVE(TypedArray, Min);
+    DEF_NATIVE(TypedArray, Max);
+    DEF_NATIVE(TypedArray, Sum);
+    DEF_NATIVE(TypedArray, Lerp);
+    /***
+    * \enum TypedArray_INT32
+    * \desc Elements are signed 32-bit integers.
+    */
+    DEF_CONST_INT("TypedArray_INT32", TYPEDARRAY_INT32);
+    /***
+    * \enum TypedArray_FLOAT32
+    * \desc Elements are 32-bit floating point numbers.
+    */
+    DEF_CONST_INT("TypedArray_FLOAT32", TYPEDARRAY_FLOAT32);
+    /***
+    * \enum TypedArray_UINT8
+    * \desc Elements are unsigned 8-bit integers.
+    */
+    DEF_CONST_INT("TypedArray_UINT8", TYPEDARRAY_UINT8);
+    // #endregion
+
     // #region VertexBuffer
     INIT_CLASS(VertexBuffer);
     DEF_NATIVE(VertexBuffer, Create);
@@ -17189,6 +18155,7 @@ PUBLIC STATIC void StandardLibrary::Link() {
     // #endregion
 
     #undef DEF_NATIVE
+    #undef TYPED_NATIVE
     #undef INIT_CLASS
 
     /***
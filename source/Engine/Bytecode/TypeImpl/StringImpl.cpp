@@ -69,6 +69,13 @@ PUBLIC STATIC bool StringImpl::VM_ElementSet(Obj* object, VMValue at, VMValue va
         return true;
     }
 
+    // Strings in the intern table are shared by every literal, name and
+    // type string with the same text, so changing one would change all
+    if (string->IsInterned) {
+        THROW_ERROR("Cannot modify a string literal or name. Modify a copy of it instead.");
+        return true;
+    }
+
     if (IS_INTEGER(value)) {
         int chr = AS_INTEGER(value);
         string->Chars[index] = (Uint8)chr;
@@ -84,5 +91,7 @@ PUBLIC STATIC bool StringImpl::VM_ElementSet(Obj* object, VMValue at, VMValue va
         THROW_ERROR("Cannot modify string character using non-Integer or non-String value.");
     }
 
+    string->Hash = Murmur::EncryptData(string->Chars, string->Length);
+
     return true;
 }
@@ -0,0 +1,131 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+#include <Engine/Bytecode/Types.h>
+
+class TypedArrayImpl {
+public:
+    static ObjClass *Class;
+};
+#endif
+
+#include <Engine/Bytecode/TypeImpl/TypedArrayImpl.h>
+#include <Engine/Bytecode/ScriptManager.h>
+#include <Engine/Bytecode/StandardLibrary.h>
+
+ObjClass* TypedArrayImpl::Class = nullptr;
+
+PUBLIC STATIC void TypedArrayImpl::Init() {
+    const char *name = "$$TypedArrayImpl";
+
+    Class = NewClass(Murmur::EncryptString(name));
+    Class->Name = CopyString(name);
+    Class->ElementGet = TypedArrayImpl::VM_ElementGet;
+    Class->ElementSet = TypedArrayImpl::VM_ElementSet;
+
+    ScriptManager::DefineNative(Class, "iterate", TypedArrayImpl::VM_Iterate);
+    ScriptManager::DefineNative(Class, "iteratorValue", TypedArrayImpl::VM_IteratorValue);
+
+    ScriptManager::ClassImplList.push_back(Class);
+}
+
+PUBLIC STATIC VMValue TypedArrayImpl::GetValue(ObjTypedArray* array, Uint32 index) {
+    switch (array->ElementType) {
+        case TYPEDARRAY_INT32:
+            return INTEGER_VAL(((Sint32*)array->Data)[index]);
+        case TYPEDARRAY_FLOAT32:
+            return DECIMAL_VAL(((float*)array->Data)[index]);
+        case TYPEDARRAY_UINT8:
+            return INTEGER_VAL(((Uint8*)array->Data)[index]);
+    }
+    return NULL_VAL;
+}
+// Returns false if the value isn't a number.
+PUBLIC STATIC bool TypedArrayImpl::SetValue(ObjTypedArray* array, Uint32 index, VMValue value) {
+    if (!IS_INTEGER(value) && !IS_DECIMAL(value))
+        return false;
+
+    switch (array->ElementType) {
+        case TYPEDARRAY_INT32:
+            ((Sint32*)array->Data)[index] = IS_INTEGER(value) ? AS_INTEGER(value) : (Sint32)AS_DECIMAL(value);
+            break;
+        case TYPEDARRAY_FLOAT32:
+            ((float*)array->Data)[index] = IS_DECIMAL(value) ? AS_DECIMAL(value) : (float)AS_INTEGER(value);
+            break;
+        case TYPEDARRAY_UINT8:
+            ((Uint8*)array->Data)[index] = IS_INTEGER(value) ? (Uint8)AS_INTEGER(value) : (Uint8)(Sint32)AS_DECIMAL(value);
+            break;
+    }
+    return true;
+}
+
+#define GET_ARG(argIndex, argFunction) (StandardLibrary::argFunction(args, argIndex, threadID))
+#define THROW_ERROR(...) ScriptManager::Threads[threadID].ThrowRuntimeError(false, __VA_ARGS__)
+
+PUBLIC STATIC bool TypedArrayImpl::VM_ElementGet(Obj* object, VMValue at, VMValue* result, Uint32 threadID) {
+    ObjTypedArray* array = (ObjTypedArray*)object;
+
+    if (result)
+        *result = NULL_VAL;
+
+    if (!IS_INTEGER(at)) {
+        THROW_ERROR("Cannot get value from array using non-Integer value as an index.");
+        return true;
+    }
+
+    int index = AS_INTEGER(at);
+    if (index < 0 || (Uint32)index >= array->Length) {
+        THROW_ERROR("Index %d is out of bounds of array of size %d.", index, (int)array->Length);
+        return true;
+    }
+
+    if (result)
+        *result = GetValue(array, index);
+    return true;
+}
+PUBLIC STATIC bool TypedArrayImpl::VM_ElementSet(Obj* object, VMValue at, VMValue value, Uint32 threadID) {
+    ObjTypedArray* array = (ObjTypedArray*)object;
+
+    if (!IS_INTEGER(at)) {
+        THROW_ERROR("Cannot set value from array using non-Integer value as an index.");
+        return true;
+    }
+
+    int index = AS_INTEGER(at);
+    if (index < 0 || (Uint32)index >= array->Length) {
+        THROW_ERROR("Index %d is out of bounds of array of size %d.", index, (int)array->Length);
+        return true;
+    }
+
+    if (!SetValue(array, index, value))
+        THROW_ERROR("Cannot store a %s value in a typed array.", GetValueTypeString(value));
+    return true;
+}
+
+PUBLIC STATIC VMValue TypedArrayImpl::VM_Iterate(int argCount, VMValue* args, Uint32 threadID) {
+    StandardLibrary::CheckArgCount(argCount, 2);
+
+    ObjTypedArray* array = GET_ARG(0, GetTypedArray);
+
+    if (array->Length && IS_NULL(args[1]))
+        return INTEGER_VAL(0);
+    else if (!IS_NULL(args[1])) {
+        int iteration = GET_ARG(1, GetInteger) + 1;
+        if (iteration >= 0 && (Uint32)iteration < array->Length)
+            return INTEGER_VAL(iteration);
+    }
+
+    return NULL_VAL;
+}
+
+PUBLIC STATIC VMValue TypedArrayImpl::VM_IteratorValue(int argCount, VMValue* args, Uint32 threadID) {
+    StandardLibrary::CheckArgCount(argCount, 2);
+
+    ObjTypedArray* array = GET_ARG(0, GetTypedArray);
+    int index = GET_ARG(1, GetInteger);
+    if (index < 0 || (Uint32)index >= array->Length) {
+        THROW_ERROR("Index %d is out of bounds of array of size %d.", index, (int)array->Length);
+        return NULL_VAL;
+    }
+
+    return GetValue(array, index);
+}
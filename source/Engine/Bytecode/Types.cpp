@@ -2,13 +2,15 @@
 
 #include <Engine/Bytecode/ScriptManager.h>
 #include <Engine/Bytecode/GarbageCollector.h>
+#include <Engine/Bytecode/ObjectPool.h>
 #include <Engine/Bytecode/TypeImpl/ArrayImpl.h>
 #include <Engine/Bytecode/TypeImpl/MapImpl.h>
 #include <Engine/Bytecode/TypeImpl/FunctionImpl.h>
 #include <Engine/Bytecode/TypeImpl/StringImpl.h>
+#include <Engine/Bytecode/TypeImpl/TypedArrayImpl.h>
 #include <Engine/Diagnostics/Log.h>
 #include <Engine/Diagnostics/Memory.h>
-#include <Engine/Hashing/FNV1A.h>
+#include <Engine/Hashing/Murmur.h>
 
 #define ALLOCATE_OBJ(type, objectType) \
     (type*)AllocateObject(sizeof(type), objectType)
@@ -18,15 +20,24 @@
 #define GROW_CAPACITY(val) ((val) < 8 ? 8 : val * 2)
 
 static Obj*       AllocateObject(size_t size, ObjType type) {
+    // Scripts may be compiled on worker threads, which allocate too
+    ScriptManager::Lock();
+
     // Only do this when allocating more memory
     GarbageCollector::GarbageSize += size;
+    GarbageCollector::NurserySize += size;
 
-    Obj* object = (Obj*)Memory::TrackedMalloc("AllocateObject", size);
+    Obj* object = (Obj*)ObjectPool::Alloc(size, type);
     object->Type = type;
     object->Class = nullptr;
     object->IsDark = false;
-    object->Next = GarbageCollector::RootObject;
-    GarbageCollector::RootObject = object;
+    object->IsGray = false;
+    object->IsOld = false;
+    object->IsRemembered = false;
+    object->Next = GarbageCollector::NurseryObject;
+    GarbageCollector::NurseryObject = object;
+
+    ScriptManager::Unlock();
 
     return object;
 }
@@ -37,18 +48,19 @@ static ObjString* AllocateString(char* chars, size_t length, Uint32 hash) {
     string->Length = length;
     string->Chars = chars;
     string->Hash = hash;
+    string->IsInterned = false;
     return string;
 }
 
 ObjString*        TakeString(char* chars, size_t length) {
-    Uint32 hash = FNV1A::EncryptData(chars, length);
+    Uint32 hash = Murmur::EncryptData(chars, length);
     return AllocateString(chars, length, hash);
 }
 ObjString*        TakeString(char* chars) {
     return TakeString(chars, strlen(chars));
 }
 ObjString*        CopyString(const char* chars, size_t length) {
-    Uint32 hash = FNV1A::EncryptData(chars, length);
+    Uint32 hash = Murmur::EncryptData(chars, length);
 
     char* heapChars = ALLOCATE(char, length + 1);
     memcpy(heapChars, chars, length);
@@ -83,6 +95,9 @@ ObjFunction*      NewFunction() {
     function->Module = NULL;
     function->Name = NULL;
     function->ClassName = NULL;
+    function->EncodedChunk = NULL;
+    function->HotCount = 0;
+    function->Compiled = NULL;
     function->Chunk.Init();
     return function;
 }
@@ -126,6 +141,7 @@ ObjClass*         NewClass(Uint32 hash) {
     klass->Type = CLASS_TYPE_NORMAL;
     klass->ParentHash = 0;
     klass->Parent = NULL;
+    ScriptManager::InvalidateInlineCaches();
     return klass;
 }
 ObjInstance*      NewInstance(ObjClass* klass) {
@@ -134,6 +150,7 @@ ObjInstance*      NewInstance(ObjClass* klass) {
     instance->Object.Class = klass;
     instance->Fields = new Table(NULL, 16);
     instance->EntityPtr = NULL;
+    instance->NativeFields = NULL;
     instance->PropertyGet = NULL;
     instance->PropertySet = NULL;
     return instance;
@@ -193,11 +210,53 @@ ObjModule*        NewModule() {
     module->SourceFilename = NULL;
     return module;
 }
+ObjTypedArray*    NewTypedArray(Uint8 elementType, Uint32 length) {
+    size_t size = length * GetTypedArrayElementSize(elementType);
+    void* data = Memory::TrackedCalloc("NewTypedArray::Data", size ? size : 1, 1);
+    if (!data)
+        return NULL;
+
+    ObjTypedArray* array = ALLOCATE_OBJ(ObjTypedArray, OBJ_TYPED_ARRAY);
+    Memory::Track(array, "NewTypedArray");
+    array->Object.Class = TypedArrayImpl::Class;
+    array->ElementType = elementType;
+    array->Length = length;
+    array->Data = data;
+
+    // The buffer is usually much bigger than the object, so count it
+    // towards the next collection too.
+    ScriptManager::Lock();
+    GarbageCollector::GarbageSize += size;
+    ScriptManager::Unlock();
+    return array;
+}
+ObjStringBuilder* NewStringBuilder(size_t capacity) {
+    if (capacity < 16)
+        capacity = 16;
+
+    // Allocated with malloc, since buffer_printf reallocs it
+    char* chars = (char*)malloc(capacity);
+    if (!chars)
+        return NULL;
+    chars[0] = '\0';
+
+    ObjStringBuilder* builder = ALLOCATE_OBJ(ObjStringBuilder, OBJ_STRING_BUILDER);
+    Memory::Track(builder, "NewStringBuilder");
+    builder->Chars = chars;
+    builder->Length = 0;
+    builder->Capacity = capacity;
+
+    // Counted like a typed array's buffer
+    ScriptManager::Lock();
+    GarbageCollector::GarbageSize += capacity;
+    ScriptManager::Unlock();
+    return builder;
+}
 
 bool              ValuesEqual(VMValue a, VMValue b) {
-    if (a.Type != b.Type) return false;
+    if (VALUE_TYPE(a) != VALUE_TYPE(b)) return false;
 
-    switch (a.Type) {
+    switch (VALUE_TYPE(a)) {
         case VAL_INTEGER: return AS_INTEGER(a) == AS_INTEGER(b);
         case VAL_DECIMAL: return AS_DECIMAL(a) == AS_DECIMAL(b);
         case VAL_OBJECT:  return AS_OBJECT(a) == AS_OBJECT(b);
@@ -250,14 +309,18 @@ const char*       GetObjectTypeString(Uint32 type) {
             return "Namespace";
         case OBJ_MODULE:
             return "Module";
+        case OBJ_TYPED_ARRAY:
+            return "Typed Array";
+        case OBJ_STRING_BUILDER:
+            return "String Builder";
     }
     return "Unknown Object Type";
 }
 const char*       GetValueTypeString(VMValue value) {
-    if (value.Type == VAL_OBJECT)
+    if (VALUE_TYPE(value) == VAL_OBJECT)
         return GetObjectTypeString(OBJECT_TYPE(value));
     else
-        return GetTypeString(value.Type);
+        return GetTypeString(VALUE_TYPE(value));
 }
 
 void              Chunk::Init() {
@@ -266,6 +329,8 @@ void              Chunk::Init() {
     Code = NULL;
     Lines = NULL;
     Constants = new vector<VMValue>();
+    CacheIndex = NULL;
+    Caches = NULL;
 }
 void              Chunk::Alloc() {
     if (!Code)
@@ -299,6 +364,15 @@ void              Chunk::Free() {
         Constants->shrink_to_fit();
         delete Constants;
     }
+
+    if (CacheIndex) {
+        Memory::Free(CacheIndex);
+        CacheIndex = NULL;
+    }
+    if (Caches) {
+        delete Caches;
+        Caches = NULL;
+    }
 }
 void              Chunk::Write(Uint8 byte, int line) {
     if (Capacity < Count + 1) {
@@ -314,3 +388,29 @@ int               Chunk::AddConstant(VMValue value) {
     Constants->push_back(value);
     return (int)Constants->size() - 1;
 }
+InlineCache*      Chunk::GetInlineCache(int offset) {
+    if (offset < 0 || offset >= Count)
+        return NULL;
+
+    // Call sites get their cache the first time they run,
+    // so chunks that never touch properties pay nothing.
+    if (!CacheIndex) {
+        CacheIndex = (Uint16*)Memory::TrackedCalloc("Chunk::CacheIndex", Count, sizeof(Uint16));
+        Caches = new vector<InlineCache>();
+    }
+
+    Uint16 index = CacheIndex[offset];
+    if (!index) {
+        if (Caches->size() >= 0xFFFF)
+            return NULL;
+
+        InlineCache cache;
+        memset(&cache, 0, sizeof(cache));
+        Caches->push_back(cache);
+
+        index = (Uint16)Caches->size();
+        CacheIndex[offset] = index;
+    }
+
+    return &(*Caches)[index - 1];
+}
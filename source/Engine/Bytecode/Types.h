@@ -2,17 +2,31 @@
 #define ENGINE_BYTECODE_TYPES_H
 
 #include <Engine/Includes/HashMap.h>
+#include <Engine/Includes/StandardSDL2.h>
 #include <Engine/IO/Stream.h>
 
 #define FRAMES_MAX 64
 #define STACK_SIZE_MAX (FRAMES_MAX * 256)
 #define THREAD_NAME_MAX 64
 
+// The baseline JIT only targets x86-64 Linux.
+#if defined(USING_VM_JIT) && !(defined(__x86_64__) && defined(LINUX))
+    #undef USING_VM_JIT
+#endif
+
 typedef enum {
     ERROR_RES_EXIT,
     ERROR_RES_CONTINUE,
 } ErrorResult;
 
+enum   ThreadReturnCodes {
+    INTERPRET_RUNTIME_ERROR = -100,
+    INTERPRET_GLOBAL_DOES_NOT_EXIST,
+    INTERPRET_GLOBAL_ALREADY_EXIST,
+    INTERPRET_FINISHED = -1,
+    INTERPRET_OK = 0,
+};
+
 typedef enum {
     VAL_NULL,
     VAL_INTEGER,
@@ -28,7 +42,23 @@ enum {
 };
 
 struct Obj;
+struct JITCode;
+
+#ifdef USING_COMPACT_VALUES
+// The type lives in the top 16 bits and the payload in the low 48.
+// Integers and decimals are 32-bit, and user-space pointers fit in 48
+// bits, so nothing needs NaN-boxing. Android on arm64 is the exception:
+// it tags heap pointers in the top byte, which the mask would drop.
+#if defined(ANDROID) && (defined(__aarch64__) || defined(__arm64__))
+#error "USING_COMPACT_VALUES is not supported on 64-bit ARM Android."
+#endif
+struct VMValue {
+    Uint64    Bits;
+};
 
+#define VALUE_TYPE_SHIFT 48
+#define VALUE_PAYLOAD_MASK 0xFFFFFFFFFFFFULL
+#else
 struct VMValue {
     Uint32    Type;
     union {
@@ -39,21 +69,64 @@ struct VMValue {
         float* LinkedDecimal;
     } as;
 };
+#endif
+
+#define INLINE_CACHE_WAYS 4
+
+#define NATIVE_FIELD_DIRECT 0xFFFFFFFF
+
+enum {
+    NATIVE_FIELD_MARKS_BOUNDS = 1 << 0 // Storing to it moves or resizes the entity
+};
+
+// A built-in field stored in the native object behind an instance,
+// shared by every instance of that native type. Fields the object keeps
+// elsewhere are found through a pointer stored in it, at Base.
+struct NativeField {
+    Uint32 Offset;
+    Uint32 Type; // VAL_LINKED_INTEGER or VAL_LINKED_DECIMAL
+    Uint32 Base; // NATIVE_FIELD_DIRECT if Offset is from the object itself
+    Uint32 Flags;
+};
+
+struct InlineCacheEntry {
+    struct ObjClass*  Class;
+    HashMap<VMValue>* Table; // NULL when the value is in the receiver's own fields
+    int               Slot;
+    bool              IsField;
+    bool              IsNative; // Slot is in the receiver's NativeFields
+    bool              OnInstance;
+    Uint32            Epoch;
+};
+struct InlineCache {
+    InlineCacheEntry Entries[INLINE_CACHE_WAYS];
+    Uint8            Count;
+    Uint8            Next;
+};
 
 struct Chunk {
-    int              Count;
-    int              Capacity;
-    Uint8*           Code;
-    Uint8*           Failsafe;
-    int*             Lines;
-    vector<VMValue>* Constants;
-    bool             OwnsMemory;
+    int                  Count;
+    int                  Capacity;
+    Uint8*               Code;
+    Uint8*               Failsafe;
+    int*                 Lines;
+    vector<VMValue>*     Constants;
+    bool                 OwnsMemory;
+    Uint16*              CacheIndex;
+    vector<InlineCache>* Caches;
+
+    void         Init();
+    void         Alloc();
+    void         Free();
+    void         Write(Uint8 byte, int line);
+    int          AddConstant(VMValue value);
+    InlineCache* GetInlineCache(int offset);
+};
 
-    void Init();
-    void Alloc();
-    void Free();
-    void Write(Uint8 byte, int line);
-    int  AddConstant(VMValue value);
+struct GlobalRef {
+    Uint32            Hash;
+    int               Slot;
+    HashMap<VMValue>* Table;
 };
 
 struct BytecodeContainer {
@@ -61,18 +134,49 @@ struct BytecodeContainer {
     size_t Size;
 };
 
+#define JOB_ARGS_MAX 8
+
+struct ScriptJob {
+    VMValue      Callback;
+    VMValue      Args[JOB_ARGS_MAX];
+    int          ArgCount;
+    VMValue      Result;
+    SDL_atomic_t State;
+    Uint32       Generation;
+};
+
 const char* GetTypeString(Uint32 type);
 const char* GetObjectTypeString(Uint32 type);
 const char* GetValueTypeString(VMValue value);
 
-#define IS_NULL(value)  ((value).Type == VAL_NULL)
-#define IS_INTEGER(value)  ((value).Type == VAL_INTEGER)
-#define IS_DECIMAL(value)  ((value).Type == VAL_DECIMAL)
-#define IS_OBJECT(value)   ((value).Type == VAL_OBJECT)
+#ifdef USING_COMPACT_VALUES
+    #define VALUE_TYPE(value)  ((Uint32)((value).Bits >> VALUE_TYPE_SHIFT))
+
+    static inline VMValue MAKE_VALUE(Uint32 type, Uint64 payload) { VMValue val; val.Bits = ((Uint64)type << VALUE_TYPE_SHIFT) | payload; return val; }
+    static inline int     VALUE_INTEGER(VMValue value) { return (int)(Uint32)value.Bits; }
+    static inline float   VALUE_DECIMAL(VMValue value) { union { Uint32 u; float f; } bits; bits.u = (Uint32)value.Bits; return bits.f; }
+    static inline void*   VALUE_POINTER(VMValue value) { return (void*)(uintptr_t)(value.Bits & VALUE_PAYLOAD_MASK); }
+
+    static inline VMValue INTEGER_VAL(int value) { return MAKE_VALUE(VAL_INTEGER, (Uint32)value); }
+    static inline VMValue DECIMAL_VAL(float value) { union { float f; Uint32 u; } bits; bits.f = value; return MAKE_VALUE(VAL_DECIMAL, bits.u); }
+    static inline VMValue OBJECT_VAL(void* value) { return MAKE_VALUE(VAL_OBJECT, (uintptr_t)value & VALUE_PAYLOAD_MASK); }
+    static inline VMValue INTEGER_LINK_VAL(int* value) { return MAKE_VALUE(VAL_LINKED_INTEGER, (uintptr_t)value & VALUE_PAYLOAD_MASK); }
+    static inline VMValue DECIMAL_LINK_VAL(float* value) { return MAKE_VALUE(VAL_LINKED_DECIMAL, (uintptr_t)value & VALUE_PAYLOAD_MASK); }
+    #define NULL_VAL           (VMValue { 0 })
+
+    #define AS_INTEGER(value)  (VALUE_TYPE(value) == VAL_INTEGER ? VALUE_INTEGER(value) : *(int*)VALUE_POINTER(value))
+    #define AS_DECIMAL(value)  (VALUE_TYPE(value) == VAL_DECIMAL ? VALUE_DECIMAL(value) : *(float*)VALUE_POINTER(value))
+    #define AS_OBJECT(value)   ((Obj*)VALUE_POINTER(value))
+    #define AS_LINKED_INTEGER(value)  (*(int*)VALUE_POINTER(value))
+    #define AS_LINKED_DECIMAL(value)  (*(float*)VALUE_POINTER(value))
+#else
+    #define VALUE_TYPE(value)  ((value).Type)
 
-#define AS_INTEGER(value)  (value.Type == VAL_INTEGER ? (value).as.Integer : *((value).as.LinkedInteger))
-#define AS_DECIMAL(value)  (value.Type == VAL_DECIMAL ? (value).as.Decimal : *((value).as.LinkedDecimal))
-#define AS_OBJECT(value)   ((value).as.Object)
+    #define AS_INTEGER(value)  (value.Type == VAL_INTEGER ? (value).as.Integer : *((value).as.LinkedInteger))
+    #define AS_DECIMAL(value)  (value.Type == VAL_DECIMAL ? (value).as.Decimal : *((value).as.LinkedDecimal))
+    #define AS_OBJECT(value)   ((value).as.Object)
+    #define AS_LINKED_INTEGER(value)  (*((value).as.LinkedInteger))
+    #define AS_LINKED_DECIMAL(value)  (*((value).as.LinkedDecimal))
 
 #ifdef WIN32
     #define NULL_VAL           (VMValue { })
@@ -89,17 +193,37 @@ const char* GetValueTypeString(VMValue value);
     #define INTEGER_LINK_VAL(value)  ((VMValue) { VAL_LINKED_INTEGER, { .LinkedInteger = value } })
     #define DECIMAL_LINK_VAL(value)  ((VMValue) { VAL_LINKED_DECIMAL, { .LinkedDecimal = value } })
 #endif
+#endif
 
-#define IS_LINKED_INTEGER(value) ((value).Type == VAL_LINKED_INTEGER)
-#define IS_LINKED_DECIMAL(value) ((value).Type == VAL_LINKED_DECIMAL)
-#define AS_LINKED_INTEGER(value)  (*((value).as.LinkedInteger))
-#define AS_LINKED_DECIMAL(value)  (*((value).as.LinkedDecimal))
+#define IS_NULL(value)     (VALUE_TYPE(value) == VAL_NULL)
+#define IS_INTEGER(value)  (VALUE_TYPE(value) == VAL_INTEGER)
+#define IS_DECIMAL(value)  (VALUE_TYPE(value) == VAL_DECIMAL)
+#define IS_OBJECT(value)   (VALUE_TYPE(value) == VAL_OBJECT)
+
+#define IS_LINKED_INTEGER(value) (VALUE_TYPE(value) == VAL_LINKED_INTEGER)
+#define IS_LINKED_DECIMAL(value) (VALUE_TYPE(value) == VAL_LINKED_DECIMAL)
+
+static inline Uint8* NATIVE_FIELD_PTR(void* base, NativeField field) {
+    Uint8* ptr = (Uint8*)base;
+    if (field.Base != NATIVE_FIELD_DIRECT)
+        ptr = *(Uint8**)(ptr + field.Base);
+    return ptr + field.Offset;
+}
+#define NATIVE_FIELD_VAL(base, field) ((field).Type == VAL_LINKED_INTEGER \
+    ? INTEGER_LINK_VAL((int*)NATIVE_FIELD_PTR(base, field)) \
+    : DECIMAL_LINK_VAL((float*)NATIVE_FIELD_PTR(base, field)))
 
 #define IS_NUMBER(value)        (IS_DECIMAL(value) || IS_INTEGER(value) || IS_LINKED_DECIMAL(value) || IS_LINKED_INTEGER(value))
 #define IS_NOT_NUMBER(value)    (!IS_DECIMAL(value) && !IS_INTEGER(value) && !IS_LINKED_DECIMAL(value) && !IS_LINKED_INTEGER(value))
 
 typedef VMValue (*NativeFn)(int argCount, VMValue* args, Uint32 threadID);
 
+// An entry in a static table of natives, with the name already hashed
+struct NativeDef {
+    Uint32   Hash;
+    NativeFn Function;
+};
+
 typedef bool (*ValueGetFn)(Obj* object, Uint32 hash, VMValue* value, Uint32 threadID);
 typedef bool (*ValueSetFn)(Obj* object, Uint32 hash, VMValue value, Uint32 threadID);
 
@@ -120,6 +244,8 @@ typedef bool (*StructSetFn)(Obj* object, VMValue at, VMValue value, Uint32 threa
 #define IS_NAMESPACE(value)     IsObjectType(value, OBJ_NAMESPACE)
 #define IS_ENUM(value)          IsObjectType(value, OBJ_ENUM)
 #define IS_MODULE(value)        IsObjectType(value, OBJ_MODULE)
+#define IS_TYPED_ARRAY(value)   IsObjectType(value, OBJ_TYPED_ARRAY)
+#define IS_STRING_BUILDER(value) IsObjectType(value, OBJ_STRING_BUILDER)
 
 #define AS_BOUND_METHOD(value)  ((ObjBoundMethod*)AS_OBJECT(value))
 #define AS_CLASS(value)         ((ObjClass*)AS_OBJECT(value))
@@ -135,6 +261,8 @@ typedef bool (*StructSetFn)(Obj* object, VMValue at, VMValue value, Uint32 threa
 #define AS_NAMESPACE(value)     ((ObjNamespace*)AS_OBJECT(value))
 #define AS_ENUM(value)          ((ObjEnum*)AS_OBJECT(value))
 #define AS_MODULE(value)        ((ObjModule*)AS_OBJECT(value))
+#define AS_TYPED_ARRAY(value)   ((ObjTypedArray*)AS_OBJECT(value))
+#define AS_STRING_BUILDER(value) ((ObjStringBuilder*)AS_OBJECT(value))
 
 enum ObjType {
     OBJ_BOUND_METHOD,
@@ -150,16 +278,29 @@ enum ObjType {
     OBJ_STREAM,
     OBJ_NAMESPACE,
     OBJ_ENUM,
-    OBJ_MODULE
+    OBJ_MODULE,
+    OBJ_TYPED_ARRAY,
+    OBJ_STRING_BUILDER
 };
 
-#define MAX_OBJ_TYPE (OBJ_MODULE + 1)
+#define MAX_OBJ_TYPE (OBJ_STRING_BUILDER + 1)
+
+enum TypedArrayType {
+    TYPEDARRAY_INT32,
+    TYPEDARRAY_FLOAT32,
+    TYPEDARRAY_UINT8,
+
+    MAX_TYPEDARRAY_TYPE
+};
 
 typedef HashMap<VMValue> Table;
 
 struct Obj {
     ObjType          Type;
     bool             IsDark;
+    bool             IsGray;
+    bool             IsOld;
+    bool             IsRemembered;
     struct ObjClass* Class;
     struct Obj*      Next;
 };
@@ -168,6 +309,7 @@ struct ObjString {
     size_t Length;
     char*  Chars;
     Uint32 Hash;
+    bool   IsInterned;
 };
 struct ObjModule {
     Obj                          Object;
@@ -185,6 +327,11 @@ struct ObjFunction {
     ObjString*   Name;
     ObjString*   ClassName;
     Uint32       NameHash;
+    // Where to decode Chunk from on first call, if it came from a bundle
+    const Uint8* EncodedChunk;
+    // Calls and loop iterations so far, until it gets compiled
+    Uint32       HotCount;
+    JITCode*     Compiled;
 };
 struct ObjNative {
     Obj      Object;
@@ -221,6 +368,7 @@ struct ObjInstance {
     Obj        Object;
     Table*     Fields;
     void*      EntityPtr;
+    HashMap<NativeField>* NativeFields; // Offsets from EntityPtr
     ValueGetFn PropertyGet;
     ValueSetFn PropertySet;
 };
@@ -257,6 +405,22 @@ struct ObjEnum {
     Uint32     Hash;
     Table*     Fields;
 };
+// A packed buffer of numbers, all of one TypedArrayType. It holds no
+// references, so the collector never looks inside Data.
+struct ObjTypedArray {
+    Obj    Object;
+    Uint8  ElementType;
+    Uint32 Length;
+    void*  Data;
+};
+// Text that can be appended to in place. Chars is always NUL-terminated,
+// so it can be read anywhere a string is expected.
+struct ObjStringBuilder {
+    Obj    Object;
+    char*  Chars;
+    size_t Length;
+    size_t Capacity;
+};
 
 ObjString*         TakeString(char* chars, size_t length);
 ObjString*         TakeString(char* chars);
@@ -277,11 +441,20 @@ ObjStream*         NewStream(Stream* streamPtr, bool writable);
 ObjNamespace*      NewNamespace(Uint32 hash);
 ObjEnum*           NewEnum(Uint32 hash);
 ObjModule*         NewModule();
+ObjTypedArray*     NewTypedArray(Uint8 elementType, Uint32 length);
+ObjStringBuilder*  NewStringBuilder(size_t capacity);
 
 #define FREE_OBJ(obj, type) \
     assert(GarbageCollector::GarbageSize >= sizeof(type)); \
     GarbageCollector::GarbageSize -= sizeof(type); \
-    Memory::Free(obj)
+    ObjectPool::Free(obj, sizeof(type))
+
+// Must follow any store of a value into a heap object's fields,
+// elements or locals while an incremental collection may be marking,
+// or while old objects have to remember what they point to.
+#define GC_WRITE_BARRIER(object) \
+    if (GarbageCollector::State == GarbageCollector::STATE_MARK || GarbageCollector::Generational) \
+        GarbageCollector::WriteBarrier((Obj*)(object))
 
 bool               ValuesEqual(VMValue a, VMValue b);
 
@@ -293,6 +466,10 @@ static inline bool HasInitializer(ObjClass* klass) {
     return !IS_NULL(klass->Initializer);
 }
 
+static inline size_t GetTypedArrayElementSize(Uint8 type) {
+    return type == TYPEDARRAY_UINT8 ? sizeof(Uint8) : sizeof(Uint32);
+}
+
 struct WithIter {
     void* entity;
     void* entityNext;
@@ -405,6 +582,26 @@ enum   OpCode {
     OP_SET_MODULE_LOCAL,
     OP_DEFINE_MODULE_LOCAL,
     OP_USE_NAMESPACE,
+    // Linked by ScriptManager::LinkGlobals
+    OP_GET_GLOBAL_SLOT,
+    OP_SET_GLOBAL_SLOT,
+    // Installed by VMThread after observing operand types
+    OP_ADD_INTEGER,
+    OP_SUBTRACT_INTEGER,
+    OP_MULTIPLY_INTEGER,
+    OP_LESS_INTEGER,
+    OP_GREATER_INTEGER,
+    OP_LESS_EQUAL_INTEGER,
+    OP_GREATER_EQUAL_INTEGER,
+    OP_ADD_DECIMAL,
+    OP_SUBTRACT_DECIMAL,
+    OP_MULTIPLY_DECIMAL,
+    OP_LESS_DECIMAL,
+    OP_GREATER_DECIMAL,
+    OP_LESS_EQUAL_DECIMAL,
+    OP_GREATER_EQUAL_DECIMAL,
+
+    OP_LAST = OP_GREATER_EQUAL_DECIMAL,
 
     OP_SYNC = 0xFF,
 };
@@ -33,8 +33,11 @@ public:
 #endif
 
 #include <Engine/Bytecode/VMThread.h>
+#include <Engine/Bytecode/BytecodeBundle.h>
+#include <Engine/Bytecode/JIT.h>
 #include <Engine/Bytecode/ScriptEntity.h>
 #include <Engine/Bytecode/ScriptManager.h>
+#include <Engine/Bytecode/GarbageCollector.h>
 #include <Engine/Bytecode/Compiler.h>
 #include <Engine/Bytecode/Values.h>
 #include <Engine/Diagnostics/Clock.h>
@@ -282,14 +285,6 @@ PUBLIC void    VMThread::ResetStack() {
 // #endregion
 
 // #region Instruction stuff
-enum   ThreadReturnCodes {
-    INTERPRET_RUNTIME_ERROR = -100,
-    INTERPRET_GLOBAL_DOES_NOT_EXIST,
-    INTERPRET_GLOBAL_ALREADY_EXIST,
-    INTERPRET_FINISHED = -1,
-    INTERPRET_OK = 0,
-};
-
 // NOTE: These should be inlined
 PUBLIC Uint8   VMThread::ReadByte(CallFrame* frame) {
     frame->IP += sizeof(Uint8);
@@ -394,6 +389,22 @@ PUBLIC int     VMThread::RunInstruction() {
             VM_ADD_DISPATCH(OP_SET_MODULE_LOCAL),
             VM_ADD_DISPATCH(OP_DEFINE_MODULE_LOCAL),
             VM_ADD_DISPATCH(OP_USE_NAMESPACE),
+            VM_ADD_DISPATCH(OP_GET_GLOBAL_SLOT),
+            VM_ADD_DISPATCH(OP_SET_GLOBAL_SLOT),
+            VM_ADD_DISPATCH(OP_ADD_INTEGER),
+            VM_ADD_DISPATCH(OP_SUBTRACT_INTEGER),
+            VM_ADD_DISPATCH(OP_MULTIPLY_INTEGER),
+            VM_ADD_DISPATCH(OP_LESS_INTEGER),
+            VM_ADD_DISPATCH(OP_GREATER_INTEGER),
+            VM_ADD_DISPATCH(OP_LESS_EQUAL_INTEGER),
+            VM_ADD_DISPATCH(OP_GREATER_EQUAL_INTEGER),
+            VM_ADD_DISPATCH(OP_ADD_DECIMAL),
+            VM_ADD_DISPATCH(OP_SUBTRACT_DECIMAL),
+            VM_ADD_DISPATCH(OP_MULTIPLY_DECIMAL),
+            VM_ADD_DISPATCH(OP_LESS_DECIMAL),
+            VM_ADD_DISPATCH(OP_GREATER_DECIMAL),
+            VM_ADD_DISPATCH(OP_LESS_EQUAL_DECIMAL),
+            VM_ADD_DISPATCH(OP_GREATER_EQUAL_DECIMAL),
             VM_ADD_DISPATCH_NULL(OP_SYNC),
         };
         #define VM_START(ins) goto *dispatch_table[(ins)];
@@ -490,6 +501,22 @@ PUBLIC int     VMThread::RunInstruction() {
                 PRINT_CASE(OP_SET_MODULE_LOCAL)
                 PRINT_CASE(OP_DEFINE_MODULE_LOCAL)
                 PRINT_CASE(OP_USE_NAMESPACE)
+                PRINT_CASE(OP_GET_GLOBAL_SLOT)
+                PRINT_CASE(OP_SET_GLOBAL_SLOT)
+                PRINT_CASE(OP_ADD_INTEGER)
+                PRINT_CASE(OP_SUBTRACT_INTEGER)
+                PRINT_CASE(OP_MULTIPLY_INTEGER)
+                PRINT_CASE(OP_LESS_INTEGER)
+                PRINT_CASE(OP_GREATER_INTEGER)
+                PRINT_CASE(OP_LESS_EQUAL_INTEGER)
+                PRINT_CASE(OP_GREATER_EQUAL_INTEGER)
+                PRINT_CASE(OP_ADD_DECIMAL)
+                PRINT_CASE(OP_SUBTRACT_DECIMAL)
+                PRINT_CASE(OP_MULTIPLY_DECIMAL)
+                PRINT_CASE(OP_LESS_DECIMAL)
+                PRINT_CASE(OP_GREATER_DECIMAL)
+                PRINT_CASE(OP_LESS_EQUAL_DECIMAL)
+                PRINT_CASE(OP_GREATER_EQUAL_DECIMAL)
 
                 default:
                     Log::Print(Log::LOG_ERROR, "Unknown opcode %d\n", frame->IP); break;
@@ -501,12 +528,19 @@ PUBLIC int     VMThread::RunInstruction() {
 
     VM_START(instruction = ReadByte(frame)) {
         // Globals (heap)
+        VM_CASE(OP_GET_GLOBAL_SLOT):
         VM_CASE(OP_GET_GLOBAL): {
             Uint32 hash = ReadUInt32(frame);
             if (ScriptManager::Lock()) {
                 VMValue result;
-                if (!ScriptManager::Globals->GetIfExists(hash, &result)
-                && !ScriptManager::Constants->GetIfExists(hash, &result)) {
+                bool exists;
+                if (instruction == OP_GET_GLOBAL_SLOT)
+                    exists = ScriptManager::ReadGlobalRef(hash, &hash, &result);
+                else
+                    exists = ScriptManager::Globals->GetIfExists(hash, &result)
+                        || ScriptManager::Constants->GetIfExists(hash, &result);
+
+                if (!exists) {
                     if (ThrowRuntimeError(false, "Variable %s does not exist.", GetVariableOrMethodName(hash)) == ERROR_RES_CONTINUE)
                         goto FAIL_OP_GET_GLOBAL;
                     Push(NULL_VAL);
@@ -523,10 +557,17 @@ PUBLIC int     VMThread::RunInstruction() {
             Push(NULL_VAL);
             VM_BREAK;
         }
+        VM_CASE(OP_SET_GLOBAL_SLOT):
         VM_CASE(OP_SET_GLOBAL): {
             Uint32 hash = ReadUInt32(frame);
             if (ScriptManager::Lock()) {
-                if (!ScriptManager::Globals->Exists(hash)) {
+                int slot;
+                if (instruction == OP_SET_GLOBAL_SLOT)
+                    slot = ScriptManager::GetGlobalRefSlot(hash, &hash);
+                else
+                    slot = ScriptManager::Globals->GetSlot(hash);
+
+                if (slot < 0) {
                     if (ScriptManager::Constants->Exists(hash)) {
                         // Can't do that
                         if (ThrowRuntimeError(false, "Cannot redefine constant %s!", GetVariableOrMethodName(hash)) == ERROR_RES_CONTINUE)
@@ -537,9 +578,9 @@ PUBLIC int     VMThread::RunInstruction() {
                     return INTERPRET_GLOBAL_DOES_NOT_EXIST;
                 }
 
-                VMValue LHS = ScriptManager::Globals->Get(hash);
+                VMValue LHS = ScriptManager::Globals->Data[slot].Data;
                 VMValue value = Peek(0);
-                switch (LHS.Type) {
+                switch (VALUE_TYPE(LHS)) {
                     case VAL_LINKED_INTEGER: {
                         VMValue result = ScriptManager::CastValueAsInteger(value);
                         if (IS_NULL(result)) {
@@ -561,7 +602,7 @@ PUBLIC int     VMThread::RunInstruction() {
                         break;
                     }
                     default:
-                        ScriptManager::Globals->Put(hash, value);
+                        ScriptManager::Globals->Data[slot].Data = value;
                 }
                 ScriptManager::Unlock();
             }
@@ -620,16 +661,41 @@ PUBLIC int     VMThread::RunInstruction() {
                 ObjInstance* instance = AS_INSTANCE(object);
 
                 if (ScriptManager::Lock()) {
+                    ObjClass* klass = instance->Object.Class;
+                    InlineCache* cache = GetInlineCache(frame);
+                    if (GetCachedProperty(cache, instance, klass, hash, &result)) {
+                        Pop();
+                        Push(result);
+                        ScriptManager::Unlock();
+                        VM_BREAK;
+                    }
+
+                    InlineCacheEntry found = { };
+                    found.Slot = -1;
+
                     // Fields have priority over methods
-                    if (instance->Fields->GetIfExists(hash, &result)) {
+                    found.Slot = instance->Fields->GetSlot(hash);
+                    if (found.Slot >= 0) {
+                        found.IsField = true;
+                        AddInlineCacheEntry(cache, klass, true, &found);
                         Pop();
-                        Push(ScriptManager::DelinkValue(result));
+                        Push(ScriptManager::DelinkValue(instance->Fields->Data[found.Slot].Data));
                         ScriptManager::Unlock();
                         VM_BREAK;
                     }
 
-                    ObjClass* klass = instance->Object.Class;
-                    if (GetProperty((Obj*)instance, klass, hash, false, instance->PropertyGet)) {
+                    if (instance->NativeFields && (found.Slot = instance->NativeFields->GetSlot(hash)) >= 0) {
+                        found.IsField = true;
+                        found.IsNative = true;
+                        AddInlineCacheEntry(cache, klass, true, &found);
+                        Pop();
+                        Push(ScriptManager::DelinkValue(NATIVE_FIELD_VAL(instance->EntityPtr, instance->NativeFields->Data[found.Slot].Data)));
+                        ScriptManager::Unlock();
+                        VM_BREAK;
+                    }
+
+                    if (GetProperty((Obj*)instance, klass, hash, false, instance->PropertyGet, &found)) {
+                        AddInlineCacheEntry(cache, klass, true, &found);
                         ScriptManager::Unlock();
                         VM_BREAK;
                     }
@@ -643,7 +709,19 @@ PUBLIC int     VMThread::RunInstruction() {
                 ObjClass* klass = AS_CLASS(object);
 
                 if (ScriptManager::Lock()) {
-                    if (GetProperty((Obj*)klass, klass, hash)) {
+                    InlineCache* cache = GetInlineCache(frame);
+                    if (GetCachedProperty(cache, nullptr, klass, hash, &result)) {
+                        Pop();
+                        Push(result);
+                        ScriptManager::Unlock();
+                        VM_BREAK;
+                    }
+
+                    InlineCacheEntry found = { };
+                    found.Slot = -1;
+
+                    if (GetProperty((Obj*)klass, klass, hash, true, klass->PropertyGet, &found)) {
+                        AddInlineCacheEntry(cache, klass, false, &found);
                         ScriptManager::Unlock();
                         VM_BREAK;
                     }
@@ -673,7 +751,19 @@ PUBLIC int     VMThread::RunInstruction() {
                 ObjClass* klass = AS_OBJECT(object)->Class;
 
                 if (ScriptManager::Lock()) {
-                    if (GetProperty((Obj*)klass, klass, hash)) {
+                    InlineCache* cache = GetInlineCache(frame);
+                    if (GetCachedProperty(cache, nullptr, klass, hash, &result)) {
+                        Pop();
+                        Push(result);
+                        ScriptManager::Unlock();
+                        VM_BREAK;
+                    }
+
+                    InlineCacheEntry found = { };
+                    found.Slot = -1;
+
+                    if (GetProperty((Obj*)klass, klass, hash, true, klass->PropertyGet, &found)) {
+                        AddInlineCacheEntry(cache, klass, false, &found);
                         ScriptManager::Unlock();
                         VM_BREAK;
                     }
@@ -697,10 +787,10 @@ PUBLIC int     VMThread::RunInstruction() {
         }
         VM_CASE(OP_SET_PROPERTY): {
             Uint32 hash = ReadUInt32(frame);
-            VMValue field;
             VMValue value;
             VMValue object;
             Table* fields;
+            HashMap<NativeField>* natives = nullptr;
             ObjClass* klass;
             Obj* objPtr;
             ValueSetFn setter = nullptr;
@@ -711,6 +801,7 @@ PUBLIC int     VMThread::RunInstruction() {
                 ObjInstance* instance = AS_INSTANCE(object);
                 klass = instance->Object.Class;
                 fields = instance->Fields;
+                natives = instance->NativeFields;
                 setter = instance->PropertySet;
                 objPtr = (Obj*)instance;
             }
@@ -736,8 +827,41 @@ PUBLIC int     VMThread::RunInstruction() {
             if (ScriptManager::Lock()) {
                 value = Pop();
 
-                if (fields->GetIfExists(hash, &field)) {
-                    if (!SetProperty(fields, hash, field, value))
+                // Only the receiver's own fields are cached here, so
+                // a hit just needs the slot to still hold this key.
+                InlineCache* cache = GetInlineCache(frame);
+                InlineCacheEntry* entry = FindInlineCacheEntry(cache, klass, IS_INSTANCE(object));
+                int slot;
+                bool isNative = false;
+                if (entry && !entry->IsNative && fields->SlotHasKey(entry->Slot, hash))
+                    slot = entry->Slot;
+                else if (entry && entry->IsNative && natives && natives->SlotHasKey(entry->Slot, hash)) {
+                    slot = entry->Slot;
+                    isNative = true;
+                }
+                else {
+                    slot = fields->GetSlot(hash);
+                    if (slot < 0 && natives && (slot = natives->GetSlot(hash)) >= 0)
+                        isNative = true;
+                    if (slot >= 0) {
+                        InlineCacheEntry found = { };
+                        found.Slot = slot;
+                        found.IsField = true;
+                        found.IsNative = isNative;
+                        AddInlineCacheEntry(cache, klass, IS_INSTANCE(object), &found);
+                    }
+                }
+
+                if (isNative) {
+                    ObjInstance* instance = AS_INSTANCE(object);
+                    NativeField& native = natives->Data[slot].Data;
+                    if (!SetLinkedValue(NATIVE_FIELD_VAL(instance->EntityPtr, native), value))
+                        goto FAIL_OP_SET_PROPERTY;
+                    if (native.Flags & NATIVE_FIELD_MARKS_BOUNDS)
+                        ((Entity*)instance->EntityPtr)->MarkBoundsChanged();
+                }
+                else if (slot >= 0) {
+                    if (!SetProperty(fields, slot, value))
                         goto FAIL_OP_SET_PROPERTY;
                 }
                 else {
@@ -745,9 +869,14 @@ PUBLIC int     VMThread::RunInstruction() {
                         goto SUCCESS_OP_SET_PROPERTY;
 
                     fields->Put(hash, value);
+
+                    // A new class field can shadow a cached parent value
+                    if (!IS_INSTANCE(object))
+                        ScriptManager::InvalidateInlineCaches();
                 }
 
 SUCCESS_OP_SET_PROPERTY:
+                GC_WRITE_BARRIER(objPtr);
                 Pop(); // Instance / Class
                 Push(value);
                 ScriptManager::Unlock();
@@ -772,7 +901,8 @@ SUCCESS_OP_SET_PROPERTY:
 
                 if (ScriptManager::Lock()) {
                     // Fields have priority over methods
-                    if (instance->Fields->Exists(hash)) {
+                    if (instance->Fields->Exists(hash)
+                        || (instance->NativeFields && instance->NativeFields->Exists(hash))) {
                         Pop();
                         Push(INTEGER_VAL(true));
                         ScriptManager::Unlock();
@@ -874,7 +1004,7 @@ SUCCESS_OP_SET_PROPERTY:
                             goto FAIL_OP_GET_ELEMENT;
                     }
 
-                    if (!map->Values->GetIfExists(index, &result)) {
+                    if (!map->Values->GetIfExists(GetMapKeyHash(map, AS_STRING(at)), &result)) {
                         goto FAIL_OP_GET_ELEMENT;
                     }
 
@@ -925,6 +1055,7 @@ SUCCESS_OP_SET_PROPERTY:
                             goto FAIL_OP_SET_ELEMENT;
                     }
                     (*array->Values)[index] = value;
+                    GC_WRITE_BARRIER(array);
                     ScriptManager::Unlock();
                 }
             }
@@ -942,8 +1073,10 @@ SUCCESS_OP_SET_PROPERTY:
                             goto FAIL_OP_SET_ELEMENT;
                     }
 
-                    map->Values->Put(index, value);
-                    map->Keys->Put(index, StringUtils::Duplicate(index));
+                    Uint32 hash = GetMapKeyHash(map, AS_STRING(at));
+                    map->Values->Put(hash, value);
+                    map->Keys->Put(hash, StringUtils::Duplicate(index));
+                    GC_WRITE_BARRIER(map);
                     ScriptManager::Unlock();
                 }
             }
@@ -951,6 +1084,7 @@ SUCCESS_OP_SET_PROPERTY:
                 if (IS_OBJECT(obj) && AS_OBJECT(obj)->Class) {
                     ObjClass* klass = AS_OBJECT(obj)->Class;
                     if (klass->ElementSet && klass->ElementSet(AS_OBJECT(obj), at, value, this->ID)) {
+                        GC_WRITE_BARRIER(AS_OBJECT(obj));
                         goto SUCCESS_OP_SET_ELEMENT;
                     }
                 }
@@ -1212,6 +1346,11 @@ SUCCESS_OP_SET_PROPERTY:
         VM_CASE(OP_JUMP_BACK): {
             Sint32 offset = ReadSInt16(frame);
             frame->IP -= offset;
+#ifdef USING_VM_JIT
+            // The loop carries on in compiled code from the next instruction
+            if (++frame->Function->HotCount == JIT::HOT_THRESHOLD)
+                JIT::Compile(frame->Function);
+#endif
             VM_BREAK;
         }
         VM_CASE(OP_JUMP_IF_FALSE): {
@@ -1223,9 +1362,9 @@ SUCCESS_OP_SET_PROPERTY:
         }
 
         // Numeric Operations
-        VM_CASE(OP_ADD):            Push(Values_Plus());  VM_BREAK;
-        VM_CASE(OP_SUBTRACT):       Push(Values_Minus());  VM_BREAK;
-        VM_CASE(OP_MULTIPLY):       Push(Values_Multiply());  VM_BREAK;
+        VM_CASE(OP_ADD):            Quicken(frame, OP_ADD_INTEGER, OP_ADD_DECIMAL); Push(Values_Plus());  VM_BREAK;
+        VM_CASE(OP_SUBTRACT):       Quicken(frame, OP_SUBTRACT_INTEGER, OP_SUBTRACT_DECIMAL); Push(Values_Minus());  VM_BREAK;
+        VM_CASE(OP_MULTIPLY):       Quicken(frame, OP_MULTIPLY_INTEGER, OP_MULTIPLY_DECIMAL); Push(Values_Multiply());  VM_BREAK;
         VM_CASE(OP_DIVIDE):         Push(Values_Division());  VM_BREAK;
         VM_CASE(OP_MODULO):         Push(Values_Modulo());  VM_BREAK;
         VM_CASE(OP_NEGATE):         Push(Values_Negate());  VM_BREAK;
@@ -1246,10 +1385,44 @@ SUCCESS_OP_SET_PROPERTY:
         // Equality and Comparison Operators
         VM_CASE(OP_EQUAL):          Push(INTEGER_VAL(ScriptManager::ValuesSortaEqual(Pop(), Pop()))); VM_BREAK;
         VM_CASE(OP_EQUAL_NOT):      Push(INTEGER_VAL(!ScriptManager::ValuesSortaEqual(Pop(), Pop()))); VM_BREAK;
-        VM_CASE(OP_LESS):           Push(Values_LessThan()); VM_BREAK;
-        VM_CASE(OP_GREATER):        Push(Values_GreaterThan()); VM_BREAK;
-        VM_CASE(OP_LESS_EQUAL):     Push(Values_LessThanOrEqual()); VM_BREAK;
-        VM_CASE(OP_GREATER_EQUAL):  Push(Values_GreaterThanOrEqual()); VM_BREAK;
+        VM_CASE(OP_LESS):           Quicken(frame, OP_LESS_INTEGER, OP_LESS_DECIMAL); Push(Values_LessThan()); VM_BREAK;
+        VM_CASE(OP_GREATER):        Quicken(frame, OP_GREATER_INTEGER, OP_GREATER_DECIMAL); Push(Values_GreaterThan()); VM_BREAK;
+        VM_CASE(OP_LESS_EQUAL):     Quicken(frame, OP_LESS_EQUAL_INTEGER, OP_LESS_EQUAL_DECIMAL); Push(Values_LessThanOrEqual()); VM_BREAK;
+        VM_CASE(OP_GREATER_EQUAL):  Quicken(frame, OP_GREATER_EQUAL_INTEGER, OP_GREATER_EQUAL_DECIMAL); Push(Values_GreaterThanOrEqual()); VM_BREAK;
+
+        // Quickened Operations
+        // These assume both operands have the type they were quickened for.
+        // If they don't, the instruction reverts to the generic opcode.
+        #define VM_QUICKENED(op, generic, type, field, wrap, oper, fallback) \
+            VM_CASE(op): { \
+                VMValue b = StackTop[-1]; \
+                VMValue a = StackTop[-2]; \
+                if (VALUE_TYPE(a) == type && VALUE_TYPE(b) == type) { \
+                    StackTop--; \
+                    StackTop[-1] = wrap(field(a) oper field(b)); \
+                    VM_BREAK; \
+                } \
+                *frame->IPLast = generic; \
+                Push(fallback); \
+                VM_BREAK; \
+            }
+
+        VM_QUICKENED(OP_ADD_INTEGER,           OP_ADD,           VAL_INTEGER, AS_INTEGER, INTEGER_VAL, +,  Values_Plus())
+        VM_QUICKENED(OP_SUBTRACT_INTEGER,      OP_SUBTRACT,      VAL_INTEGER, AS_INTEGER, INTEGER_VAL, -,  Values_Minus())
+        VM_QUICKENED(OP_MULTIPLY_INTEGER,      OP_MULTIPLY,      VAL_INTEGER, AS_INTEGER, INTEGER_VAL, *,  Values_Multiply())
+        VM_QUICKENED(OP_LESS_INTEGER,          OP_LESS,          VAL_INTEGER, AS_INTEGER, INTEGER_VAL, <,  Values_LessThan())
+        VM_QUICKENED(OP_GREATER_INTEGER,       OP_GREATER,       VAL_INTEGER, AS_INTEGER, INTEGER_VAL, >,  Values_GreaterThan())
+        VM_QUICKENED(OP_LESS_EQUAL_INTEGER,    OP_LESS_EQUAL,    VAL_INTEGER, AS_INTEGER, INTEGER_VAL, <=, Values_LessThanOrEqual())
+        VM_QUICKENED(OP_GREATER_EQUAL_INTEGER, OP_GREATER_EQUAL, VAL_INTEGER, AS_INTEGER, INTEGER_VAL, >=, Values_GreaterThanOrEqual())
+        VM_QUICKENED(OP_ADD_DECIMAL,           OP_ADD,           VAL_DECIMAL, AS_DECIMAL, DECIMAL_VAL, +,  Values_Plus())
+        VM_QUICKENED(OP_SUBTRACT_DECIMAL,      OP_SUBTRACT,      VAL_DECIMAL, AS_DECIMAL, DECIMAL_VAL, -,  Values_Minus())
+        VM_QUICKENED(OP_MULTIPLY_DECIMAL,      OP_MULTIPLY,      VAL_DECIMAL, AS_DECIMAL, DECIMAL_VAL, *,  Values_Multiply())
+        VM_QUICKENED(OP_LESS_DECIMAL,          OP_LESS,          VAL_DECIMAL, AS_DECIMAL, INTEGER_VAL, <,  Values_LessThan())
+        VM_QUICKENED(OP_GREATER_DECIMAL,       OP_GREATER,       VAL_DECIMAL, AS_DECIMAL, INTEGER_VAL, >,  Values_GreaterThan())
+        VM_QUICKENED(OP_LESS_EQUAL_DECIMAL,    OP_LESS_EQUAL,    VAL_DECIMAL, AS_DECIMAL, INTEGER_VAL, <=, Values_LessThanOrEqual())
+        VM_QUICKENED(OP_GREATER_EQUAL_DECIMAL, OP_GREATER_EQUAL, VAL_DECIMAL, AS_DECIMAL, INTEGER_VAL, >=, Values_GreaterThanOrEqual())
+
+        #undef VM_QUICKENED
         // typeof Operator
         VM_CASE(OP_TYPEOF):         Push(Value_TypeOf()); VM_BREAK;
 
@@ -1273,7 +1446,7 @@ SUCCESS_OP_SET_PROPERTY:
                 case WITH_STATE_INIT:
                 case WITH_STATE_INIT_SLOTTED: {
                     VMValue receiver = Peek(0);
-                    if (receiver.Type == VAL_NULL) {
+                    if (VALUE_TYPE(receiver) == VAL_NULL) {
                         frame->IP += offset;
                         Pop(); // pop receiver
                         break;
@@ -1526,7 +1699,7 @@ SUCCESS_OP_SET_PROPERTY:
             }
             else {
                 char* t = __Tokens__->Get(hash);
-                klass->Name = CopyString(t);
+                klass->Name = ScriptManager::InternString(t);
             }
 
             Push(OBJECT_VAL(klass));
@@ -1589,7 +1762,7 @@ SUCCESS_OP_SET_PROPERTY:
             }
             else {
                 char* t = __Tokens__->Get(hash);
-                enumeration->Name = CopyString(t);
+                enumeration->Name = ScriptManager::InternString(t);
             }
 
             Push(OBJECT_VAL(enumeration));
@@ -1622,6 +1795,7 @@ SUCCESS_OP_SET_PROPERTY:
             if (ScriptManager::Lock()) {
                 VMValue value = Pop();
                 enumeration->Fields->Put(hash, value);
+                GC_WRITE_BARRIER(enumeration);
                 Pop();
                 Push(value);
                 ScriptManager::Unlock();
@@ -1686,12 +1860,15 @@ SUCCESS_OP_SET_PROPERTY:
         }
         VM_CASE(OP_SET_MODULE_LOCAL): {
             Uint16 slot = ReadUInt16(frame);
-            if (slot < frame->Module->Locals->size())
+            if (slot < frame->Module->Locals->size()) {
                 (*frame->Module->Locals)[slot] = Peek(0);
+                GC_WRITE_BARRIER(frame->Module);
+            }
             VM_BREAK;
         }
         VM_CASE(OP_DEFINE_MODULE_LOCAL): {
             frame->Module->Locals->push_back(Pop());
+            GC_WRITE_BARRIER(frame->Module);
             VM_BREAK;
         }
 
@@ -1768,7 +1945,14 @@ PUBLIC void    VMThread::RunInstructionSet() {
         // if (!ScriptManager::Lock()) break;
 
         int ret;
-        if ((ret = RunInstruction()) < INTERPRET_OK) {
+#ifdef USING_VM_JIT
+        CallFrame* frame = &Frames[FrameCount - 1];
+        if (frame->Function->Compiled)
+            ret = JIT::Run(this, frame);
+        else
+#endif
+        ret = RunInstruction();
+        if (ret < INTERPRET_OK) {
             if (ret < INTERPRET_FINISHED)
                 Log::Print(Log::LOG_ERROR, "Error Code: %d!", ret);
             // ScriptManager::Unlock();
@@ -1859,24 +2043,37 @@ PUBLIC void    VMThread::CallInitializer(VMValue value) {
     FunctionToInvoke = NULL_VAL;
 }
 
-PRIVATE bool   VMThread::GetProperty(Obj* object, ObjClass* klass, Uint32 hash, bool checkFields, ValueGetFn getter) {
+PRIVATE bool   VMThread::GetProperty(Obj* object, ObjClass* klass, Uint32 hash, bool checkFields, ValueGetFn getter, InlineCacheEntry* cacheEntry) {
     if (ScriptManager::Lock()) {
         VMValue value;
+        int slot;
 
-        if (checkFields && klass->Fields->GetIfExists(hash, &value)) {
+        if (checkFields && (slot = klass->Fields->GetSlot(hash)) >= 0) {
             // Fields have priority over methods
+            if (cacheEntry) {
+                cacheEntry->Table = klass->Fields;
+                cacheEntry->Slot = slot;
+                cacheEntry->IsField = true;
+            }
             Pop();
-            Push(ScriptManager::DelinkValue(value));
+            Push(ScriptManager::DelinkValue(klass->Fields->Data[slot].Data));
             ScriptManager::Unlock();
             return true;
         }
-        else if (klass->Methods->GetIfExists(hash, &value)) {
+        else if ((slot = klass->Methods->GetSlot(hash)) >= 0) {
+            if (cacheEntry) {
+                cacheEntry->Table = klass->Methods;
+                cacheEntry->Slot = slot;
+                cacheEntry->IsField = false;
+            }
             Pop();
-            Push(value);
+            Push(klass->Methods->Data[slot].Data);
             ScriptManager::Unlock();
             return true;
         }
 
+        // Getters only claim properties by name, so one that passes
+        // on this hash now won't hide a cached parent value later.
         if (getter && getter(object, hash, &value, this->ID)) {
             Pop();
             Push(value);
@@ -1887,7 +2084,7 @@ PRIVATE bool   VMThread::GetProperty(Obj* object, ObjClass* klass, Uint32 hash,
         ObjClass* parentClass = ScriptManager::GetClassParent(klass);
         if (parentClass) {
             ScriptManager::Unlock();
-            return GetProperty((Obj*)parentClass, parentClass, hash, checkFields);
+            return GetProperty((Obj*)parentClass, parentClass, hash, true, parentClass->PropertyGet, cacheEntry);
         }
         else {
             ThrowRuntimeError(false, "Undefined property %s.", GetVariableOrMethodName(hash));
@@ -1898,6 +2095,9 @@ PRIVATE bool   VMThread::GetProperty(Obj* object, ObjClass* klass, Uint32 hash,
     ScriptManager::Unlock();
     return false;
 }
+PRIVATE bool   VMThread::GetProperty(Obj* object, ObjClass* klass, Uint32 hash, bool checkFields, ValueGetFn getter) {
+    return GetProperty(object, klass, hash, checkFields, getter, nullptr);
+}
 PRIVATE bool   VMThread::GetProperty(Obj* object, ObjClass* klass, Uint32 hash, bool checkFields) {
     return GetProperty(object, klass, hash, true, klass->PropertyGet);
 }
@@ -1924,7 +2124,7 @@ PRIVATE bool   VMThread::HasProperty(Obj* object, ObjClass* klass, Uint32 hash,
         ObjClass* parentClass = ScriptManager::GetClassParent(klass);
         if (parentClass) {
             ScriptManager::Unlock();
-            return HasProperty((Obj*)parentClass, parentClass, hash, checkFields, parentClass->PropertyGet);
+            return HasProperty((Obj*)parentClass, parentClass, hash, true, parentClass->PropertyGet);
         }
     }
     ScriptManager::Unlock();
@@ -1936,23 +2136,127 @@ PRIVATE bool   VMThread::HasProperty(Obj* object, ObjClass* klass, Uint32 hash,
 PRIVATE bool   VMThread::HasProperty(Obj* object, ObjClass* klass, Uint32 hash) {
     return HasProperty(object, klass, true);
 }
-PRIVATE bool   VMThread::SetProperty(Table* fields, Uint32 hash, VMValue field, VMValue value) {
-    switch (field.Type) {
-        case VAL_LINKED_INTEGER:
-            if (!ScriptManager::DoIntegerConversion(value, this->ID))
-                return false;
-            AS_LINKED_INTEGER(field) = AS_INTEGER(value);
-            break;
-        case VAL_LINKED_DECIMAL:
-            if (!ScriptManager::DoDecimalConversion(value, this->ID))
-                return false;
-            AS_LINKED_DECIMAL(field) = AS_DECIMAL(value);
-            break;
-        default:
-            fields->Put(hash, value);
+PRIVATE Uint32 VMThread::GetMapKeyHash(ObjMap* map, ObjString* key) {
+    // Interned strings already hold the hash a map computes for them
+    if (key->IsInterned)
+        return key->Hash;
+    return map->Values->HashFunction(key->Chars, strlen(key->Chars));
+}
+PRIVATE bool   VMThread::SetProperty(Table* fields, int slot, VMValue value) {
+    VMValue field = fields->Data[slot].Data;
+    if (IS_LINKED_INTEGER(field) || IS_LINKED_DECIMAL(field))
+        return SetLinkedValue(field, value);
+
+    fields->Data[slot].Data = value;
+    return true;
+}
+PRIVATE bool   VMThread::SetLinkedValue(VMValue field, VMValue value) {
+    if (IS_LINKED_INTEGER(field)) {
+        if (!ScriptManager::DoIntegerConversion(value, this->ID))
+            return false;
+        AS_LINKED_INTEGER(field) = AS_INTEGER(value);
+    }
+    else {
+        if (!ScriptManager::DoDecimalConversion(value, this->ID))
+            return false;
+        AS_LINKED_DECIMAL(field) = AS_DECIMAL(value);
     }
     return true;
 }
+
+// #region Inline Caches
+PRIVATE InlineCache*      VMThread::GetInlineCache(CallFrame* frame) {
+    return frame->Function->Chunk.GetInlineCache((int)(frame->IPLast - frame->IPStart));
+}
+PRIVATE InlineCacheEntry* VMThread::FindInlineCacheEntry(InlineCache* cache, ObjClass* klass, bool onInstance) {
+    if (!cache)
+        return nullptr;
+
+    for (int i = 0; i < cache->Count; i++) {
+        InlineCacheEntry* entry = &cache->Entries[i];
+        if (entry->Class == klass
+            && entry->OnInstance == onInstance
+            && entry->Epoch == ScriptManager::InlineCacheEpoch)
+            return entry;
+    }
+    return nullptr;
+}
+PRIVATE void              VMThread::AddInlineCacheEntry(InlineCache* cache, ObjClass* klass, bool onInstance, InlineCacheEntry* found) {
+    if (!cache || found->Slot < 0)
+        return;
+
+    // Everything in the cache goes stale at once when the epoch moves
+    if (cache->Count && cache->Entries[0].Epoch != ScriptManager::InlineCacheEpoch) {
+        cache->Count = 0;
+        cache->Next = 0;
+    }
+
+    InlineCacheEntry* entry = FindInlineCacheEntry(cache, klass, onInstance);
+    if (!entry) {
+        if (cache->Count < INLINE_CACHE_WAYS)
+            entry = &cache->Entries[cache->Count++];
+        else {
+            entry = &cache->Entries[cache->Next];
+            cache->Next = (cache->Next + 1) % INLINE_CACHE_WAYS;
+        }
+    }
+
+    *entry = *found;
+    entry->Class = klass;
+    entry->OnInstance = onInstance;
+    entry->Epoch = ScriptManager::InlineCacheEpoch;
+}
+PRIVATE bool              VMThread::GetCachedProperty(InlineCache* cache, ObjInstance* instance, ObjClass* klass, Uint32 hash, VMValue* result) {
+    InlineCacheEntry* entry = FindInlineCacheEntry(cache, klass, instance != nullptr);
+    if (!entry)
+        return false;
+
+    // Native fields can't be shadowed, since setting one never
+    // adds it to the instance's own fields.
+    if (entry->IsNative) {
+        HashMap<NativeField>* natives = instance->NativeFields;
+        if (!natives || !natives->SlotHasKey(entry->Slot, hash))
+            return false;
+
+        *result = ScriptManager::DelinkValue(NATIVE_FIELD_VAL(instance->EntityPtr, natives->Data[entry->Slot].Data));
+        return true;
+    }
+
+    Table* fields = instance ? instance->Fields : nullptr;
+    Table* table = entry->Table;
+    if (!table) {
+        if (!fields)
+            return false;
+        table = fields;
+    }
+    // A field added to the instance afterwards shadows the cached value
+    else if (fields && fields->Exists(hash))
+        return false;
+
+    if (!table->SlotHasKey(entry->Slot, hash))
+        return false;
+
+    VMValue value = table->Data[entry->Slot].Data;
+    if (entry->IsField)
+        value = ScriptManager::DelinkValue(value);
+
+    *result = value;
+    return true;
+}
+PRIVATE bool              VMThread::FindMethodSlot(ObjClass* klass, Uint32 hash, InlineCacheEntry* found) {
+    while (klass) {
+        int slot = klass->Methods->GetSlot(hash);
+        if (slot >= 0) {
+            found->Table = klass->Methods;
+            found->Slot = slot;
+            found->IsField = false;
+            return true;
+        }
+        klass = ScriptManager::GetClassParent(klass);
+    }
+    return false;
+}
+// #endregion
 PRIVATE bool   VMThread::BindMethod(VMValue receiver, VMValue method) {
     ObjBoundMethod* bound = NewBoundMethod(receiver, AS_FUNCTION(method));
     Push(OBJECT_VAL(bound));
@@ -1985,6 +2289,9 @@ PRIVATE bool   VMThread::CallValue(VMValue callee, int argCount) {
                     (void)err;
                 }
 
+                // Natives store into their arguments without a barrier
+                GarbageCollector::WriteBarrierValues(StackTop - argCount - 1, argCount + 1);
+
                 StackTop -= argCount; // Pop arguments
                 StackTop -= 1; // Pop receiver / class
                 Push(returnValue); // Push result
@@ -2016,6 +2323,9 @@ PRIVATE bool   VMThread::CallForObject(VMValue callee, int argCount) {
                 (void)err;
             }
 
+            // Natives store into their arguments without a barrier
+            GarbageCollector::WriteBarrierValues(StackTop - argCount - 1, argCount + 1);
+
             StackTop -= argCount; // Pop arguments
             StackTop -= 1; // Pop receiver / class
             Push(returnValue); // Push returned value
@@ -2084,6 +2394,17 @@ PUBLIC bool    VMThread::Call(ObjFunction* function, int argCount) {
         return false;
     }
 
+    if (function->EncodedChunk) {
+        if (!BytecodeBundle::DecodeFunction(function)) {
+            ThrowRuntimeError(false, "Could not load function from the bytecode bundle.");
+            return false;
+        }
+    }
+#ifdef USING_VM_JIT
+    else if (++function->HotCount == JIT::HOT_THRESHOLD)
+        JIT::Compile(function);
+#endif
+
     CallFrame* frame = &Frames[FrameCount++];
     frame->IP = function->Chunk.Code;
     frame->IPStart = frame->IP;
@@ -2100,6 +2421,7 @@ PUBLIC bool    VMThread::InvokeFromClass(ObjClass* klass, Uint32 hash, int argCo
         VMValue method;
         if (klass->Methods->GetIfExists(hash, &method)) {
             // Found the method, so just call it
+            ScriptManager::Unlock();
             return CallForObject(method, argCount);
         }
         else {
@@ -2124,6 +2446,11 @@ PUBLIC bool    VMThread::InvokeForInstance(Uint32 hash, int argCount, bool isSup
         bool exists = false;
         if (ScriptManager::Lock()) {
             exists = instance->Fields->GetIfExists(hash, &value);
+            NativeField native;
+            if (!exists && instance->NativeFields && instance->NativeFields->GetIfExists(hash, &native)) {
+                value = ScriptManager::DelinkValue(NATIVE_FIELD_VAL(instance->EntityPtr, native));
+                exists = true;
+            }
             ScriptManager::Unlock();
         }
         if (exists) {
@@ -2131,14 +2458,38 @@ PUBLIC bool    VMThread::InvokeForInstance(Uint32 hash, int argCount, bool isSup
         }
     }
     else {
-        ObjClass* parentClass = ScriptManager::GetClassParent(klass);
-        if (parentClass)
-            return InvokeFromClass(parentClass, hash, argCount);
-        else
+        klass = ScriptManager::GetClassParent(klass);
+        if (!klass) {
             ThrowRuntimeError(false, "Instance's class does not have a parent to call method from.");
-        return false;
+            return false;
+        }
+    }
+
+    VMValue method;
+    bool found = false;
+    if (ScriptManager::Lock()) {
+        // The method is looked up before calling it, since a native
+        // can run more script code that grows this chunk's caches.
+        InlineCache* cache = GetInlineCache(&Frames[FrameCount - 1]);
+        InlineCacheEntry* entry = FindInlineCacheEntry(cache, klass, true);
+        if (entry && entry->Table->SlotHasKey(entry->Slot, hash)) {
+            method = entry->Table->Data[entry->Slot].Data;
+            found = true;
+        }
+        else {
+            InlineCacheEntry resolved = { };
+            if (FindMethodSlot(klass, hash, &resolved)) {
+                AddInlineCacheEntry(cache, klass, true, &resolved);
+                method = resolved.Table->Data[resolved.Slot].Data;
+                found = true;
+            }
+        }
+        ScriptManager::Unlock();
     }
-    return InvokeFromClass(klass, hash, argCount);
+
+    if (found)
+        return CallForObject(method, argCount);
+    return false;
 }
 PRIVATE bool   VMThread::DoClassExtension(VMValue value, VMValue originalValue, bool clearSrc) {
     ObjClass* src = AS_CLASS(value);
@@ -2156,6 +2507,10 @@ PRIVATE bool   VMThread::DoClassExtension(VMValue value, VMValue originalValue,
     if (clearSrc)
         src->Fields->Clear();
 
+    GC_WRITE_BARRIER(dst);
+
+    ScriptManager::InvalidateInlineCaches();
+
     return true;
 }
 PUBLIC bool    VMThread::Import(VMValue value) {
@@ -2200,6 +2555,24 @@ PUBLIC bool    VMThread::ImportModule(VMValue value) {
     return result;
 }
 
+// #region Quickening
+// Rewrites the generic opcode that is running to a version specialized for
+// the operand types on the stack. Linked values and mixed types are left to
+// the generic path. Every thread sees the same code, but a stale guess just
+// falls back, so the byte store doesn't need synchronizing.
+PRIVATE void   VMThread::Quicken(CallFrame* frame, Uint8 integerOp, Uint8 decimalOp) {
+    VMValue b = Peek(0);
+    VMValue a = Peek(1);
+    if (VALUE_TYPE(a) != VALUE_TYPE(b))
+        return;
+
+    if (VALUE_TYPE(a) == VAL_INTEGER)
+        *frame->IPLast = integerOp;
+    else if (VALUE_TYPE(a) == VAL_DECIMAL)
+        *frame->IPLast = decimalOp;
+}
+// #endregion
+
 // #region Value Operations
 #define CHECK_IS_NUM(a, b, def) \
     if (IS_NOT_NUMBER(a)) { \
@@ -2219,7 +2592,7 @@ PUBLIC VMValue VMThread::Values_Multiply() {
     Pop();
     Pop();
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return DECIMAL_VAL(a_d * b_d);
@@ -2235,7 +2608,7 @@ PUBLIC VMValue VMThread::Values_Division() {
     CHECK_IS_NUM(a, "division", DECIMAL_VAL(1.0f));
     CHECK_IS_NUM(b, "division", DECIMAL_VAL(1.0f));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         if (b_d == 0.0) {
@@ -2259,7 +2632,7 @@ PUBLIC VMValue VMThread::Values_Modulo() {
     CHECK_IS_NUM(a, "modulo", DECIMAL_VAL(1.0f));
     CHECK_IS_NUM(b, "modulo", DECIMAL_VAL(1.0f));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return DECIMAL_VAL(fmod(a_d, b_d));
@@ -2286,7 +2659,7 @@ PUBLIC VMValue VMThread::Values_Plus() {
     CHECK_IS_NUM(a, "plus", DECIMAL_VAL(0.0f));
     CHECK_IS_NUM(b, "plus", DECIMAL_VAL(0.0f));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         Pop();
@@ -2309,7 +2682,7 @@ PUBLIC VMValue VMThread::Values_Minus() {
     Pop();
     Pop();
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return DECIMAL_VAL(a_d - b_d);
@@ -2325,7 +2698,7 @@ PUBLIC VMValue VMThread::Values_BitwiseLeft() {
     CHECK_IS_NUM(a, "bitwise left", INTEGER_VAL(0));
     CHECK_IS_NUM(b, "bitwise left", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return DECIMAL_VAL((float)((int)a_d << (int)b_d));
@@ -2341,7 +2714,7 @@ PUBLIC VMValue VMThread::Values_BitwiseRight() {
     CHECK_IS_NUM(a, "bitwise right", INTEGER_VAL(0));
     CHECK_IS_NUM(b, "bitwise right", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return DECIMAL_VAL((float)((int)a_d >> (int)b_d));
@@ -2357,7 +2730,7 @@ PUBLIC VMValue VMThread::Values_BitwiseAnd() {
     CHECK_IS_NUM(a, "bitwise and", INTEGER_VAL(0));
     CHECK_IS_NUM(b, "bitwise and", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return DECIMAL_VAL((float)((int)a_d & (int)b_d));
@@ -2373,7 +2746,7 @@ PUBLIC VMValue VMThread::Values_BitwiseXor() {
     CHECK_IS_NUM(a, "xor", INTEGER_VAL(0));
     CHECK_IS_NUM(b, "xor", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return DECIMAL_VAL((float)((int)a_d ^ (int)b_d));
@@ -2389,7 +2762,7 @@ PUBLIC VMValue VMThread::Values_BitwiseOr() {
     CHECK_IS_NUM(a, "bitwise or", INTEGER_VAL(0));
     CHECK_IS_NUM(b, "bitwise or", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return DECIMAL_VAL((float)((int)a_d | (int)b_d));
@@ -2405,7 +2778,7 @@ PUBLIC VMValue VMThread::Values_LogicalAND() {
     CHECK_IS_NUM(a, "logical and", INTEGER_VAL(0));
     CHECK_IS_NUM(b, "logical and", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         // float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         // float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         // return DECIMAL_VAL((float)((int)a_d & (int)b_d));
@@ -2422,7 +2795,7 @@ PUBLIC VMValue VMThread::Values_LogicalOR() {
     CHECK_IS_NUM(a, "logical or", INTEGER_VAL(0));
     CHECK_IS_NUM(b, "logical or", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         // float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         // float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         // return DECIMAL_VAL((float)((int)a_d & (int)b_d));
@@ -2439,7 +2812,7 @@ PUBLIC VMValue VMThread::Values_LessThan() {
     CHECK_IS_NUM(a, "less than", INTEGER_VAL(0));
     CHECK_IS_NUM(b, "less than", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return INTEGER_VAL(a_d < b_d);
@@ -2455,7 +2828,7 @@ PUBLIC VMValue VMThread::Values_GreaterThan() {
     CHECK_IS_NUM(a, "greater than", INTEGER_VAL(0));
     CHECK_IS_NUM(b, "greater than", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return INTEGER_VAL(a_d > b_d);
@@ -2471,7 +2844,7 @@ PUBLIC VMValue VMThread::Values_LessThanOrEqual() {
     CHECK_IS_NUM(a, "less than or equal", INTEGER_VAL(0));
     CHECK_IS_NUM(b, "less than or equal", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return INTEGER_VAL(a_d <= b_d);
@@ -2487,7 +2860,7 @@ PUBLIC VMValue VMThread::Values_GreaterThanOrEqual() {
     CHECK_IS_NUM(a, "greater than or equal", INTEGER_VAL(0));
     CHECK_IS_NUM(b, "greater than or equal", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL || b.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL || VALUE_TYPE(b) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(a));
         float b_d = AS_DECIMAL(ScriptManager::CastValueAsDecimal(b));
         return INTEGER_VAL(a_d >= b_d);
@@ -2501,7 +2874,7 @@ PUBLIC VMValue VMThread::Values_Increment() {
 
     CHECK_IS_NUM(a, "increment", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(a);
         return DECIMAL_VAL(++a_d);
     }
@@ -2513,7 +2886,7 @@ PUBLIC VMValue VMThread::Values_Decrement() {
 
     CHECK_IS_NUM(a, "decrement", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL) {
         float a_d = AS_DECIMAL(a);
         return DECIMAL_VAL(--a_d);
     }
@@ -2525,7 +2898,7 @@ PUBLIC VMValue VMThread::Values_Negate() {
 
     CHECK_IS_NUM(a, "negate", INTEGER_VAL(0));
 
-    if (a.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL) {
         return DECIMAL_VAL(-AS_DECIMAL(a));
     }
     return INTEGER_VAL(-AS_INTEGER(a));
@@ -2534,7 +2907,7 @@ PUBLIC VMValue VMThread::Values_LogicalNOT() {
     VMValue a = Pop();
 
     // HACK: Yikes.
-    switch (a.Type) {
+    switch (VALUE_TYPE(a)) {
         case VAL_NULL:
             return INTEGER_VAL(true);
         case VAL_OBJECT:
@@ -2551,7 +2924,7 @@ PUBLIC VMValue VMThread::Values_LogicalNOT() {
 }
 PUBLIC VMValue VMThread::Values_BitwiseNOT() {
     VMValue a = Pop();
-    if (a.Type == VAL_DECIMAL) {
+    if (VALUE_TYPE(a) == VAL_DECIMAL) {
         return DECIMAL_VAL((float)(~(int)AS_DECIMAL(a)));
     }
     return INTEGER_VAL(~AS_INTEGER(a));
@@ -2561,7 +2934,7 @@ PUBLIC VMValue VMThread::Value_TypeOf() {
 
     VMValue value = Pop();
 
-    switch (value.Type) {
+    switch (VALUE_TYPE(value)) {
         case VAL_NULL:
             valueType = "null";
             break;
@@ -2615,10 +2988,16 @@ PUBLIC VMValue VMThread::Value_TypeOf() {
                 case OBJ_MODULE:
                     valueType = "module";
                     break;
+                case OBJ_TYPED_ARRAY:
+                    valueType = "typedarray";
+                    break;
+                case OBJ_STRING_BUILDER:
+                    valueType = "stringbuilder";
+                    break;
             }
         }
     }
 
-    return OBJECT_VAL(CopyString(valueType));
+    return OBJECT_VAL(ScriptManager::InternString(valueType));
 }
 // #endregion
@@ -25,7 +25,7 @@ PUBLIC STATIC void Values::PrintValue(PrintBuffer* buffer, VMValue value, bool p
     Values::PrintValue(buffer, value, 0, prettyPrint);
 }
 PUBLIC STATIC void Values::PrintValue(PrintBuffer* buffer, VMValue value, int indent, bool prettyPrint) {
-    switch (value.Type) {
+    switch (VALUE_TYPE(value)) {
         case VAL_NULL:
             buffer_printf(buffer, "null");
             break;
@@ -41,7 +41,7 @@ PUBLIC STATIC void Values::PrintValue(PrintBuffer* buffer, VMValue value, int in
             PrintObject(buffer, value, indent, prettyPrint);
             break;
         default:
-            buffer_printf(buffer, "<unknown value type 0x%02X>", value.Type);
+            buffer_printf(buffer, "<unknown value type 0x%02X>", VALUE_TYPE(value));
     }
 }
 PUBLIC STATIC void Values::PrintObject(PrintBuffer* buffer, VMValue value, int indent, bool prettyPrint) {
@@ -70,12 +70,21 @@ PUBLIC STATIC void Values::PrintObject(PrintBuffer* buffer, VMValue value, int i
         case OBJ_STREAM:
             buffer_printf(buffer, "<stream>");
             break;
+        case OBJ_TYPED_ARRAY: {
+            static const char* typeNames[] = { "Int32", "Float32", "Uint8" };
+            ObjTypedArray* array = AS_TYPED_ARRAY(value);
+            buffer_printf(buffer, "<typed array %s[%u]>", typeNames[array->ElementType], array->Length);
+            break;
+        }
         case OBJ_NAMESPACE:
             buffer_printf(buffer, "<namespace %s>", AS_NAMESPACE(value)->Name ? AS_NAMESPACE(value)->Name->Chars : "(null)");
             break;
         case OBJ_STRING:
             buffer_printf(buffer, "\"%s\"", AS_CSTRING(value));
             break;
+        case OBJ_STRING_BUILDER:
+            buffer_printf(buffer, "\"%s\"", AS_STRING_BUILDER(value)->Chars);
+            break;
         case OBJ_UPVALUE:
             buffer_printf(buffer, "<upvalue>");
             break;
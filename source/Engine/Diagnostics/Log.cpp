@@ -96,8 +96,8 @@ PUBLIC STATIC void Log::Print(int sev, const char* format, ...) {
     if (sev < Log::LogLevel)
         return;
 
-    static char* stringBuffer = NULL;
-    static size_t stringBufferSize = 0;
+    static thread_local char* stringBuffer = NULL;
+    static thread_local size_t stringBufferSize = 0;
     const char* severityText = NULL;
 
     va_list args;
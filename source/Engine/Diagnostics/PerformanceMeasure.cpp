@@ -6,14 +6,28 @@ class PerformanceMeasure {
 public:
     static bool            Initialized;
     static Perf_ViewRender PERF_ViewRender[MAX_SCENE_VIEWS];
+
+    static bool            ObjectTiming;
+    static int             ObjectTimingInterval;
+    static int             ObjectTimingCountdown;
+    static double          MillisecondsPerCycle;
 };
 #endif
 
 #include <Engine/Diagnostics/PerformanceMeasure.h>
+#include <Engine/Diagnostics/Clock.h>
+#include <Engine/Diagnostics/Log.h>
 
 bool            PerformanceMeasure::Initialized = false;
 Perf_ViewRender PerformanceMeasure::PERF_ViewRender[MAX_SCENE_VIEWS];
 
+bool            PerformanceMeasure::ObjectTiming = false;
+int             PerformanceMeasure::ObjectTimingInterval = 8;
+int             PerformanceMeasure::ObjectTimingCountdown = 1;
+double          PerformanceMeasure::MillisecondsPerCycle = 0.0;
+
+static Uint32   ObjectTimingSeed = 0x9E3779B9;
+
 PUBLIC STATIC void PerformanceMeasure::Init() {
     if (PerformanceMeasure::Initialized)
         return;
@@ -21,3 +35,46 @@ PUBLIC STATIC void PerformanceMeasure::Init() {
     PerformanceMeasure::Initialized = true;
     memset(PerformanceMeasure::PERF_ViewRender, 0, sizeof(PerformanceMeasure::PERF_ViewRender));
 }
+
+// Turns the per-object-class timing in ObjectList::Performance on or off.
+// Only one in about every interval calls is timed.
+PUBLIC STATIC void PerformanceMeasure::SetObjectTiming(bool enabled, int interval) {
+#ifdef NO_OBJECT_TIMING
+    if (enabled)
+        Log::Print(Log::LOG_WARN, "Object timing was left out of this build.");
+    return;
+#endif
+
+    ObjectTimingInterval = interval > 0 ? interval : 1;
+    ObjectTimingCountdown = 1;
+
+    if (enabled && !ObjectTiming && MillisecondsPerCycle == 0.0) {
+        // Find out how fast the cycle counter runs against the clock
+        double startTicks = Clock::GetTicks();
+        Uint64 startCycles = Perf_ReadCycles();
+        double ticks;
+        do {
+            ticks = Clock::GetTicks();
+        } while (ticks - startTicks < 2.0);
+        Uint64 cycles = Perf_ReadCycles() - startCycles;
+
+        if (cycles)
+            MillisecondsPerCycle = (ticks - startTicks) / (double)cycles;
+        else
+            enabled = false;
+    }
+
+    ObjectTiming = enabled;
+}
+// Returns how many calls to skip before the next timed one. It varies
+// around the interval, so that a frame's worth of entities lining up with
+// the interval doesn't keep timing the same ones.
+PUBLIC STATIC int  PerformanceMeasure::NextObjectTimingCountdown() {
+    ObjectTimingSeed ^= ObjectTimingSeed << 13;
+    ObjectTimingSeed ^= ObjectTimingSeed >> 17;
+    ObjectTimingSeed ^= ObjectTimingSeed << 5;
+    return 1 + (int)(ObjectTimingSeed % (Uint32)(ObjectTimingInterval * 2 - 1));
+}
+PUBLIC STATIC double PerformanceMeasure::CyclesToMilliseconds(Uint64 cycles) {
+    return (double)cycles * MillisecondsPerCycle;
+}
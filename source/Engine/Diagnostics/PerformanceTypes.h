@@ -1,6 +1,16 @@
 #ifndef ENGINE_DIAGNOSTICS_PERFORMANCETYPES
 #define ENGINE_DIAGNOSTICS_PERFORMANCETYPES
 
+#include <Engine/Includes/Standard.h>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
 struct Perf_Application {
     double EventTime;
     double AfterSceneTime;
@@ -24,5 +34,20 @@ struct Perf_ViewRender {
     double RenderTime;
 };
 
+// Reads the CPU's cycle counter, or the closest cheap equivalent. The
+// units differ per machine; PerformanceMeasure converts them.
+static inline Uint64 Perf_ReadCycles() {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    return __rdtsc();
+#elif defined(__i386__) || defined(__x86_64__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    Uint64 value;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    return (Uint64)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
 
 #endif /* ENGINE_DIAGNOSTICS_PERFORMANCETYPES */
@@ -44,7 +44,8 @@ public:
         OBJ_TYPE_UNIMPLEMENTED,
         OBJ_TYPE_STRING,
         OBJ_TYPE_ARRAY,
-        OBJ_TYPE_MAP
+        OBJ_TYPE_MAP,
+        OBJ_TYPE_TYPED_ARRAY
     };
 
     static Uint32 Magic;
@@ -68,7 +69,7 @@ PUBLIC Serializer::Serializer(Stream* stream) {
 }
 
 PRIVATE void Serializer::WriteValue(VMValue val) {
-    switch (val.Type) {
+    switch (VALUE_TYPE(val)) {
         case VAL_DECIMAL:
         case VAL_LINKED_DECIMAL: {
             float d = AS_DECIMAL(val);
@@ -91,6 +92,7 @@ PRIVATE void Serializer::WriteValue(VMValue val) {
                     case OBJ_STRING:
                     case OBJ_ARRAY:
                     case OBJ_MAP:
+                    case OBJ_TYPED_ARRAY:
                         StreamPtr->WriteByte(Serializer::VAL_TYPE_OBJECT);
                         StreamPtr->WriteUInt32(objectID);
                         return;
@@ -153,6 +155,15 @@ PRIVATE void Serializer::WriteObject(Obj* obj) {
             });
             break;
         }
+        case OBJ_TYPED_ARRAY: {
+            WriteObjectPreamble(Serializer::OBJ_TYPE_TYPED_ARRAY);
+
+            ObjTypedArray* array = (ObjTypedArray*)obj;
+            StreamPtr->WriteByte(array->ElementType);
+            StreamPtr->WriteUInt32(array->Length);
+            StreamPtr->WriteBytes(array->Data, array->Length * GetTypedArrayElementSize(array->ElementType));
+            break;
+        }
         default:
             Log::Print(Log::LOG_WARN, "Cannot serialize an object of type %s; ignoring", GetObjectTypeString(obj->Type));
             WriteObjectPreamble(Serializer::OBJ_TYPE_UNIMPLEMENTED);
@@ -377,6 +388,21 @@ PRIVATE void Serializer::GetObject() {
         StreamPtr->Skip(size);
         return;
     }
+    case Serializer::OBJ_TYPE_TYPED_ARRAY: {
+        Uint8 elementType = StreamPtr->ReadByte();
+        Uint32 length = StreamPtr->ReadUInt32();
+        ObjTypedArray* array = NULL;
+        if (elementType >= MAX_TYPEDARRAY_TYPE)
+            Log::Print(Log::LOG_ERROR, "Attempted to deserialize an invalid typed array type!");
+        else if (size < 5 || (Uint64)length * GetTypedArrayElementSize(elementType) != size - 5)
+            Log::Print(Log::LOG_ERROR, "Attempted to deserialize a typed array whose length does not match its data!");
+        else
+            array = NewTypedArray(elementType, length);
+        ObjList.push_back((Obj*)array);
+        if (size > 5)
+            StreamPtr->Skip(size - 5);
+        return;
+    }
     default:
         if (type == OBJ_TYPE_UNIMPLEMENTED)
             Log::Print(Log::LOG_WARN, "Ignoring unimplemented object type");
@@ -422,6 +448,17 @@ PRIVATE void Serializer::ReadObject(Obj* obj) {
         }
         return;
     }
+    case Serializer::OBJ_TYPE_TYPED_ARRAY: {
+        StreamPtr->Skip(5);
+        // Only created if its length matched the chunk size
+        if (obj) {
+            ObjTypedArray* array = (ObjTypedArray*)obj;
+            StreamPtr->ReadBytes(array->Data, array->Length * GetTypedArrayElementSize(array->ElementType));
+        }
+        else if (size > 5)
+            StreamPtr->Skip(size - 5);
+        return;
+    }
     default:
         StreamPtr->Skip(size);
         return;
@@ -92,7 +92,9 @@ public:
         Uint32 index = TranslateIndex(hash);
 
         for (int i = 0; i < ChainLength; i++) {
-            if (Data[index].Used && Data[index].Key == hash) {
+            if (!Data[index].Used)
+                break;
+            if (Data[index].Key == hash) {
                 return Data[index].Data;
             }
 
@@ -102,7 +104,7 @@ public:
 #ifdef IOS
         return T();
 #else
-        return T { 0 };
+        return T {};
 #endif
     }
     T      Get(const char* key) {
@@ -113,7 +115,9 @@ public:
         Uint32 index = TranslateIndex(hash);
 
         for (int i = 0; i < ChainLength; i++) {
-            if (Data[index].Used && Data[index].Key == hash) {
+            if (!Data[index].Used)
+                break;
+            if (Data[index].Key == hash) {
                 return true;
             }
 
@@ -131,7 +135,9 @@ public:
         Uint32 index = TranslateIndex(hash);
 
         for (int i = 0; i < ChainLength; i++) {
-            if (Data[index].Used && Data[index].Key == hash) {
+            if (!Data[index].Used)
+                break;
+            if (Data[index].Key == hash) {
                 *result = Data[index].Data;
                 return true;
             }
@@ -146,14 +152,29 @@ public:
         return GetIfExists(hash, result);
     }
 
+    // Slots stay valid until the map is resized or the key is removed,
+    // so callers can remember one and check it with SlotHasKey later.
+    int    GetSlot(Uint32 hash) {
+        Uint32 index = FindKey(hash);
+        if (index == 0xFFFFFFFFU)
+            return -1;
+        return (int)index;
+    }
+    bool   SlotHasKey(int slot, Uint32 hash) {
+        return (unsigned)slot < (unsigned)Capacity && Data[slot].Used && Data[slot].Key == hash;
+    }
+
     bool   Remove(Uint32 hash) {
         Uint32 index = TranslateIndex(hash);
 
         for (int i = 0; i < ChainLength; i++) {
-            if (Data[index].Used && Data[index].Key == hash) {
+            if (!Data[index].Used)
+                break;
+            if (Data[index].Key == hash) {
                 Count--;
                 RemoveKey(&Data[index]);
                 Data[index].Used = false;
+                CloseGap(index);
                 return true;
             }
 
@@ -275,7 +296,9 @@ private:
     Uint32 FindKey(Uint32 key) {
         Uint32 index = TranslateIndex(key);
         for (int i = 0; i < ChainLength; i++) {
-            if (Data[index].Used && Data[index].Key == key)
+            if (!Data[index].Used)
+                break;
+            if (Data[index].Key == key)
                 return index;
 
             index = (index + 1) & CapacityMask;
@@ -306,6 +329,30 @@ private:
                 Data[index].PrevKey = data->PrevKey;
         }
     }
+    // Shifts entries back into a freed slot so that every key stays
+    // reachable from its home index without crossing an empty slot.
+    // This is what lets lookups stop at the first unused slot.
+    void   CloseGap(Uint32 hole) {
+        Uint32 index = hole;
+        for (int i = 0; i < Capacity; i++) {
+            index = (index + 1) & CapacityMask;
+            if (!Data[index].Used)
+                break;
+
+            Uint32 home = TranslateIndex(Data[index].Key);
+            bool movable;
+            if (hole <= index)
+                movable = home <= hole || home > index;
+            else
+                movable = home <= hole && home > index;
+
+            if (movable) {
+                Data[hole] = Data[index];
+                Data[index].Used = false;
+                hole = index;
+            }
+        }
+    }
     void   AppendKey(HashMapElement<T>* data) {
         data->PrevKey = LastKey;
         data->NextKey = 0;
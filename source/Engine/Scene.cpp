@@ -12,6 +12,7 @@
 #include <Engine/Types/ObjectList.h>
 #include <Engine/Types/ObjectRegistry.h>
 #include <Engine/Types/DrawGroupList.h>
+#include <Engine/Types/SpatialGrid.h>
 #include <Engine/Rendering/GameTexture.h>
 #include <Engine/Scene/SceneConfig.h>
 #include <Engine/Scene/SceneLayer.h>
@@ -22,6 +23,7 @@
 
 #include <Engine/Scene/View.h>
 #include <Engine/Diagnostics/PerformanceTypes.h>
+#include <Engine/Diagnostics/PerformanceMeasure.h>
 
 need_t Entity;
 
@@ -52,6 +54,8 @@ public:
     static int                       PriorityPerLayer;
     static DrawGroupList*            PriorityLists;
 
+    static SpatialGrid*              ObjectGrid;
+
     static vector<Tileset>           Tilesets;
     static vector<TileSpriteInfo>    TileSpriteInfos;
     static Uint16                    EmptyTile;
@@ -165,6 +169,8 @@ public:
 #include <Engine/Scene/SceneInfo.h>
 #include <Engine/TextFormats/XML/XMLParser.h>
 #include <Engine/TextFormats/XML/XMLNode.h>
+#include <Engine/Types/EntityComponents.h>
+#include <Engine/Types/EntityPool.h>
 #include <Engine/Types/EntityTypes.h>
 #include <Engine/Types/ObjectList.h>
 #include <Engine/Types/ObjectRegistry.h>
@@ -183,6 +189,8 @@ int                       Scene::BasePriorityPerLayer = 32;
 int                       Scene::PriorityPerLayer = 0;
 DrawGroupList*            Scene::PriorityLists = NULL;
 
+SpatialGrid*              Scene::ObjectGrid = NULL;
+
 // Rendering variables
 int                       Scene::ShowTileCollisionFlag = 0;
 int                       Scene::ShowObjectRegions = 0;
@@ -302,6 +310,25 @@ void ObjectList_CallGlobalUpdates(Uint32, ObjectList* list) {
     if (list->Activity == ACTIVE_ALWAYS || (list->Activity == ACTIVE_NORMAL && !Scene::Paused) || (list->Activity == ACTIVE_PAUSED && Scene::Paused))
         ScriptManager::CallFunction(list->GlobalUpdateFunctionName);
 }
+
+// Per-object-class timing. While it's on, a sampled fraction of the calls
+// are timed with the cycle counter; while it's off, all that's left is one
+// flag check per call.
+#ifndef NO_OBJECT_TIMING
+#define OBJECT_TIMING_START(n) \
+    Uint64 n = 0; \
+    if (PerformanceMeasure::ObjectTiming && --PerformanceMeasure::ObjectTimingCountdown <= 0) { \
+        PerformanceMeasure::ObjectTimingCountdown = PerformanceMeasure::NextObjectTimingCountdown(); \
+        n = Perf_ReadCycles(); \
+    }
+#define OBJECT_TIMING_END(n, stats) \
+    if (n && ent->List) \
+        ent->List->Performance.stats.DoAverage(PerformanceMeasure::CyclesToMilliseconds(Perf_ReadCycles() - n))
+#else
+#define OBJECT_TIMING_START(n)
+#define OBJECT_TIMING_END(n, stats)
+#endif
+
 void UpdateObjectEarly(Entity* ent) {
     if (Scene::Paused && ent->Pauseable && ent->Activity != ACTIVE_PAUSED && ent->Activity != ACTIVE_ALWAYS)
         return;
@@ -310,14 +337,11 @@ void UpdateObjectEarly(Entity* ent) {
     if (!ent->OnScreen)
         return;
 
-    double elapsed = Clock::GetTicks();
+    OBJECT_TIMING_START(timingStart);
 
     ent->UpdateEarly();
 
-    elapsed = Clock::GetTicks() - elapsed;
-
-    if (ent->List)
-        ent->List->Performance.EarlyUpdate.DoAverage(elapsed);
+    OBJECT_TIMING_END(timingStart, EarlyUpdate);
 }
 void UpdateObjectLate(Entity* ent) {
     if (Scene::Paused && ent->Pauseable && ent->Activity != ACTIVE_PAUSED && ent->Activity != ACTIVE_ALWAYS)
@@ -327,14 +351,11 @@ void UpdateObjectLate(Entity* ent) {
     if (!ent->OnScreen)
         return;
 
-    double elapsed = Clock::GetTicks();
+    OBJECT_TIMING_START(timingStart);
 
     ent->UpdateLate();
 
-    elapsed = Clock::GetTicks() - elapsed;
-
-    if (ent->List)
-        ent->List->Performance.LateUpdate.DoAverage(elapsed);
+    OBJECT_TIMING_END(timingStart, LateUpdate);
 }
 void UpdateObject(Entity* ent) {
     if (Scene::Paused && ent->Pauseable && ent->Activity != ACTIVE_PAUSED && ent->Activity != ACTIVE_ALWAYS)
@@ -447,16 +468,13 @@ void UpdateObject(Entity* ent) {
     }
 
     if (ent->InRange) {
-        double elapsed = Clock::GetTicks();
-
         ent->OnScreen = true;
 
-        ent->Update();
+        OBJECT_TIMING_START(timingStart);
 
-        elapsed = Clock::GetTicks() - elapsed;
+        ent->Update();
 
-        if (ent->List)
-            ent->List->Performance.Update.DoAverage(elapsed);
+        OBJECT_TIMING_END(timingStart, Update);
 
         ent->WasOffScreen = false;
     }
@@ -495,7 +513,7 @@ void UpdateObject(Entity* ent) {
 
     // Sort list if needed
     if (ent->Depth != ent->OldDepth) {
-        Scene::PriorityLists[ent->Priority].NeedsSorting = true;
+        Scene::PriorityLists[ent->Priority].DepthChanged(ent);
     }
 
     ent->PriorityOld = ent->Priority;
@@ -528,6 +546,7 @@ PUBLIC STATIC void Scene::Add(Entity** first, Entity** last, int* count, Entity*
     obj->List->Add(obj);
 
     Scene::AddToScene(obj);
+    obj->MarkBoundsChanged();
 }
 PUBLIC STATIC void Scene::Remove(Entity** first, Entity** last, int* count, Entity* obj) {
     if (obj == NULL) return;
@@ -587,6 +606,8 @@ PRIVATE STATIC void Scene::RemoveObject(Entity* obj) {
 
     // Remove it from the scene
     Scene::RemoveFromScene(obj);
+    if (Scene::ObjectGrid)
+        Scene::ObjectGrid->Remove(obj);
 
     // If this object is unreachable script-side, that means it can
     // be deleted during garbage collection.
@@ -612,7 +633,8 @@ PUBLIC STATIC void Scene::DeleteRemoved(Entity* obj) {
         return;
 
     obj->Dispose();
-    delete obj;
+    obj->~Entity();
+    EntityPool::Free(obj);
 }
 
 PUBLIC STATIC void Scene::OnEvent(Uint32 event) {
@@ -676,11 +698,13 @@ PUBLIC STATIC void Scene::Init() {
 
     Compiler::Init();
 
+    // Compiling on worker threads needs the script lock to exist already
+    ScriptManager::Init();
+
     SourceFileMap::CheckForUpdate();
 
     Application::GameStart = true;
 
-    ScriptManager::Init();
     ScriptManager::ResetStack();
     ScriptManager::LinkStandardLibrary();
     ScriptManager::LinkExtensions();
@@ -783,6 +807,9 @@ PUBLIC STATIC void Scene::Update() {
             Scene::Remove(&Scene::DynamicObjectFirst, &Scene::DynamicObjectLast, &Scene::DynamicObjectCount, ent);
     }
 
+    // Animate and move the entities that asked for it during late update
+    EntityComponents::RunPending();
+
     #ifdef USING_FFMPEG
         AudioManager::Lock();
         Uint8 audio_buffer[0x8000]; // <-- Should be larger than AudioManager::AudioQueueMaxSize
@@ -905,6 +932,31 @@ PUBLIC STATIC void Scene::SetView(int viewIndex) {
     Scene::ViewCurrent = viewIndex;
 }
 
+// Appends every active entity whose hitbox touches the given rectangle.
+PUBLIC STATIC void Scene::GetEntitiesInRegion(float left, float top, float right, float bottom, vector<Entity*>* list) {
+    // The grid only exists once something asks for it. Until then,
+    // nothing is marked, so every entity starts out queued.
+    if (!Scene::ObjectGrid) {
+        Scene::ObjectGrid = new SpatialGrid();
+        for (Entity* ent = Scene::ObjectFirst; ent; ent = ent->NextSceneEntity)
+            Scene::ObjectGrid->MarkDirty(ent);
+    }
+
+    // Only the entities whose bounds changed since the last query
+    Scene::ObjectGrid->Refresh();
+
+    size_t start = list->size();
+    Scene::ObjectGrid->Query(left, top, right, bottom, list);
+
+    // Keep only the candidates that really touch it
+    size_t count = start;
+    for (size_t i = start; i < list->size(); i++) {
+        Entity* ent = (*list)[i];
+        if (ent->Active && !ent->Removed && ent->CollideWithRegion(left, top, right, bottom))
+            (*list)[count++] = ent;
+    }
+    list->resize(count);
+}
 PUBLIC STATIC bool Scene::CheckPosOnScreen(float posX, float posY, float rangeX, float rangeY) {
     if (!posX || !posY || !rangeX || !rangeY)
         return false;
@@ -986,11 +1038,13 @@ PUBLIC STATIC void Scene::RenderView(int viewIndex, bool doPerf) {
         DrawGroupList* drawGroupList = &PriorityLists[l];
         if (drawGroupList->NeedsSorting)
             drawGroupList->Sort();
+        else if (drawGroupList->Holes)
+            drawGroupList->Compact();
 
         Scene::CurrentDrawGroup = l;
 
         for (Entity* ent : *drawGroupList->Entities) {
-            if (ent->Active)
+            if (ent && ent->Active)
                 ent->RenderEarly();
         }
     }
@@ -1009,7 +1063,6 @@ PUBLIC STATIC void Scene::RenderView(int viewIndex, bool doPerf) {
         if (DEV_NoObjectRender)
             goto DEV_NoTilesCheck;
 
-        double elapsed;
         double objectTime;
         float _ox;
         float _oy;
@@ -1021,7 +1074,7 @@ PUBLIC STATIC void Scene::RenderView(int viewIndex, bool doPerf) {
 
         drawGroupList = &PriorityLists[l];
         for (Entity* ent : *drawGroupList->Entities) {
-            if (ent->Active) {
+            if (ent && ent->Active) {
                 _ox = ent->X - _vx;
                 _oy = ent->Y - _vy;
 
@@ -1094,14 +1147,11 @@ DoCheckRender:
                 if ((ent->ViewOverrideFlag & viewRenderFlag) == 0 && (Scene::ObjectViewRenderFlag & viewRenderFlag) == 0)
                     continue;
 
-                elapsed = Clock::GetTicks();
+                OBJECT_TIMING_START(timingStart);
 
                 ent->Render(_vx, _vy);
 
-                elapsed = Clock::GetTicks() - elapsed;
-
-                if (ent->List)
-                    ent->List->Performance.Render.DoAverage(elapsed);
+                OBJECT_TIMING_END(timingStart, Render);
             }
         }
         objectTime = Clock::GetTicks() - objectTime;
@@ -1162,7 +1212,7 @@ DoCheckRender:
 
         DrawGroupList* drawGroupList = &PriorityLists[l];
         for (Entity* ent : *drawGroupList->Entities) {
-            if (ent->Active)
+            if (ent && ent->Active)
                 ent->RenderLate();
         }
     }
@@ -1278,6 +1328,7 @@ PUBLIC STATIC void Scene::Render() {
 }
 
 PUBLIC STATIC void Scene::AfterScene() {
+    ScriptManager::CheckLocking();
     ScriptManager::ResetStack();
     ScriptManager::RequestGarbageCollection();
 
@@ -1417,6 +1468,7 @@ PUBLIC STATIC void Scene::Restart() {
             ent->X = ent->InitialX;
             ent->Y = ent->InitialY;
             ent->Initialize();
+            ent->MarkBoundsChanged();
         }
     });
 
@@ -2570,6 +2622,12 @@ PUBLIC STATIC void Scene::Dispose() {
     Scene::ObjectFirst = NULL;
     Scene::ObjectLast = NULL;
 
+    // Every object has left the grid by now
+    if (Scene::ObjectGrid) {
+        delete Scene::ObjectGrid;
+        Scene::ObjectGrid = NULL;
+    }
+
     // Free Priority Lists
     Scene::FreePriorityLists();
 
@@ -2610,6 +2668,10 @@ PUBLIC STATIC void Scene::Dispose() {
     ScriptManager::Dispose();
     SourceFileMap::Dispose();
     Compiler::Dispose();
+
+    // Freeing the instances above deleted the last entities
+    EntityPool::Dispose();
+    EntityComponents::Dispose();
 }
 
 PUBLIC STATIC void Scene::UnloadTilesets() {
@@ -3238,6 +3300,9 @@ PUBLIC STATIC bool Scene::CheckObjectCollisionBox(Entity* thisEntity, CollisionB
                 }
                 break;
             }
+
+        if (side != C_NONE)
+            otherEntity->MarkBoundsChanged();
     }
 
     if (ShowHitboxes) {
@@ -3286,6 +3351,7 @@ PUBLIC STATIC bool Scene::CheckObjectCollisionPlatform(Entity* thisEntity, Colli
             && otherEntity->VelocityY <= 0.0) {
 
             otherEntity->Y = thisEntity->Y + thisHitbox->Bottom + otherHitbox->Bottom;
+            otherEntity->MarkBoundsChanged();
 
             if (setValues) {
                 otherEntity->VelocityY = 0.0;
@@ -3306,6 +3372,7 @@ PUBLIC STATIC bool Scene::CheckObjectCollisionPlatform(Entity* thisEntity, Colli
             && otherEntity->VelocityY >= 0.0) {
 
             otherEntity->Y = thisEntity->Y + (thisHitbox->Top - otherHitbox->Bottom);
+            otherEntity->MarkBoundsChanged();
 
             if (setValues) {
                 otherEntity->VelocityY = 0.0;
@@ -3419,8 +3486,10 @@ PUBLIC STATIC bool Scene::ObjectTileCollision(Entity* entity, int cLayers, int c
                 }
             }
 
-            if (setPos && collided)
+            if (setPos && collided) {
                 entity->Y = posY - yOffset;
+                entity->MarkBoundsChanged();
+            }
             return collided;
 
         case CMODE_LWALL:
@@ -3466,8 +3535,10 @@ PUBLIC STATIC bool Scene::ObjectTileCollision(Entity* entity, int cLayers, int c
                 }
             }
 
-            if (setPos && collided)
+            if (setPos && collided) {
                 entity->X = posX - xOffset;
+                entity->MarkBoundsChanged();
+            }
             return collided;
 
         case CMODE_ROOF:
@@ -3513,8 +3584,10 @@ PUBLIC STATIC bool Scene::ObjectTileCollision(Entity* entity, int cLayers, int c
                 }
             }
 
-            if (setPos && collided)
+            if (setPos && collided) {
                 entity->Y = posY - yOffset;
+                entity->MarkBoundsChanged();
+            }
             return collided;
 
         case CMODE_RWALL:
@@ -3560,8 +3633,10 @@ PUBLIC STATIC bool Scene::ObjectTileCollision(Entity* entity, int cLayers, int c
                 }
             }
 
-            if (setPos && collided)
+            if (setPos && collided) {
                 entity->X = posX - xOffset;
+                entity->MarkBoundsChanged();
+            }
             return collided;
     }
 }
@@ -3628,8 +3703,10 @@ PUBLIC STATIC bool Scene::ObjectTileGrip(Entity* entity, int cLayers, int cMode,
                 }
             }
 
-            if (collided)
+            if (collided) {
                 entity->Y = posY - yOffset;
+                entity->MarkBoundsChanged();
+            }
             return collided;
 
         case CMODE_LWALL:
@@ -3678,8 +3755,10 @@ PUBLIC STATIC bool Scene::ObjectTileGrip(Entity* entity, int cLayers, int cMode,
                 }
             }
 
-            if (collided)
+            if (collided) {
                 entity->X = posX - xOffset;
+                entity->MarkBoundsChanged();
+            }
             return collided;
 
         case CMODE_ROOF:
@@ -3728,8 +3807,10 @@ PUBLIC STATIC bool Scene::ObjectTileGrip(Entity* entity, int cLayers, int cMode,
                 }
             }
 
-            if (collided)
+            if (collided) {
                 entity->Y = posY - yOffset;
+                entity->MarkBoundsChanged();
+            }
             return collided;
 
         case CMODE_RWALL:
@@ -3778,8 +3859,10 @@ PUBLIC STATIC bool Scene::ObjectTileGrip(Entity* entity, int cLayers, int cMode,
                 }
             }
 
-            if (collided)
+            if (collided) {
                 entity->X = posX - xOffset;
+                entity->MarkBoundsChanged();
+            }
             return collided;
     }
 }
@@ -3838,6 +3921,8 @@ PUBLIC STATIC void Scene::ProcessObjectMovement(Entity* entity, CollisionBox* ou
             entity->X += entity->VelocityX;
             entity->Y += entity->VelocityY;
         }
+
+        entity->MarkBoundsChanged();
     }
 }
 
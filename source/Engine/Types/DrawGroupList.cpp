@@ -6,9 +6,14 @@
 
 class DrawGroupList {
 public:
-    vector<Entity*>* Entities = nullptr;
-    bool             EntityDepthSortingEnabled = false;
-    bool             NeedsSorting = false;
+    // Removed entities leave a NULL behind until the next Sort or Compact.
+    vector<Entity*>*                   Entities = nullptr;
+    std::unordered_map<Entity*, int>*  Indices = nullptr;
+    vector<Entity*>*                   Changed = nullptr;
+    int                                Holes = 0;
+    bool                               Sorted = true;
+    bool                               EntityDepthSortingEnabled = false;
+    bool                               NeedsSorting = false;
 };
 #endif
 
@@ -16,58 +21,204 @@ public:
 
 #include <Engine/Application.h>
 
+// The list is kept sorted by depth, except for the entities in Changed,
+// which were added or had their depth changed since the last sort. As
+// long as those are few, Sort takes them out and merges them back in,
+// instead of sorting everything again.
+
+struct DrawGroupMove {
+    Entity* Ent;
+    int     Index;
+};
+
 PUBLIC         DrawGroupList::DrawGroupList() {
     Init();
 }
 
-// Double linked-list functions
+PRIVATE void   DrawGroupList::AddChanged(Entity* obj) {
+    if (!Sorted)
+        return;
+
+    // Past this point, a full sort is cheaper than merging
+    if (Changed->size() > Entities->size() / 2 + 16) {
+        Changed->clear();
+        Sorted = false;
+        return;
+    }
+    Changed->push_back(obj);
+}
+
 PUBLIC int    DrawGroupList::Add(Entity* obj) {
+    int index = GetEntityIndex(obj);
+    if (index != -1)
+        return index;
+
+    index = (int)Entities->size();
     Entities->push_back(obj);
+    (*Indices)[obj] = index;
+
+    AddChanged(obj);
     if (EntityDepthSortingEnabled)
         NeedsSorting = true;
-    return Entities->size() - 1;
+    return index;
 }
 PUBLIC bool   DrawGroupList::Contains(Entity* obj) {
-    return GetEntityIndex(obj) == -1 ? false : true;
+    return Indices->count(obj) != 0;
 }
 PUBLIC int    DrawGroupList::GetEntityIndex(Entity* obj) {
-    for (size_t i = 0, iSz = Entities->size(); i < iSz; i++) {
-        if ((*Entities)[i] == obj)
-            return (int)i;
-    }
-    return -1;
+    std::unordered_map<Entity*, int>::iterator it = Indices->find(obj);
+    if (it == Indices->end())
+        return -1;
+    return it->second;
 }
 PUBLIC void    DrawGroupList::Remove(Entity* obj) {
-    for (size_t i = 0, iSz = Entities->size(); i < iSz; i++) {
-        if ((*Entities)[i] == obj) {
-            Entities->erase(Entities->begin() + i);
-            return;
-        }
-    }
+    std::unordered_map<Entity*, int>::iterator it = Indices->find(obj);
+    if (it == Indices->end())
+        return;
+
+    (*Entities)[it->second] = NULL;
+    Indices->erase(it);
+    Holes++;
+}
+PUBLIC void    DrawGroupList::DepthChanged(Entity* obj) {
+    AddChanged(obj);
+    NeedsSorting = true;
 }
 PUBLIC void    DrawGroupList::Clear() {
     Entities->clear();
+    Indices->clear();
+    Changed->clear();
+    Holes = 0;
+    Sorted = true;
     NeedsSorting = false;
 }
 
-PUBLIC void    DrawGroupList::Sort() {
+PUBLIC void    DrawGroupList::Compact() {
+    size_t count = 0;
+    for (size_t i = 0; i < Entities->size(); i++) {
+        Entity* ent = (*Entities)[i];
+        if (!ent)
+            continue;
+        if (i != count)
+            (*Indices)[ent] = (int)count;
+        (*Entities)[count++] = ent;
+    }
+    Entities->resize(count);
+    Holes = 0;
+}
+
+PRIVATE void   DrawGroupList::SortAll() {
+    Compact();
     std::stable_sort(Entities->begin(), Entities->end(), [](const Entity* entA, const Entity* entB) {
         return entA->Depth < entB->Depth;
     });
+    for (size_t i = 0; i < Entities->size(); i++)
+        (*Indices)[(*Entities)[i]] = (int)i;
+
+    Changed->clear();
+    Sorted = true;
+}
+
+PUBLIC void    DrawGroupList::Sort() {
     NeedsSorting = false;
+
+    if (!Sorted) {
+        SortAll();
+        return;
+    }
+
+    // Take the changed entities out, keeping where they were, so that
+    // ties are broken the same way a stable sort would
+    vector<DrawGroupMove> moved;
+    for (size_t i = 0; i < Changed->size(); i++) {
+        Entity* ent = (*Changed)[i];
+        std::unordered_map<Entity*, int>::iterator it = Indices->find(ent);
+        // Removed since, or listed twice
+        if (it == Indices->end() || !(*Entities)[it->second])
+            continue;
+
+        DrawGroupMove move;
+        move.Ent = ent;
+        move.Index = it->second;
+        moved.push_back(move);
+        (*Entities)[it->second] = NULL;
+    }
+    Changed->clear();
+
+    // Depths can also change without this list hearing about it: the
+    // entity may be in more than one draw group, it may not have updated,
+    // or it may have been copied over. If the rest is out of order, put
+    // the changed entities back and sort everything.
+    float lastDepth = -INFINITY;
+    for (size_t i = 0; i < Entities->size(); i++) {
+        Entity* ent = (*Entities)[i];
+        if (!ent)
+            continue;
+        if (ent->Depth < lastDepth) {
+            for (size_t m = 0; m < moved.size(); m++)
+                (*Entities)[moved[m].Index] = moved[m].Ent;
+            SortAll();
+            return;
+        }
+        lastDepth = ent->Depth;
+    }
+
+    std::sort(moved.begin(), moved.end(), [](const DrawGroupMove& a, const DrawGroupMove& b) {
+        if (a.Ent->Depth != b.Ent->Depth)
+            return a.Ent->Depth < b.Ent->Depth;
+        return a.Index < b.Index;
+    });
+
+    // Then merge them back into the rest
+    vector<Entity*> merged;
+    merged.reserve(Entities->size() - Holes);
+
+    size_t m = 0;
+    for (size_t i = 0; i < Entities->size(); i++) {
+        Entity* ent = (*Entities)[i];
+        if (!ent)
+            continue;
+
+        for (; m < moved.size(); m++) {
+            Entity* other = moved[m].Ent;
+            if (other->Depth > ent->Depth || (other->Depth == ent->Depth && moved[m].Index > (int)i))
+                break;
+            (*Indices)[other] = (int)merged.size();
+            merged.push_back(other);
+        }
+
+        if (i != merged.size())
+            (*Indices)[ent] = (int)merged.size();
+        merged.push_back(ent);
+    }
+    for (; m < moved.size(); m++) {
+        (*Indices)[moved[m].Ent] = (int)merged.size();
+        merged.push_back(moved[m].Ent);
+    }
+
+    Entities->swap(merged);
+    Holes = 0;
 }
 
 PUBLIC void    DrawGroupList::Init() {
     Entities = new vector<Entity*>();
+    Indices = new std::unordered_map<Entity*, int>();
+    Changed = new vector<Entity*>();
+    Holes = 0;
+    Sorted = true;
 }
 PUBLIC void    DrawGroupList::Dispose() {
     delete Entities;
+    delete Indices;
+    delete Changed;
     Entities = nullptr;
+    Indices = nullptr;
+    Changed = nullptr;
 }
 PUBLIC         DrawGroupList::~DrawGroupList() {
     // Dispose();
 }
 
 PUBLIC int     DrawGroupList::Count() {
-    return Entities->size();
+    return Entities->size() - Holes;
 }
@@ -6,43 +6,58 @@
 #include <Engine/Scene.h>
 
 #include <Engine/Types/EntityTypes.h>
+#include <Engine/Types/EntityComponents.h>
 #include <Engine/Includes/HashMap.h>
 
 need_t ObjectList;
 need_t ObjectRegistry;
 need_t DrawGroupList;
 
-class Entity {
+class Entity : public EntityComponentFields {
 public:
-    float        InitialX = 0;
-    float        InitialY = 0;
+    // The fields the scene reads for every entity on every update pass
+    // (list traversal, activity and on-screen tests, draw group upkeep)
+    // are kept together here.
+    Entity*      PrevEntity = NULL;
+    Entity*      NextEntity = NULL;
+    ObjectList*  List = NULL;
+
     int          Active = true;
     int          Pauseable = true;
-    int          Interactable = true;
-    int          Persistence = Persistence_NONE;
     int          Activity = ACTIVE_BOUNDS;
     int          InRange = false;
-    bool         Created = false;
-    bool         PostCreated = false;
+    int          OnScreen = true;
+    int          WasOffScreen = false;
 
-    float        X = 0.0f;
-    float        Y = 0.0f;
     float        Z = 0.0f;
 
-    float        XSpeed = 0.0f;
-    float        YSpeed = 0.0f;
+    int          Priority = 0;
+    int          PriorityListIndex = -1;
+    int          PriorityOld = -1;
+    float        Depth = 0.0f;
+    float        OldDepth = 0.0f;
+
+    // Position, motion, on-screen bounds and animation state are in
+    // EntityComponentFields
     float        GroundSpeed = 0.0f;
-    float        Gravity = 0.0f;
-    int          Ground = false;
+    int          AutoPhysics = false;
+    int          AutoAnimate = true;
 
-    int          WasOffScreen = false;
-    int          OnScreen = true;
-    float        OnScreenHitboxW = 0.0f;
-    float        OnScreenHitboxH = 0.0f;
-    float        OnScreenRegionTop = 0.0f;
-    float        OnScreenRegionLeft = 0.0f;
-    float        OnScreenRegionRight = 0.0f;
-    float        OnScreenRegionBottom = 0.0f;
+    EntityHitbox Hitbox;
+    int          FlipFlag = 0;
+
+    bool         Removed = false;
+
+    bool         InGrid = false;
+    bool         GridCellsUnbounded = false;
+    int          GridCellX1 = 0;
+    int          GridCellY1 = 0;
+    int          GridCellX2 = 0;
+    int          GridCellY2 = 0;
+    Uint32       GridQueryMark = 0;
+    int          GridDirtyIndex = -1;
+
+    // Rendering
     int          ViewRenderFlag = 0xFFFFFFFF;
     int          ViewOverrideFlag = 0;
     float        RenderRegionW = 0.0f;
@@ -51,6 +66,7 @@ public:
     float        RenderRegionLeft = 0.0f;
     float        RenderRegionRight = 0.0f;
     float        RenderRegionBottom = 0.0f;
+    float        ZDepth = 0.0;
 
     int          Angle = 0;
     int          AngleMode = 0;
@@ -58,30 +74,14 @@ public:
     float        ScaleY = 1.0;
     float        Rotation = 0.0;
     float        Alpha = 1.0;
-    int          AutoPhysics = false;
 
-    int          Priority = 0;
-    int          PriorityListIndex = -1;
-    int          PriorityOld = -1;
-
-    float        Depth = 0.0f;
-    float        OldDepth = 0.0f;
-    float        ZDepth = 0.0;
-
-    int          Sprite = -1;
-    int          CurrentAnimation = -1;
-    int          CurrentFrame = -1;
-    int          CurrentFrameCount = 0;
-    float        AnimationSpeedMult = 1.0;
-    int          AnimationSpeedAdd = 0;
-    int          AutoAnimate = true;
-    float        AnimationSpeed = 0.0;
-    float        AnimationTimer = 0.0;
-    int          AnimationFrameDuration = 0;
-    int          AnimationLoopIndex = 0;
-
-    EntityHitbox Hitbox;
-    int          FlipFlag = 0;
+    float        InitialX = 0;
+    float        InitialY = 0;
+    int          Interactable = true;
+    int          Persistence = Persistence_NONE;
+    bool         Created = false;
+    bool         PostCreated = false;
+    int          Ground = false;
 
     float        SensorX = 0.0f;
     float        SensorY = 0.0f;
@@ -99,17 +99,12 @@ public:
     int          CollisionLayers = 0;
     int          CollisionPlane = 0;
     int          CollisionMode = 0;
-    
-    int          SlotID = -1;
 
-    bool         Removed = false;
-
-    Entity*      PrevEntity = NULL;
-    Entity*      NextEntity = NULL;
+    int          SlotID = -1;
 
-    ObjectList*  List = NULL;
     Entity*      PrevEntityInList = NULL;
     Entity*      NextEntityInList = NULL;
+    int          IndexInList = -1;
 
     Entity*      PrevSceneEntity = NULL;
     Entity*      NextSceneEntity = NULL;
@@ -117,61 +112,31 @@ public:
 #endif
 
 #include <Engine/Types/Entity.h>
+#include <Engine/Types/SpatialGrid.h>
 
-PUBLIC void Entity::ApplyMotion() {
-    YSpeed += Gravity;
-    X += XSpeed;
-    Y += YSpeed;
+PUBLIC         Entity::Entity() {
+    ComponentSlot = EntityComponents::Allocate(this);
+    Components.Base = EntityComponents::GetBase(ComponentSlot);
+}
+PUBLIC         Entity::~Entity() {
+    if (Scene::ObjectGrid)
+        Scene::ObjectGrid->Remove(this);
+    EntityComponents::Free(ComponentSlot);
 }
-PUBLIC void Entity::Animate() {
-    ISprite* sprite = Scene::GetSpriteResource(Sprite);
-
-    if (!sprite || CurrentAnimation < 0 || (size_t)CurrentAnimation >= sprite->Animations.size())
-        return;
-
-#ifdef USE_RSDK_ANIMATE
-    AnimationTimer += (AnimationSpeed * AnimationSpeedMult + AnimationSpeedAdd);
-
-    while (AnimationTimer > AnimationFrameDuration) {
-        CurrentFrame++;
-
-        AnimationTimer -= AnimationFrameDuration;
-        if (CurrentFrame >= CurrentFrameCount) {
-            CurrentFrame = AnimationLoopIndex;
-            OnAnimationFinish();
-        }
-
-        AnimationFrameDuration = sprite->Animations[CurrentAnimation].Frames[CurrentFrame].Duration;
-    }
-#else
-    if ((float)AnimationFrameDuration - AnimationTimer > 0.0f) {
-        AnimationTimer += (AnimationSpeed * AnimationSpeedMult + AnimationSpeedAdd);
-        if ((float)AnimationFrameDuration - AnimationTimer <= 0.0f) {
-            CurrentFrame++;
-            if (CurrentFrame >= CurrentFrameCount) {
-                CurrentFrame = AnimationLoopIndex;
-                OnAnimationFinish();
-
-                // Sprite may have changed after a call to OnAnimationFinish
-                sprite = Scene::GetSpriteResource(Sprite);
-            }
 
-            // Do a basic range check, for strange loop points
-            // (or just in case CurrentAnimation happens to be invalid, which is very possible)
-            if (sprite && CurrentFrame < CurrentFrameCount && CurrentAnimation >= 0 && CurrentAnimation < sprite->Animations.size()) {
-                AnimationFrameDuration = sprite->Animations[CurrentAnimation].Frames[CurrentFrame].Duration;
-            }
-            else {
-                AnimationFrameDuration = 1.0f;
-            }
+// Must be called after anything that changes the entity's position,
+// hitbox or on-screen region, so region queries see the change.
+PUBLIC void Entity::MarkBoundsChanged() {
+    if (Scene::ObjectGrid)
+        Scene::ObjectGrid->MarkDirty(this);
+}
 
-            AnimationTimer = 0.0f;
-        }
-    }
-    else {
-        AnimationTimer = 0.0f;
-    }
-#endif
+PUBLIC void Entity::ApplyMotion() {
+    EntityComponents::ApplyMotion(ComponentSlot);
+    MarkBoundsChanged();
+}
+PUBLIC void Entity::Animate() {
+    EntityComponents::Animate(ComponentSlot);
 }
 PUBLIC void Entity::SetAnimation(int animation, int frame) {
     if (CurrentAnimation != animation)
@@ -228,6 +193,21 @@ PUBLIC bool Entity::CollideWithObject(Entity* other) {
         sourceX - sourceHitboxW > otherX + otherHitboxW ||
         sourceX + sourceHitboxW < otherX - otherHitboxW);
 }
+PUBLIC bool Entity::CollideWithRegion(float left, float top, float right, float bottom) {
+    float flipX = (this->FlipFlag & 1) ? -1.0 : 1.0;
+    float flipY = (this->FlipFlag & 2) ? -1.0 : 1.0;
+
+    float x = std::floor(this->X + this->Hitbox.OffsetX * flipX);
+    float y = std::floor(this->Y + this->Hitbox.OffsetY * flipY);
+
+    float hitboxW = this->Hitbox.Width * 0.5;
+    float hitboxH = this->Hitbox.Height * 0.5;
+
+    return !(y + hitboxH < top ||
+        y - hitboxH > bottom ||
+        left > x + hitboxW ||
+        right < x - hitboxW);
+}
 PUBLIC int  Entity::SolidCollideWithObject(Entity* other, int flag) {
     // NOTE: "flag" is setValues
     float initialOtherX = (other->X);
@@ -305,6 +285,7 @@ PUBLIC int  Entity::SolidCollideWithObject(Entity* other, int flag) {
             if (collideSideVert || !collideSideHori) {
                 other->X = initialOtherX;
                 other->Y = otherY;
+                other->MarkBoundsChanged();
                 if (flag == 1) {
                     if (collideSideVert != 1) {
                         if (collideSideVert == 4 && other->YSpeed < 0.0) {
@@ -329,6 +310,7 @@ PUBLIC int  Entity::SolidCollideWithObject(Entity* other, int flag) {
             if (collideSideVert && !collideSideHori) {
                 other->X = initialOtherX;
                 other->Y = otherY;
+                other->MarkBoundsChanged();
                 if (flag == 1) {
                     if (collideSideVert != 1) {
                         if (collideSideVert == 4 && other->YSpeed < 0.0) {
@@ -352,6 +334,7 @@ PUBLIC int  Entity::SolidCollideWithObject(Entity* other, int flag) {
 
         other->X = otherNewX;
         other->Y = initialOtherY;
+        other->MarkBoundsChanged();
         if (flag == 1) {
             float v50;
             if (other->Ground) {
@@ -406,6 +389,7 @@ PUBLIC bool Entity::TopSolidCollideWithObject(Entity* other, int flag) {
         return false;
 
     other->Y = this->Y + ((-sourceHitboxH + sourceHitboxOffY) - (otherHitboxH + otherHitboxOffY));
+    other->MarkBoundsChanged();
     if (flag) {
         other->YSpeed = 0.0;
         if (!other->Ground) {
@@ -527,6 +511,8 @@ PUBLIC void Entity::CopyFields(Entity* other) {
 
     COPY(Removed);
 #undef COPY
+
+    other->MarkBoundsChanged();
 }
 
 PUBLIC void Entity::ApplyPhysics() {
@@ -0,0 +1,217 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+#include <Engine/Sprites/Animation.h>
+#include <Engine/Types/EntityTypes.h>
+
+need_t Entity;
+
+class EntityComponents {
+public:
+    static vector<EntityComponentBlock*> Blocks;
+    static vector<Uint32>                FreeSlots;
+    static Uint32                        UsedCount;
+};
+#endif
+
+#include <Engine/Types/EntityComponents.h>
+
+#include <Engine/Types/Entity.h>
+#include <Engine/Diagnostics/Log.h>
+#include <Engine/Diagnostics/Memory.h>
+#include <Engine/ResourceTypes/ISprite.h>
+#include <Engine/Scene.h>
+
+vector<EntityComponentBlock*> EntityComponents::Blocks;
+vector<Uint32>                EntityComponents::FreeSlots;
+Uint32                        EntityComponents::UsedCount = 0;
+
+// Blocks are never moved or freed while entities exist, so an entity can
+// keep pointing into its block for as long as it lives.
+
+static inline EntityComponentBlock* GetBlock(Uint32 slot) {
+    return EntityComponents::Blocks[slot / ENTITY_COMPONENT_BLOCK_SIZE];
+}
+
+PRIVATE STATIC bool   EntityComponents::AddBlock() {
+    EntityComponentBlock* block = (EntityComponentBlock*)Memory::TrackedCalloc("EntityComponents::Block", 1, sizeof(EntityComponentBlock));
+    if (!block)
+        return false;
+
+    Uint32 first = (Uint32)(Blocks.size() * ENTITY_COMPONENT_BLOCK_SIZE);
+    Blocks.push_back(block);
+
+    // Pushed back to front, so slots get handed out in order
+    for (Uint32 i = ENTITY_COMPONENT_BLOCK_SIZE; i > 0; i--)
+        FreeSlots.push_back(first + i - 1);
+    return true;
+}
+
+// Gives the entity a slot, with its fields set to their defaults.
+PUBLIC STATIC Uint32  EntityComponents::Allocate(Entity* owner) {
+    if (FreeSlots.empty() && !AddBlock()) {
+        Log::Print(Log::LOG_ERROR, "Could not allocate entity components!");
+        abort();
+    }
+
+    Uint32 slot = FreeSlots.back();
+    FreeSlots.pop_back();
+    UsedCount++;
+
+    EntityComponentBlock* block = GetBlock(slot);
+    int i = slot % ENTITY_COMPONENT_BLOCK_SIZE;
+
+    block->X[i] = 0.0f;
+    block->Y[i] = 0.0f;
+    block->XSpeed[i] = 0.0f;
+    block->YSpeed[i] = 0.0f;
+    block->Gravity[i] = 0.0f;
+
+    block->OnScreenHitboxW[i] = 0.0f;
+    block->OnScreenHitboxH[i] = 0.0f;
+    block->OnScreenRegionTop[i] = 0.0f;
+    block->OnScreenRegionLeft[i] = 0.0f;
+    block->OnScreenRegionRight[i] = 0.0f;
+    block->OnScreenRegionBottom[i] = 0.0f;
+
+    block->Sprite[i] = -1;
+    block->CurrentAnimation[i] = -1;
+    block->CurrentFrame[i] = -1;
+    block->CurrentFrameCount[i] = 0;
+    block->AnimationSpeedMult[i] = 1.0f;
+    block->AnimationSpeedAdd[i] = 0;
+    block->AnimationSpeed[i] = 0.0f;
+    block->AnimationTimer[i] = 0.0f;
+    block->AnimationFrameDuration[i] = 0;
+    block->AnimationLoopIndex[i] = 0;
+
+    block->Pending[i] = 0;
+    block->Owner[i] = owner;
+    return slot;
+}
+PUBLIC STATIC void    EntityComponents::Free(Uint32 slot) {
+    EntityComponentBlock* block = GetBlock(slot);
+    int i = slot % ENTITY_COMPONENT_BLOCK_SIZE;
+    block->Pending[i] = 0;
+    block->Owner[i] = NULL;
+
+    FreeSlots.push_back(slot);
+    UsedCount--;
+}
+PUBLIC STATIC Uint8*  EntityComponents::GetBase(Uint32 slot) {
+    return (Uint8*)&GetBlock(slot)->X[slot % ENTITY_COMPONENT_BLOCK_SIZE];
+}
+
+PUBLIC STATIC void    EntityComponents::ApplyMotion(Uint32 slot) {
+    EntityComponentBlock* block = GetBlock(slot);
+    int i = slot % ENTITY_COMPONENT_BLOCK_SIZE;
+
+    block->YSpeed[i] += block->Gravity[i];
+    block->X[i] += block->XSpeed[i];
+    block->Y[i] += block->YSpeed[i];
+}
+PUBLIC STATIC void    EntityComponents::Animate(Uint32 slot) {
+    EntityComponentBlock* block = GetBlock(slot);
+    int i = slot % ENTITY_COMPONENT_BLOCK_SIZE;
+
+    ISprite* sprite = Scene::GetSpriteResource(block->Sprite[i]);
+
+    int animation = block->CurrentAnimation[i];
+    if (!sprite || animation < 0 || (size_t)animation >= sprite->Animations.size())
+        return;
+
+#ifdef USE_RSDK_ANIMATE
+    block->AnimationTimer[i] += (block->AnimationSpeed[i] * block->AnimationSpeedMult[i] + block->AnimationSpeedAdd[i]);
+
+    while (block->AnimationTimer[i] > block->AnimationFrameDuration[i]) {
+        block->CurrentFrame[i]++;
+
+        block->AnimationTimer[i] -= block->AnimationFrameDuration[i];
+        if (block->CurrentFrame[i] >= block->CurrentFrameCount[i]) {
+            block->CurrentFrame[i] = block->AnimationLoopIndex[i];
+            block->Owner[i]->OnAnimationFinish();
+        }
+
+        block->AnimationFrameDuration[i] = sprite->Animations[block->CurrentAnimation[i]].Frames[block->CurrentFrame[i]].Duration;
+    }
+#else
+    if ((float)block->AnimationFrameDuration[i] - block->AnimationTimer[i] > 0.0f) {
+        block->AnimationTimer[i] += (block->AnimationSpeed[i] * block->AnimationSpeedMult[i] + block->AnimationSpeedAdd[i]);
+        if ((float)block->AnimationFrameDuration[i] - block->AnimationTimer[i] <= 0.0f) {
+            block->CurrentFrame[i]++;
+            if (block->CurrentFrame[i] >= block->CurrentFrameCount[i]) {
+                block->CurrentFrame[i] = block->AnimationLoopIndex[i];
+                block->Owner[i]->OnAnimationFinish();
+
+                // Sprite may have changed after a call to OnAnimationFinish
+                sprite = Scene::GetSpriteResource(block->Sprite[i]);
+            }
+
+            // Do a basic range check, for strange loop points
+            // (or just in case CurrentAnimation happens to be invalid, which is very possible)
+            int frame = block->CurrentFrame[i];
+            animation = block->CurrentAnimation[i];
+            if (sprite && frame < block->CurrentFrameCount[i] && animation >= 0 && (size_t)animation < sprite->Animations.size()) {
+                block->AnimationFrameDuration[i] = sprite->Animations[animation].Frames[frame].Duration;
+            }
+            else {
+                block->AnimationFrameDuration[i] = 1.0f;
+            }
+
+            block->AnimationTimer[i] = 0.0f;
+        }
+    }
+    else {
+        block->AnimationTimer[i] = 0.0f;
+    }
+#endif
+}
+
+// Marks the entity to be animated and/or moved by the next RunPending.
+PUBLIC STATIC void    EntityComponents::SetPending(Uint32 slot, Uint8 flags) {
+    GetBlock(slot)->Pending[slot % ENTITY_COMPONENT_BLOCK_SIZE] |= flags;
+}
+// Animates, then moves, every entity marked by SetPending since the last
+// call, one block at a time.
+PUBLIC STATIC void    EntityComponents::RunPending() {
+    // OnAnimationFinish may add entities, and with them blocks, so the
+    // block count is read every time
+    for (size_t b = 0; b < Blocks.size(); b++) {
+        EntityComponentBlock* block = Blocks[b];
+        Uint32 first = (Uint32)(b * ENTITY_COMPONENT_BLOCK_SIZE);
+        for (int i = 0; i < ENTITY_COMPONENT_BLOCK_SIZE; i++) {
+            if (block->Pending[i] & ENTITY_PENDING_ANIMATE) {
+                block->Pending[i] &= ~ENTITY_PENDING_ANIMATE;
+                Animate(first + i);
+            }
+        }
+    }
+
+    for (size_t b = 0; b < Blocks.size(); b++) {
+        EntityComponentBlock* block = Blocks[b];
+        for (int i = 0; i < ENTITY_COMPONENT_BLOCK_SIZE; i++) {
+            if (!(block->Pending[i] & ENTITY_PENDING_MOTION))
+                continue;
+
+            block->YSpeed[i] += block->Gravity[i];
+            block->X[i] += block->XSpeed[i];
+            block->Y[i] += block->YSpeed[i];
+            block->Pending[i] = 0;
+
+            if (block->XSpeed[i] != 0.0f || block->YSpeed[i] != 0.0f)
+                block->Owner[i]->MarkBoundsChanged();
+        }
+    }
+}
+
+PUBLIC STATIC void    EntityComponents::Dispose() {
+    // Entities still alive would be left pointing at freed blocks
+    if (UsedCount) {
+        Log::Print(Log::LOG_WARN, "Entity Components: %u slots were never freed!", UsedCount);
+        return;
+    }
+
+    for (size_t i = 0; i < Blocks.size(); i++)
+        Memory::Free(Blocks[i]);
+    Blocks.clear();
+    FreeSlots.clear();
+}
@@ -0,0 +1,149 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+
+need_t Entity;
+
+class EntityPool {
+public:
+    enum {
+        HEADER_SIZE = 16,
+        SLOT_SIZE = 512,
+        CHUNK_SLOTS = 128,
+
+        INDEX_BITS = 20,
+        INDEX_MASK = (1 << INDEX_BITS) - 1,
+        GENERATION_MASK = (1 << (32 - INDEX_BITS)) - 1,
+
+        NO_SLOT = 0xFFFFFFFF
+    };
+
+    static vector<char*>  Chunks;
+    static vector<Uint32> FreeSlots;
+    static Uint32         UsedCount;
+};
+#endif
+
+#include <Engine/Types/EntityPool.h>
+
+#include <Engine/Types/Entity.h>
+#include <Engine/Diagnostics/Log.h>
+#include <Engine/Diagnostics/Memory.h>
+
+vector<char*>  EntityPool::Chunks;
+vector<Uint32> EntityPool::FreeSlots;
+Uint32         EntityPool::UsedCount = 0;
+
+// Sits right before every entity the pool hands out. A handle is the slot
+// index with the slot's generation above it; freeing a slot bumps its
+// generation, so handles to whatever lived there before stop resolving.
+struct EntitySlotHeader {
+    Uint32 Index;
+    Uint32 Generation;
+    Uint32 Used;
+};
+
+static inline EntitySlotHeader* GetSlot(Uint32 index) {
+    char* chunk = EntityPool::Chunks[index / EntityPool::CHUNK_SLOTS];
+    return (EntitySlotHeader*)(chunk + (index % EntityPool::CHUNK_SLOTS) * EntityPool::SLOT_SIZE);
+}
+static inline EntitySlotHeader* GetHeader(void* pointer) {
+    return (EntitySlotHeader*)((char*)pointer - EntityPool::HEADER_SIZE);
+}
+
+PRIVATE STATIC bool EntityPool::AddChunk() {
+    Uint32 first = (Uint32)(Chunks.size() * CHUNK_SLOTS);
+    if (first + CHUNK_SLOTS > INDEX_MASK + 1)
+        return false;
+
+    char* chunk = (char*)Memory::TrackedMalloc("EntityPool::Chunk", SLOT_SIZE * CHUNK_SLOTS);
+    if (!chunk)
+        return false;
+
+    Chunks.push_back(chunk);
+
+    // Pushed back to front, so slots get handed out in address order
+    for (Uint32 i = CHUNK_SLOTS; i > 0; i--) {
+        EntitySlotHeader* header = (EntitySlotHeader*)(chunk + (i - 1) * SLOT_SIZE);
+        header->Index = first + i - 1;
+        header->Generation = 1;
+        header->Used = false;
+        FreeSlots.push_back(header->Index);
+    }
+    return true;
+}
+
+// Returns memory for an entity of the given size, to construct it in with
+// placement new. Entities too big for a slot come from the heap, and have
+// no handle.
+PUBLIC STATIC void*   EntityPool::Alloc(size_t size) {
+    if (size + HEADER_SIZE > SLOT_SIZE || (FreeSlots.empty() && !AddChunk())) {
+        EntitySlotHeader* header = (EntitySlotHeader*)Memory::TrackedMalloc("EntityPool::Alloc", size + HEADER_SIZE);
+        header->Index = NO_SLOT;
+        header->Generation = 0;
+        header->Used = true;
+        return (char*)header + HEADER_SIZE;
+    }
+
+    Uint32 index = FreeSlots.back();
+    FreeSlots.pop_back();
+
+    EntitySlotHeader* header = GetSlot(index);
+    header->Used = true;
+    UsedCount++;
+    return (char*)header + HEADER_SIZE;
+}
+// Takes back memory from Alloc, after the entity has been destructed.
+PUBLIC STATIC void    EntityPool::Free(void* pointer) {
+    EntitySlotHeader* header = GetHeader(pointer);
+    if (header->Index == NO_SLOT) {
+        Memory::Free(header);
+        return;
+    }
+
+    header->Used = false;
+    header->Generation = (header->Generation + 1) & GENERATION_MASK;
+    if (!header->Generation)
+        header->Generation = 1;
+
+    FreeSlots.push_back(header->Index);
+    UsedCount--;
+}
+
+// Returns 0 for entities without a handle.
+PUBLIC STATIC Uint32  EntityPool::GetHandle(Entity* ent) {
+    EntitySlotHeader* header = GetHeader(ent);
+    if (header->Index == NO_SLOT)
+        return 0;
+    return (header->Generation << INDEX_BITS) | header->Index;
+}
+// Returns NULL if the entity the handle was made for has since been freed.
+PUBLIC STATIC Entity* EntityPool::Get(Uint32 handle) {
+    Uint32 index = handle & INDEX_MASK;
+    if (index >= Chunks.size() * CHUNK_SLOTS)
+        return NULL;
+
+    EntitySlotHeader* header = GetSlot(index);
+    if (!header->Used || header->Generation != handle >> INDEX_BITS)
+        return NULL;
+    return (Entity*)((char*)header + HEADER_SIZE);
+}
+
+PUBLIC STATIC void    EntityPool::PrintStatus() {
+    Log::Print(Log::LOG_IMPORTANT, "Entity Pool: %u / %u slots used (%u KiB)",
+        UsedCount, (Uint32)(Chunks.size() * CHUNK_SLOTS),
+        (Uint32)(Chunks.size() * SLOT_SIZE * CHUNK_SLOTS / 1024));
+}
+
+PUBLIC STATIC void    EntityPool::Dispose() {
+    // Anything still pointing into the pool would be left dangling
+    if (UsedCount) {
+        Log::Print(Log::LOG_WARN, "Entity Pool: %u entities were never freed!", UsedCount);
+        return;
+    }
+
+    for (size_t i = 0; i < Chunks.size(); i++)
+        Memory::Free(Chunks[i]);
+    Chunks.clear();
+    FreeSlots.clear();
+    UsedCount = 0;
+}
@@ -2,6 +2,7 @@
 #define ENTITYTYPES_H
 
 #include <Engine/Types/Collision.h>
+#include <stddef.h>
 
 enum {
     Persistence_NONE,
@@ -99,6 +100,117 @@ struct ObjectListPerformance {
     }
 };
 
+#define ENTITY_COMPONENT_BLOCK_SIZE 256
+
+enum {
+    ENTITY_PENDING_ANIMATE = 1 << 0,
+    ENTITY_PENDING_MOTION  = 1 << 1
+};
+
+// The entity fields that per-frame passes read for every entity, stored
+// as one array per field so that those passes run over contiguous
+// memory. An entity's component slot picks a block and an index in it.
+// Every field array holds 4-byte elements, so each entity's fields are a
+// fixed distance from its X (see EntityComponentRef).
+struct EntityComponentBlock {
+    // Position and motion
+    float   X[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   Y[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   XSpeed[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   YSpeed[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   Gravity[ENTITY_COMPONENT_BLOCK_SIZE];
+
+    // On-screen bounds
+    float   OnScreenHitboxW[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   OnScreenHitboxH[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   OnScreenRegionTop[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   OnScreenRegionLeft[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   OnScreenRegionRight[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   OnScreenRegionBottom[ENTITY_COMPONENT_BLOCK_SIZE];
+
+    // Animation
+    int     Sprite[ENTITY_COMPONENT_BLOCK_SIZE];
+    int     CurrentAnimation[ENTITY_COMPONENT_BLOCK_SIZE];
+    int     CurrentFrame[ENTITY_COMPONENT_BLOCK_SIZE];
+    int     CurrentFrameCount[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   AnimationSpeedMult[ENTITY_COMPONENT_BLOCK_SIZE];
+    int     AnimationSpeedAdd[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   AnimationSpeed[ENTITY_COMPONENT_BLOCK_SIZE];
+    float   AnimationTimer[ENTITY_COMPONENT_BLOCK_SIZE];
+    int     AnimationFrameDuration[ENTITY_COMPONENT_BLOCK_SIZE];
+    int     AnimationLoopIndex[ENTITY_COMPONENT_BLOCK_SIZE];
+
+    // Not entity fields
+    Uint8   Pending[ENTITY_COMPONENT_BLOCK_SIZE]; // ENTITY_PENDING_* flags
+    Entity* Owner[ENTITY_COMPONENT_BLOCK_SIZE];   // NULL for free slots
+};
+
+// The address of an entity's X in its block.
+struct EntityComponentBase {
+    Uint8* Base;
+};
+
+// Stands in for an entity field kept in the entity's component block, so
+// that code can go on using ent->X as if it were a plain member. Shares
+// its only member with EntityComponentBase, which it sits in a union with.
+template <typename T, size_t Offset>
+struct EntityComponentRef {
+    static_assert(sizeof(T) == sizeof(float), "Component fields must be 4 bytes wide");
+
+    Uint8* Base;
+
+    T&   Get() const { return *(T*)(Base + Offset); }
+    operator T&() const { return Get(); }
+    T*   operator&() const { return &Get(); }
+
+    EntityComponentRef& operator=(const EntityComponentRef& other) { Get() = other.Get(); return *this; }
+    EntityComponentRef& operator=(T value) { Get() = value; return *this; }
+    EntityComponentRef& operator+=(T value) { Get() += value; return *this; }
+    EntityComponentRef& operator-=(T value) { Get() -= value; return *this; }
+    EntityComponentRef& operator*=(T value) { Get() *= value; return *this; }
+    EntityComponentRef& operator/=(T value) { Get() /= value; return *this; }
+    T&   operator++() { return ++Get(); }
+    T&   operator--() { return --Get(); }
+    T    operator++(int) { return Get()++; }
+    T    operator--(int) { return Get()--; }
+};
+
+#define ENTITY_COMPONENT(type, name) \
+    EntityComponentRef<type, offsetof(EntityComponentBlock, name)> name
+
+// The entity fields kept in its component block. Entity sets these up
+// when it's constructed.
+struct EntityComponentFields {
+    Uint32 ComponentSlot;
+    union {
+        EntityComponentBase Components;
+
+        ENTITY_COMPONENT(float, X);
+        ENTITY_COMPONENT(float, Y);
+        ENTITY_COMPONENT(float, XSpeed);
+        ENTITY_COMPONENT(float, YSpeed);
+        ENTITY_COMPONENT(float, Gravity);
+
+        ENTITY_COMPONENT(float, OnScreenHitboxW);
+        ENTITY_COMPONENT(float, OnScreenHitboxH);
+        ENTITY_COMPONENT(float, OnScreenRegionTop);
+        ENTITY_COMPONENT(float, OnScreenRegionLeft);
+        ENTITY_COMPONENT(float, OnScreenRegionRight);
+        ENTITY_COMPONENT(float, OnScreenRegionBottom);
+
+        ENTITY_COMPONENT(int, Sprite);
+        ENTITY_COMPONENT(int, CurrentAnimation);
+        ENTITY_COMPONENT(int, CurrentFrame);
+        ENTITY_COMPONENT(int, CurrentFrameCount);
+        ENTITY_COMPONENT(float, AnimationSpeedMult);
+        ENTITY_COMPONENT(int, AnimationSpeedAdd);
+        ENTITY_COMPONENT(float, AnimationSpeed);
+        ENTITY_COMPONENT(float, AnimationTimer);
+        ENTITY_COMPONENT(int, AnimationFrameDuration);
+        ENTITY_COMPONENT(int, AnimationLoopIndex);
+    };
+};
+
 #define DEBUG_HITBOX_COUNT 0x400
 
 struct DebugHitboxInfo {
@@ -9,6 +9,11 @@ public:
     Entity* EntityFirst = nullptr;
     Entity* EntityLast = nullptr;
 
+    // The same entities in the same order, for lookup by index. Removed
+    // entities leave a NULL behind until the next Compact.
+    vector<Entity*> Entities;
+    int             Holes = 0;
+
     char* ObjectName;
     char* LoadFunctionName;
     char* GlobalUpdateFunctionName;
@@ -55,14 +60,14 @@ PUBLIC void    ObjectList::Add(Entity* obj) {
     EntityLast = obj;
 
     EntityCount++;
+
+    obj->IndexInList = (int)Entities.size();
+    Entities.push_back(obj);
 }
 PUBLIC bool    ObjectList::Contains(Entity* obj) {
-    for (Entity* search = EntityFirst; search != NULL; search = search->NextEntityInList) {
-        if (search == obj)
-            return true;
-    }
-
-    return false;
+    return obj->IndexInList >= 0
+        && obj->IndexInList < (int)Entities.size()
+        && Entities[obj->IndexInList] == obj;
 }
 PUBLIC void    ObjectList::Remove(Entity* obj) {
     if (obj == NULL) return;
@@ -85,12 +90,37 @@ PUBLIC void    ObjectList::Remove(Entity* obj) {
     obj->NextEntityInList = NULL;
 
     EntityCount--;
+
+    if (Contains(obj)) {
+        Entities[obj->IndexInList] = NULL;
+        Holes++;
+
+        // Don't let the array grow forever under heavy spawning
+        if (Holes > 64 && Holes > (int)Entities.size() / 2)
+            Compact();
+    }
+    obj->IndexInList = -1;
+}
+PRIVATE void   ObjectList::Compact() {
+    size_t count = 0;
+    for (size_t i = 0; i < Entities.size(); i++) {
+        Entity* ent = Entities[i];
+        if (!ent)
+            continue;
+        ent->IndexInList = (int)count;
+        Entities[count++] = ent;
+    }
+    Entities.resize(count);
+    Holes = 0;
 }
 PUBLIC void    ObjectList::Clear() {
     EntityCount = 0;
     EntityFirst = NULL;
     EntityLast = NULL;
 
+    Entities.clear();
+    Holes = 0;
+
     ResetPerf();
 }
 
@@ -119,9 +149,14 @@ PUBLIC void ObjectList::ResetPerf() {
     Performance.Clear();
 }
 PUBLIC Entity* ObjectList::GetNth(int n) {
-    Entity* ent = EntityFirst;
-    for (ent = EntityFirst; ent != NULL && n > 0; ent = ent->NextEntityInList, n--);
-    return ent;
+    if (Holes)
+        Compact();
+
+    if (n < 0)
+        n = 0;
+    if (n >= (int)Entities.size())
+        return NULL;
+    return Entities[n];
 }
 PUBLIC Entity* ObjectList::GetClosest(int x, int y) {
     if (!EntityCount)
@@ -4,7 +4,14 @@
 
 class ObjectRegistry {
 public:
+    // Removed entities leave a NULL behind until the next Compact.
     vector<Entity*> List;
+    int             Holes = 0;
+
+    // Where each entity first appears in List. An entity can be added more
+    // than once; Duplicates counts the extra entries.
+    std::unordered_map<Entity*, int> Indices;
+    int             Duplicates = 0;
 };
 #endif
 
@@ -13,26 +20,67 @@ public:
 #include <Engine/Application.h>
 
 PUBLIC void    ObjectRegistry::Add(Entity* obj) {
+    if (!Indices.emplace(obj, (int)List.size()).second)
+        Duplicates++;
     List.push_back(obj);
 }
 PUBLIC bool    ObjectRegistry::Contains(Entity* obj) {
-    return std::find(List.begin(), List.end(), obj) != List.end();
+    return Indices.find(obj) != Indices.end();
 }
 PUBLIC void    ObjectRegistry::Remove(Entity* obj) {
     if (obj == NULL) return;
 
-    for (int i = 0, iSz = (int)List.size(); i < iSz; i++) {
-        if (List[i] == obj) {
-            List.erase(List.begin() + i);
-            break;
+    auto it = Indices.find(obj);
+    if (it == Indices.end())
+        return;
+
+    int index = it->second;
+    List[index] = NULL;
+    Holes++;
+
+    // Point at the next entry for the same entity, if there is one
+    bool found = false;
+    if (Duplicates) {
+        for (size_t i = index + 1; i < List.size(); i++) {
+            if (List[i] == obj) {
+                it->second = (int)i;
+                Duplicates--;
+                found = true;
+                break;
+            }
         }
     }
+    if (!found)
+        Indices.erase(it);
+
+    // Don't let the list grow forever under heavy spawning
+    if (Holes > 64 && Holes > (int)List.size() / 2)
+        Compact();
+}
+PRIVATE void   ObjectRegistry::Compact() {
+    size_t count = 0;
+    for (size_t i = 0; i < List.size(); i++) {
+        if (List[i])
+            List[count++] = List[i];
+    }
+    List.resize(count);
+    Holes = 0;
+
+    Indices.clear();
+    for (size_t i = 0; i < List.size(); i++)
+        Indices.emplace(List[i], (int)i);
 }
 PUBLIC void    ObjectRegistry::Clear() {
     List.clear();
+    Indices.clear();
+    Holes = 0;
+    Duplicates = 0;
 }
 PUBLIC void ObjectRegistry::Iterate(std::function<void(Entity* e)> func) {
-    std::for_each(List.begin(), List.end(), func);
+    for (size_t i = 0; i < List.size(); i++) {
+        if (List[i])
+            func(List[i]);
+    }
 }
 PUBLIC void ObjectRegistry::RemoveNonPersistentFromLinkedList(Entity* first, int persistence) {
     for (Entity* ent = first, *next; ent; ent = next) {
@@ -48,13 +96,16 @@ PUBLIC void ObjectRegistry::RemoveNonPersistentFromLinkedList(Entity* first) {
     RemoveNonPersistentFromLinkedList(first, Persistence_NONE);
 }
 PUBLIC Entity* ObjectRegistry::GetNth(int n) {
+    if (Holes)
+        Compact();
+
     if (n < 0 || n >= (int)List.size())
         return NULL;
     return List[n];
 }
 PUBLIC Entity* ObjectRegistry::GetClosest(int x, int y) {
-    if (List.size() == 1)
-        return List[0];
+    if (Count() == 1)
+        return GetNth(0);
 
     Entity* closest = NULL;
     int smallestDistance = 0x7FFFFFFF;
@@ -72,7 +123,7 @@ PUBLIC Entity* ObjectRegistry::GetClosest(int x, int y) {
 }
 
 PUBLIC void    ObjectRegistry::Dispose() {
-    List.clear();
+    Clear();
     List.shrink_to_fit();
 }
 PUBLIC         ObjectRegistry::~ObjectRegistry() {
@@ -80,5 +131,5 @@ PUBLIC         ObjectRegistry::~ObjectRegistry() {
 }
 
 PUBLIC int     ObjectRegistry::Count() {
-    return (int)List.size();
+    return (int)List.size() - Holes;
 }
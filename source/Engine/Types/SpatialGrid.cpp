@@ -0,0 +1,260 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+
+need_t Entity;
+
+class SpatialGrid {
+public:
+    enum {
+        CELL_SHIFT = 7,
+        BUCKET_COUNT = 4096,
+        MAX_CELLS_PER_ENTITY = 16
+    };
+
+    vector<Entity*>* Buckets = nullptr;
+    vector<Entity*>  Unbounded;
+    vector<Entity*>  Dirty;
+    Uint32           QueryMark = 0;
+};
+#endif
+
+#include <Engine/Types/SpatialGrid.h>
+
+#include <Engine/Types/Entity.h>
+
+// Entities are kept in every cell their bounds touch. Cells are hashed into
+// a fixed number of buckets, so an unbounded scene takes no more memory
+// than a small one; cells that share a bucket are told apart by the exact
+// bounds test every query does anyway.
+
+static inline int    GetCell(float coord) {
+    // Keeps far-off (or infinite) coordinates from overflowing
+    float cell = std::floor(coord / (float)(1 << SpatialGrid::CELL_SHIFT));
+    if (!(cell > -0x100000))
+        return -0x100000;
+    if (cell > 0x100000)
+        return 0x100000;
+    return (int)cell;
+}
+static inline Uint32 GetBucketIndex(int cellX, int cellY) {
+    return ((Uint32)cellX * 73856093U ^ (Uint32)cellY * 19349663U) & (SpatialGrid::BUCKET_COUNT - 1);
+}
+
+// The bounds cover the entity's hitbox wherever its offset and flip put it,
+// and its on-screen region, if that has a size on both axes.
+static void GetEntityBounds(Entity* ent, float* left, float* top, float* right, float* bottom) {
+    float hitboxW = ent->Hitbox.Width * 0.5f + std::abs(ent->Hitbox.OffsetX) + 1.0f;
+    float hitboxH = ent->Hitbox.Height * 0.5f + std::abs(ent->Hitbox.OffsetY) + 1.0f;
+    *left = ent->X - hitboxW;
+    *right = ent->X + hitboxW;
+    *top = ent->Y - hitboxH;
+    *bottom = ent->Y + hitboxH;
+
+    float regionLeft, regionRight;
+    float regionTop, regionBottom;
+    if (ent->OnScreenRegionLeft || ent->OnScreenRegionRight) {
+        regionLeft = ent->X - ent->OnScreenRegionLeft;
+        regionRight = ent->X + ent->OnScreenRegionRight;
+    }
+    else if (ent->OnScreenHitboxW != 0.0f) {
+        regionLeft = ent->X - ent->OnScreenHitboxW * 0.5f;
+        regionRight = ent->X + ent->OnScreenHitboxW * 0.5f;
+    }
+    else
+        return;
+
+    if (ent->OnScreenRegionTop || ent->OnScreenRegionBottom) {
+        regionTop = ent->Y - ent->OnScreenRegionTop;
+        regionBottom = ent->Y + ent->OnScreenRegionBottom;
+    }
+    else if (ent->OnScreenHitboxH != 0.0f) {
+        regionTop = ent->Y - ent->OnScreenHitboxH * 0.5f;
+        regionBottom = ent->Y + ent->OnScreenHitboxH * 0.5f;
+    }
+    else
+        return;
+
+    *left = std::min(*left, std::min(regionLeft, regionRight));
+    *right = std::max(*right, std::max(regionLeft, regionRight));
+    *top = std::min(*top, std::min(regionTop, regionBottom));
+    *bottom = std::max(*bottom, std::max(regionTop, regionBottom));
+}
+
+PUBLIC SpatialGrid::SpatialGrid() {
+    Buckets = new vector<Entity*>[BUCKET_COUNT];
+}
+
+PRIVATE void SpatialGrid::Link(Entity* ent) {
+    if (ent->GridCellsUnbounded) {
+        Unbounded.push_back(ent);
+        return;
+    }
+
+    for (int cy = ent->GridCellY1; cy <= ent->GridCellY2; cy++)
+        for (int cx = ent->GridCellX1; cx <= ent->GridCellX2; cx++)
+            Buckets[GetBucketIndex(cx, cy)].push_back(ent);
+}
+PRIVATE void SpatialGrid::Unlink(Entity* ent) {
+    if (ent->GridCellsUnbounded) {
+        for (size_t i = 0; i < Unbounded.size(); i++) {
+            if (Unbounded[i] == ent) {
+                Unbounded[i] = Unbounded.back();
+                Unbounded.pop_back();
+                break;
+            }
+        }
+        return;
+    }
+
+    // Order within a bucket doesn't matter, so removal is a swap with the last
+    for (int cy = ent->GridCellY1; cy <= ent->GridCellY2; cy++) {
+        for (int cx = ent->GridCellX1; cx <= ent->GridCellX2; cx++) {
+            vector<Entity*>& bucket = Buckets[GetBucketIndex(cx, cy)];
+            for (size_t i = 0; i < bucket.size(); i++) {
+                if (bucket[i] == ent) {
+                    bucket[i] = bucket.back();
+                    bucket.pop_back();
+                    break;
+                }
+            }
+        }
+    }
+}
+
+PUBLIC void SpatialGrid::Insert(Entity* ent) {
+    if (ent->InGrid)
+        Remove(ent);
+
+    float left, top, right, bottom;
+    GetEntityBounds(ent, &left, &top, &right, &bottom);
+
+    ent->GridCellX1 = GetCell(left);
+    ent->GridCellY1 = GetCell(top);
+    ent->GridCellX2 = GetCell(right);
+    ent->GridCellY2 = GetCell(bottom);
+    ent->GridCellsUnbounded = (Sint64)(ent->GridCellX2 - ent->GridCellX1 + 1) * (ent->GridCellY2 - ent->GridCellY1 + 1) > MAX_CELLS_PER_ENTITY;
+    ent->InGrid = true;
+
+    Link(ent);
+}
+// Moves the entity to the cells it now touches. Returns false if those are
+// the cells it was already in.
+PUBLIC bool SpatialGrid::Update(Entity* ent) {
+    if (!ent->InGrid)
+        return false;
+
+    float left, top, right, bottom;
+    GetEntityBounds(ent, &left, &top, &right, &bottom);
+
+    int x1 = GetCell(left);
+    int y1 = GetCell(top);
+    int x2 = GetCell(right);
+    int y2 = GetCell(bottom);
+    if (x1 == ent->GridCellX1 && y1 == ent->GridCellY1 && x2 == ent->GridCellX2 && y2 == ent->GridCellY2)
+        return false;
+
+    Unlink(ent);
+    ent->GridCellX1 = x1;
+    ent->GridCellY1 = y1;
+    ent->GridCellX2 = x2;
+    ent->GridCellY2 = y2;
+    ent->GridCellsUnbounded = (Sint64)(x2 - x1 + 1) * (y2 - y1 + 1) > MAX_CELLS_PER_ENTITY;
+    Link(ent);
+    return true;
+}
+PUBLIC void SpatialGrid::Remove(Entity* ent) {
+    if (ent->GridDirtyIndex >= 0) {
+        Entity* last = Dirty.back();
+        Dirty[ent->GridDirtyIndex] = last;
+        last->GridDirtyIndex = ent->GridDirtyIndex;
+        Dirty.pop_back();
+        ent->GridDirtyIndex = -1;
+    }
+
+    if (!ent->InGrid)
+        return;
+
+    Unlink(ent);
+    ent->InGrid = false;
+}
+PUBLIC void SpatialGrid::Clear() {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        for (size_t e = 0; e < Buckets[i].size(); e++)
+            Buckets[i][e]->InGrid = false;
+        Buckets[i].clear();
+    }
+    for (size_t e = 0; e < Unbounded.size(); e++)
+        Unbounded[e]->InGrid = false;
+    Unbounded.clear();
+    for (size_t e = 0; e < Dirty.size(); e++)
+        Dirty[e]->GridDirtyIndex = -1;
+    Dirty.clear();
+}
+
+// Queues the entity to be inserted, or moved to the cells it now touches,
+// by the next Refresh. An entity is only queued once.
+PUBLIC void SpatialGrid::MarkDirty(Entity* ent) {
+    if (ent->GridDirtyIndex >= 0)
+        return;
+
+    ent->GridDirtyIndex = (int)Dirty.size();
+    Dirty.push_back(ent);
+}
+PUBLIC void SpatialGrid::Refresh() {
+    for (size_t i = 0; i < Dirty.size(); i++) {
+        Entity* ent = Dirty[i];
+        ent->GridDirtyIndex = -1;
+        if (!ent->InGrid)
+            Insert(ent);
+        else
+            Update(ent);
+    }
+    Dirty.clear();
+}
+
+// Appends every entity whose bounds may touch the given rectangle to list,
+// once each. Callers do the exact test.
+PUBLIC void SpatialGrid::Query(float left, float top, float right, float bottom, vector<Entity*>* list) {
+    // Marks entities already added, for those that span several cells
+    QueryMark++;
+    if (QueryMark == 0) {
+        for (int i = 0; i < BUCKET_COUNT; i++)
+            for (size_t e = 0; e < Buckets[i].size(); e++)
+                Buckets[i][e]->GridQueryMark = 0;
+        QueryMark = 1;
+    }
+
+    int x1 = GetCell(std::min(left, right));
+    int y1 = GetCell(std::min(top, bottom));
+    int x2 = GetCell(std::max(left, right));
+    int y2 = GetCell(std::max(top, bottom));
+
+    // A rectangle covering more cells than there are buckets visits
+    // every bucket once instead
+    bool allBuckets = (Sint64)(x2 - x1 + 1) * (y2 - y1 + 1) >= BUCKET_COUNT;
+    if (allBuckets) {
+        x1 = y1 = 0;
+        x2 = BUCKET_COUNT - 1;
+        y2 = 0;
+    }
+
+    for (int cy = y1; cy <= y2; cy++) {
+        for (int cx = x1; cx <= x2; cx++) {
+            vector<Entity*>& bucket = Buckets[allBuckets ? cx : GetBucketIndex(cx, cy)];
+            for (size_t i = 0; i < bucket.size(); i++) {
+                Entity* ent = bucket[i];
+                if (ent->GridQueryMark == QueryMark)
+                    continue;
+                ent->GridQueryMark = QueryMark;
+                list->push_back(ent);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < Unbounded.size(); i++)
+        list->push_back(Unbounded[i]);
+}
+
+PUBLIC SpatialGrid::~SpatialGrid() {
+    delete[] Buckets;
+}
@@ -0,0 +1,187 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+#include <Engine/Includes/StandardSDL2.h>
+
+class JobSystem {
+public:
+    typedef void (*JobFunction)(void* data, int worker);
+    typedef bool (*WaitCondition)(void* data);
+
+    struct Job {
+        JobFunction Function;
+        void*       Data;
+    };
+
+    enum {
+        // Each worker runs script code on its own VMThread, and
+        // ScriptManager keeps the first of its eight for the main thread.
+        MAX_WORKERS = 7,
+        QUEUE_SIZE = 64
+    };
+
+    static SDL_Thread* Workers[MAX_WORKERS];
+    static int         WorkerCount;
+
+    static Job         Queue[QUEUE_SIZE];
+    static Uint32      QueueStart;
+    static Uint32      QueueCount;
+    static Uint32      PendingCount;
+    static bool        Running;
+
+    static SDL_mutex*  QueueLock;
+    static SDL_cond*   WorkReady;
+    static SDL_cond*   WorkDone;
+};
+#endif
+
+#include <Engine/Utilities/JobSystem.h>
+
+#include <Engine/Diagnostics/Log.h>
+
+SDL_Thread*     JobSystem::Workers[JobSystem::MAX_WORKERS];
+int             JobSystem::WorkerCount = 0;
+
+JobSystem::Job  JobSystem::Queue[JobSystem::QUEUE_SIZE];
+Uint32          JobSystem::QueueStart = 0;
+Uint32          JobSystem::QueueCount = 0;
+Uint32          JobSystem::PendingCount = 0;
+bool            JobSystem::Running = false;
+
+SDL_mutex*      JobSystem::QueueLock = NULL;
+SDL_cond*       JobSystem::WorkReady = NULL;
+SDL_cond*       JobSystem::WorkDone = NULL;
+
+PUBLIC STATIC void JobSystem::Init() {
+    // Leave a core for the main thread.
+    int count = SDL_GetCPUCount() - 1;
+    if (count < 1)
+        count = 1;
+    if (count > MAX_WORKERS)
+        count = MAX_WORKERS;
+
+    Init(count);
+}
+PUBLIC STATIC void JobSystem::Init(int count) {
+    if (Running)
+        return;
+
+    QueueLock = SDL_CreateMutex();
+    WorkReady = SDL_CreateCond();
+    WorkDone = SDL_CreateCond();
+    QueueStart = 0;
+    QueueCount = 0;
+    PendingCount = 0;
+    Running = true;
+
+    WorkerCount = 0;
+    for (int i = 0; i < count && i < MAX_WORKERS; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "Worker %d", i);
+
+        Workers[WorkerCount] = SDL_CreateThread(WorkerMain, name, (void*)(intptr_t)WorkerCount);
+        if (!Workers[WorkerCount]) {
+            Log::Print(Log::LOG_ERROR, "Could not create worker thread: %s", SDL_GetError());
+            break;
+        }
+        WorkerCount++;
+    }
+
+    Log::Print(Log::LOG_VERBOSE, "Started %d worker threads.", WorkerCount);
+}
+
+PRIVATE STATIC int  JobSystem::WorkerMain(void* data) {
+    int worker = (int)(intptr_t)data;
+
+    SDL_LockMutex(QueueLock);
+    while (true) {
+        while (Running && QueueCount == 0)
+            SDL_CondWait(WorkReady, QueueLock);
+
+        // Whatever is still queued when shutting down gets run first.
+        if (QueueCount == 0)
+            break;
+
+        Job job = Queue[QueueStart];
+        QueueStart = (QueueStart + 1) % QUEUE_SIZE;
+        QueueCount--;
+
+        SDL_UnlockMutex(QueueLock);
+        job.Function(job.Data, worker);
+        SDL_LockMutex(QueueLock);
+
+        PendingCount--;
+        SDL_CondBroadcast(WorkDone);
+    }
+    SDL_UnlockMutex(QueueLock);
+    return 0;
+}
+
+// Returns false if the queue is full.
+PUBLIC STATIC bool JobSystem::Submit(JobFunction function, void* data) {
+    // Without any workers the job just runs here and now.
+    if (WorkerCount == 0) {
+        function(data, 0);
+        return true;
+    }
+
+    SDL_LockMutex(QueueLock);
+    if (QueueCount == QUEUE_SIZE) {
+        SDL_UnlockMutex(QueueLock);
+        return false;
+    }
+
+    Job* job = &Queue[(QueueStart + QueueCount) % QUEUE_SIZE];
+    job->Function = function;
+    job->Data = data;
+    QueueCount++;
+    PendingCount++;
+
+    SDL_CondSignal(WorkReady);
+    SDL_UnlockMutex(QueueLock);
+    return true;
+}
+
+// Blocks until the condition holds. It is checked again every time a job
+// finishes, so it must only depend on state that a job changes.
+PUBLIC STATIC void JobSystem::WaitUntil(WaitCondition condition, void* data) {
+    if (WorkerCount == 0)
+        return;
+
+    SDL_LockMutex(QueueLock);
+    while (!condition(data))
+        SDL_CondWait(WorkDone, QueueLock);
+    SDL_UnlockMutex(QueueLock);
+}
+PUBLIC STATIC void JobSystem::WaitAll() {
+    if (WorkerCount == 0)
+        return;
+
+    SDL_LockMutex(QueueLock);
+    while (PendingCount > 0)
+        SDL_CondWait(WorkDone, QueueLock);
+    SDL_UnlockMutex(QueueLock);
+}
+PUBLIC STATIC int  JobSystem::GetWorkerCount() {
+    return WorkerCount;
+}
+
+PUBLIC STATIC void JobSystem::Dispose() {
+    if (!Running)
+        return;
+
+    SDL_LockMutex(QueueLock);
+    Running = false;
+    SDL_CondBroadcast(WorkReady);
+    SDL_UnlockMutex(QueueLock);
+
+    for (int i = 0; i < WorkerCount; i++)
+        SDL_WaitThread(Workers[i], NULL);
+    WorkerCount = 0;
+
+    SDL_DestroyCond(WorkDone);
+    SDL_DestroyCond(WorkReady);
+    SDL_DestroyMutex(QueueLock);
+    WorkDone = NULL;
+    WorkReady = NULL;
+    QueueLock = NULL;
+}
@@ -0,0 +1,74 @@
+#if INTERFACE
+#include <Engine/Includes/Standard.h>
+
+class RadixSort {
+public:
+};
+#endif
+
+#include <Engine/Utilities/RadixSort.h>
+
+// Maps a signed integer to a key that sorts the same way unsigned.
+PUBLIC STATIC Uint32 RadixSort::IntegerKey(int value) {
+    return (Uint32)value ^ 0x80000000U;
+}
+// Maps a float to a key that sorts the same way unsigned: negative numbers
+// get all their bits flipped, positive ones just the sign bit.
+PUBLIC STATIC Uint32 RadixSort::DecimalKey(float value) {
+    Uint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000U) ? ~bits : (bits | 0x80000000U);
+}
+
+// Stable least-significant-byte-first sort of keys, carrying values along.
+// tempKeys and tempValues must hold count entries as well. The result
+// always ends up back in keys and values.
+PUBLIC STATIC void   RadixSort::Sort(Uint32* keys, Uint32* values, Uint32* tempKeys, Uint32* tempValues, size_t count) {
+    if (count < 2)
+        return;
+
+    // Count every byte position in one go
+    Uint32 histogram[4][256];
+    memset(histogram, 0, sizeof(histogram));
+    for (size_t i = 0; i < count; i++) {
+        Uint32 key = keys[i];
+        histogram[0][key & 0xFF]++;
+        histogram[1][(key >> 8) & 0xFF]++;
+        histogram[2][(key >> 16) & 0xFF]++;
+        histogram[3][key >> 24]++;
+    }
+
+    Uint32* srcKeys = keys;
+    Uint32* srcValues = values;
+    Uint32* dstKeys = tempKeys;
+    Uint32* dstValues = tempValues;
+    for (int pass = 0; pass < 4; pass++) {
+        int shift = pass * 8;
+
+        // A pass where every key has the same byte wouldn't move anything
+        if (histogram[pass][(srcKeys[0] >> shift) & 0xFF] == count)
+            continue;
+
+        Uint32 offsets[256];
+        Uint32 offset = 0;
+        for (int b = 0; b < 256; b++) {
+            offsets[b] = offset;
+            offset += histogram[pass][b];
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            Uint32 at = offsets[(srcKeys[i] >> shift) & 0xFF]++;
+            dstKeys[at] = srcKeys[i];
+            dstValues[at] = srcValues[i];
+        }
+
+        Uint32* swap;
+        swap = srcKeys; srcKeys = dstKeys; dstKeys = swap;
+        swap = srcValues; srcValues = dstValues; dstValues = swap;
+    }
+
+    if (srcKeys != keys) {
+        memcpy(keys, srcKeys, count * sizeof(Uint32));
+        memcpy(values, srcValues, count * sizeof(Uint32));
+    }
+}